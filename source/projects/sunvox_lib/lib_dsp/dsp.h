@@ -9,6 +9,24 @@ void fft( uint32_t flags, float* fi, float* fr, int size );
 void fft( uint32_t flags, double* fi, double* fr, int size );
 float fft_test();
 void fft_speed_test();
+//Planned FFT: same results as fft() within the rounding error (see fft_test()), but the twiddle factors and the bit-reversal table are calculated only once:
+struct fft_plan
+{
+    int		size; //complex transform size (power of two)
+    uint32_t*	bitrev; //pairs of indexes to swap
+    int		bitrev_num;
+    float*	tw_r; //twiddle factors of all stages; stage with half-size h: tw_X[ h - 1 ... h * 2 - 2 ]
+    float*	tw_i;
+    float*	rtw_r; //twiddle factors of the real transform (size / 2 + 1)
+    float*	rtw_i;
+};
+fft_plan* fft_plan_new( int size ); //size = 2^n; retval: NULL if error
+void fft_plan_remove( fft_plan* p );
+void fft_plan_run( fft_plan* p, uint32_t flags, float* fi, float* fr ); //like fft( flags, fi, fr, p->size )
+//Real transform (size of the real data = p->size * 2):
+//  forward: data[ 0 ... p->size * 2 - 1 ] -> fi/fr[ 0 ... p->size ];
+//  inverse: fi/fr[ 0 ... p->size ] -> data[ 0 ... p->size * 2 - 1 ]; fi/fr are used as the work buffers;
+void fft_plan_run_real( fft_plan* p, uint32_t flags, float* data, float* fi, float* fr );
 //frequency bins:
 //[ 0 ] = 0 (DC)
 //[ 1 ] = sample rate / 2 / size
@@ -7,7 +7,13 @@
 */
 
 #include <stdint.h>
+#include <stdlib.h>
 #include <math.h>
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+#endif
 
 #include "dsp.h"
 
@@ -123,6 +129,331 @@ void fft( uint32_t flags, double* fi, double* fr, int size )
     do_fft( flags, fi, fr, size );
 }
 
+fft_plan* fft_plan_new( int size )
+{
+    if( size < 2 || ( size & ( size - 1 ) ) ) return NULL;
+    fft_plan* p = (fft_plan*)calloc( 1, sizeof( fft_plan ) );
+    if( !p ) return NULL;
+    int size2 = size / 2;
+    p->size = size;
+    p->bitrev = (uint32_t*)malloc( sizeof( uint32_t ) * size );
+    p->tw_r = (float*)malloc( sizeof( float ) * size );
+    p->tw_i = (float*)malloc( sizeof( float ) * size );
+    p->rtw_r = (float*)malloc( sizeof( float ) * ( size2 + 1 ) );
+    p->rtw_i = (float*)malloc( sizeof( float ) * ( size2 + 1 ) );
+    if( !p->bitrev || !p->tw_r || !p->tw_i || !p->rtw_r || !p->rtw_i )
+    {
+	fft_plan_remove( p );
+	return NULL;
+    }
+    int n = 0;
+    for( int i = 1, j = size2; i < size - 1; i++ )
+    {
+	if( i < j )
+	{
+	    p->bitrev[ n * 2 + 0 ] = i;
+	    p->bitrev[ n * 2 + 1 ] = j;
+	    n++;
+	}
+	int k = size2;
+	while( k <= j )
+	{
+	    j -= k;
+	    k >>= 1;
+	}
+	j += k;
+    }
+    p->bitrev_num = n;
+    for( int h = 1; h < size; h <<= 1 )
+    {
+	for( int m = 0; m < h; m++ )
+	{
+	    double a = M_PI * m / h;
+	    p->tw_r[ h - 1 + m ] = cos( a );
+	    p->tw_i[ h - 1 + m ] = -sin( a );
+	}
+    }
+    for( int k = 0; k <= size2; k++ )
+    {
+	double a = M_PI * k / size;
+	p->rtw_r[ k ] = cos( a );
+	p->rtw_i[ k ] = -sin( a );
+    }
+    return p;
+}
+
+void fft_plan_remove( fft_plan* p )
+{
+    if( !p ) return;
+    free( p->bitrev );
+    free( p->tw_r );
+    free( p->tw_i );
+    free( p->rtw_r );
+    free( p->rtw_i );
+    free( p );
+}
+
+#if defined(__SSE2__)
+    #define FFT_SIMD
+    typedef __m128 fft_v4;
+    #define FFT_V4_LOAD( P ) _mm_loadu_ps( P )
+    #define FFT_V4_STORE( P, V ) _mm_storeu_ps( P, V )
+    #define FFT_V4_ADD( A, B ) _mm_add_ps( A, B )
+    #define FFT_V4_SUB( A, B ) _mm_sub_ps( A, B )
+    #define FFT_V4_MUL( A, B ) _mm_mul_ps( A, B )
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #define FFT_SIMD
+    typedef float32x4_t fft_v4;
+    #define FFT_V4_LOAD( P ) vld1q_f32( P )
+    #define FFT_V4_STORE( P, V ) vst1q_f32( P, V )
+    #define FFT_V4_ADD( A, B ) vaddq_f32( A, B )
+    #define FFT_V4_SUB( A, B ) vsubq_f32( A, B )
+    #define FFT_V4_MUL( A, B ) vmulq_f32( A, B )
+#endif
+
+//Radix-2 stage (half-size h):
+static void fft_plan_pass2( fft_plan* p, float* fi, float* fr, int h )
+{
+    int size = p->size;
+    const float* wr = p->tw_r + h - 1;
+    const float* wi = p->tw_i + h - 1;
+    for( int b = 0; b < size; b += h * 2 )
+    {
+	float* r0 = fr + b;
+	float* i0 = fi + b;
+	float* r1 = r0 + h;
+	float* i1 = i0 + h;
+	int m = 0;
+#ifdef FFT_SIMD
+	for( ; m + 4 <= h; m += 4 )
+	{
+	    fft_v4 w_r = FFT_V4_LOAD( wr + m );
+	    fft_v4 w_i = FFT_V4_LOAD( wi + m );
+	    fft_v4 x_r = FFT_V4_LOAD( r1 + m );
+	    fft_v4 x_i = FFT_V4_LOAD( i1 + m );
+	    fft_v4 t_r = FFT_V4_SUB( FFT_V4_MUL( w_r, x_r ), FFT_V4_MUL( w_i, x_i ) );
+	    fft_v4 t_i = FFT_V4_ADD( FFT_V4_MUL( w_r, x_i ), FFT_V4_MUL( w_i, x_r ) );
+	    fft_v4 y_r = FFT_V4_LOAD( r0 + m );
+	    fft_v4 y_i = FFT_V4_LOAD( i0 + m );
+	    FFT_V4_STORE( r1 + m, FFT_V4_SUB( y_r, t_r ) );
+	    FFT_V4_STORE( i1 + m, FFT_V4_SUB( y_i, t_i ) );
+	    FFT_V4_STORE( r0 + m, FFT_V4_ADD( y_r, t_r ) );
+	    FFT_V4_STORE( i0 + m, FFT_V4_ADD( y_i, t_i ) );
+	}
+#endif
+	for( ; m < h; m++ )
+	{
+	    float tr = wr[ m ] * r1[ m ] - wi[ m ] * i1[ m ];
+	    float ti = wr[ m ] * i1[ m ] + wi[ m ] * r1[ m ];
+	    r1[ m ] = r0[ m ] - tr;
+	    i1[ m ] = i0[ m ] - ti;
+	    r0[ m ] += tr;
+	    i0[ m ] += ti;
+	}
+    }
+}
+
+//Radix-4 pass = two radix-2 stages (half-size h and h*2) in one pass through the data:
+static void fft_plan_pass4( fft_plan* p, float* fi, float* fr, int h )
+{
+    int size = p->size;
+    const float* w1r = p->tw_r + h - 1;
+    const float* w1i = p->tw_i + h - 1;
+    const float* w2r = p->tw_r + h * 2 - 1;
+    const float* w2i = p->tw_i + h * 2 - 1;
+    for( int b = 0; b < size; b += h * 4 )
+    {
+	float* r0 = fr + b;
+	float* i0 = fi + b;
+	float* r1 = r0 + h;
+	float* i1 = i0 + h;
+	float* r2 = r1 + h;
+	float* i2 = i1 + h;
+	float* r3 = r2 + h;
+	float* i3 = i2 + h;
+	int m = 0;
+#ifdef FFT_SIMD
+	for( ; m + 4 <= h; m += 4 )
+	{
+	    fft_v4 w_r = FFT_V4_LOAD( w1r + m );
+	    fft_v4 w_i = FFT_V4_LOAD( w1i + m );
+	    fft_v4 x_r = FFT_V4_LOAD( r1 + m );
+	    fft_v4 x_i = FFT_V4_LOAD( i1 + m );
+	    fft_v4 t_r = FFT_V4_SUB( FFT_V4_MUL( w_r, x_r ), FFT_V4_MUL( w_i, x_i ) );
+	    fft_v4 t_i = FFT_V4_ADD( FFT_V4_MUL( w_r, x_i ), FFT_V4_MUL( w_i, x_r ) );
+	    fft_v4 y_r = FFT_V4_LOAD( r0 + m );
+	    fft_v4 y_i = FFT_V4_LOAD( i0 + m );
+	    fft_v4 a0r = FFT_V4_ADD( y_r, t_r );
+	    fft_v4 a0i = FFT_V4_ADD( y_i, t_i );
+	    fft_v4 a1r = FFT_V4_SUB( y_r, t_r );
+	    fft_v4 a1i = FFT_V4_SUB( y_i, t_i );
+	    x_r = FFT_V4_LOAD( r3 + m );
+	    x_i = FFT_V4_LOAD( i3 + m );
+	    t_r = FFT_V4_SUB( FFT_V4_MUL( w_r, x_r ), FFT_V4_MUL( w_i, x_i ) );
+	    t_i = FFT_V4_ADD( FFT_V4_MUL( w_r, x_i ), FFT_V4_MUL( w_i, x_r ) );
+	    y_r = FFT_V4_LOAD( r2 + m );
+	    y_i = FFT_V4_LOAD( i2 + m );
+	    fft_v4 a2r = FFT_V4_ADD( y_r, t_r );
+	    fft_v4 a2i = FFT_V4_ADD( y_i, t_i );
+	    fft_v4 a3r = FFT_V4_SUB( y_r, t_r );
+	    fft_v4 a3i = FFT_V4_SUB( y_i, t_i );
+	    w_r = FFT_V4_LOAD( w2r + m );
+	    w_i = FFT_V4_LOAD( w2i + m );
+	    t_r = FFT_V4_SUB( FFT_V4_MUL( w_r, a2r ), FFT_V4_MUL( w_i, a2i ) );
+	    t_i = FFT_V4_ADD( FFT_V4_MUL( w_r, a2i ), FFT_V4_MUL( w_i, a2r ) );
+	    FFT_V4_STORE( r0 + m, FFT_V4_ADD( a0r, t_r ) );
+	    FFT_V4_STORE( i0 + m, FFT_V4_ADD( a0i, t_i ) );
+	    FFT_V4_STORE( r2 + m, FFT_V4_SUB( a0r, t_r ) );
+	    FFT_V4_STORE( i2 + m, FFT_V4_SUB( a0i, t_i ) );
+	    //w2 * ( -i ):
+	    t_r = FFT_V4_ADD( FFT_V4_MUL( w_r, a3i ), FFT_V4_MUL( w_i, a3r ) );
+	    t_i = FFT_V4_SUB( FFT_V4_MUL( w_i, a3i ), FFT_V4_MUL( w_r, a3r ) );
+	    FFT_V4_STORE( r1 + m, FFT_V4_ADD( a1r, t_r ) );
+	    FFT_V4_STORE( i1 + m, FFT_V4_ADD( a1i, t_i ) );
+	    FFT_V4_STORE( r3 + m, FFT_V4_SUB( a1r, t_r ) );
+	    FFT_V4_STORE( i3 + m, FFT_V4_SUB( a1i, t_i ) );
+	}
+#endif
+	for( ; m < h; m++ )
+	{
+	    float wr = w1r[ m ];
+	    float wi = w1i[ m ];
+	    float tr = wr * r1[ m ] - wi * i1[ m ];
+	    float ti = wr * i1[ m ] + wi * r1[ m ];
+	    float a0r = r0[ m ] + tr;
+	    float a0i = i0[ m ] + ti;
+	    float a1r = r0[ m ] - tr;
+	    float a1i = i0[ m ] - ti;
+	    tr = wr * r3[ m ] - wi * i3[ m ];
+	    ti = wr * i3[ m ] + wi * r3[ m ];
+	    float a2r = r2[ m ] + tr;
+	    float a2i = i2[ m ] + ti;
+	    float a3r = r2[ m ] - tr;
+	    float a3i = i2[ m ] - ti;
+	    wr = w2r[ m ];
+	    wi = w2i[ m ];
+	    tr = wr * a2r - wi * a2i;
+	    ti = wr * a2i + wi * a2r;
+	    r0[ m ] = a0r + tr;
+	    i0[ m ] = a0i + ti;
+	    r2[ m ] = a0r - tr;
+	    i2[ m ] = a0i - ti;
+	    tr = wr * a3i + wi * a3r;
+	    ti = wi * a3i - wr * a3r;
+	    r1[ m ] = a1r + tr;
+	    i1[ m ] = a1i + ti;
+	    r3[ m ] = a1r - tr;
+	    i3[ m ] = a1i - ti;
+	}
+    }
+}
+
+void fft_plan_run( fft_plan* p, uint32_t flags, float* fi, float* fr )
+{
+    int size = p->size;
+    if( flags & FFT_FLAG_INVERSE )
+    {
+	//inverse( x ) = conj( forward( conj( x ) ) ) / size; the second conj() is already included in fft() results:
+	for( int i = 0; i < size; i++ ) fi[ i ] = -fi[ i ];
+    }
+    const uint32_t* br = p->bitrev;
+    for( int n = 0; n < p->bitrev_num; n++, br += 2 )
+    {
+	uint32_t i = br[ 0 ];
+	uint32_t j = br[ 1 ];
+	float tr = fr[ j ];
+	float ti = fi[ j ];
+	fr[ j ] = fr[ i ];
+	fi[ j ] = fi[ i ];
+	fr[ i ] = tr;
+	fi[ i ] = ti;
+    }
+    int h = 1;
+    int stages = 0;
+    while( ( 1 << stages ) < size ) stages++;
+    if( stages & 1 )
+    {
+	fft_plan_pass2( p, fi, fr, h );
+	h <<= 1;
+    }
+    for( ; h < size; h <<= 2 )
+	fft_plan_pass4( p, fi, fr, h );
+    if( flags & FFT_FLAG_INVERSE )
+    {
+	float scale = 1.0f / size;
+	for( int i = 0; i < size; i++ )
+	{
+	    fr[ i ] *= scale;
+	    fi[ i ] *= scale;
+	}
+    }
+}
+
+void fft_plan_run_real( fft_plan* p, uint32_t flags, float* data, float* fi, float* fr )
+{
+    int size = p->size;
+    int size2 = size / 2;
+    if( flags & FFT_FLAG_INVERSE )
+    {
+	for( int k = 0; k <= size2; k++ )
+	{
+	    int k2 = size - k;
+	    float er = ( fr[ k ] + fr[ k2 ] ) * 0.5f;
+	    float ei = ( fi[ k ] - fi[ k2 ] ) * 0.5f;
+	    float dr = ( fr[ k ] - fr[ k2 ] ) * 0.5f;
+	    float di = ( fi[ k ] + fi[ k2 ] ) * 0.5f;
+	    //o = conj( w ) * d:
+	    float wr = p->rtw_r[ k ];
+	    float wi = p->rtw_i[ k ];
+	    float or_ = wr * dr + wi * di;
+	    float oi = wr * di - wi * dr;
+	    //z[ k ] = e + i * o; z[ size - k ] = conj( e - i * o ):
+	    fr[ k ] = er - oi;
+	    fi[ k ] = ei + or_;
+	    if( k > 0 )
+	    {
+		fr[ k2 ] = er + oi;
+		fi[ k2 ] = or_ - ei;
+	    }
+	}
+	fft_plan_run( p, FFT_FLAG_INVERSE, fi, fr ); //result: conj( z )
+	for( int i = 0; i < size; i++ )
+	{
+	    data[ i * 2 + 0 ] = fr[ i ];
+	    data[ i * 2 + 1 ] = -fi[ i ];
+	}
+    }
+    else
+    {
+	for( int i = 0; i < size; i++ )
+	{
+	    fr[ i ] = data[ i * 2 + 0 ];
+	    fi[ i ] = data[ i * 2 + 1 ];
+	}
+	fft_plan_run( p, 0, fi, fr );
+	fr[ size ] = fr[ 0 ];
+	fi[ size ] = fi[ 0 ];
+	for( int k = 0; k <= size2; k++ )
+	{
+	    int k2 = size - k;
+	    //e = ( z[ k ] + conj( z[ size - k ] ) ) / 2; o = -i * ( z[ k ] - conj( z[ size - k ] ) ) / 2:
+	    float er = ( fr[ k ] + fr[ k2 ] ) * 0.5f;
+	    float ei = ( fi[ k ] - fi[ k2 ] ) * 0.5f;
+	    float or_ = ( fi[ k ] + fi[ k2 ] ) * 0.5f;
+	    float oi = ( fr[ k2 ] - fr[ k ] ) * 0.5f;
+	    //x[ k ] = e + w * o; x[ size - k ] = conj( e - w * o ):
+	    float wr = p->rtw_r[ k ];
+	    float wi = p->rtw_i[ k ];
+	    float tr = wr * or_ - wi * oi;
+	    float ti = wr * oi + wi * or_;
+	    fr[ k ] = er + tr;
+	    fi[ k ] = ei + ti;
+	    fr[ k2 ] = er - tr;
+	    fi[ k2 ] = ti - ei;
+	}
+    }
+}
+
 #ifdef SUNDOG_TEST
 #include <complex.h>
 static void fft2( uint32_t flags, float _Complex* f, int size ) //complex number version - speed is identical to fft()... :(
@@ -223,6 +554,47 @@ float fft_test()
 	err += fabs( fft_re[ i ] - g_fft_test_re[ i ] );
     }
     //13 feb 2023: err = 0.0000015050172806
+    //fft_plan_run() vs fft(): not bit-identical (different twiddle calculation and operation order),
+    //max difference relative to the peak must stay below 1e-5 (-100 dB):
+    uint32_t rnd = 0;
+    for( int size = 64; size <= 8192; size *= 2 )
+    {
+	fft_plan* p = fft_plan_new( size );
+	float* im1 = SMEM_ZALLOC2( float, size );
+	float* re1 = SMEM_ALLOC2( float, size );
+	float* im2 = SMEM_ZALLOC2( float, size );
+	float* re2 = SMEM_ALLOC2( float, size );
+	for( int i = 0; i < size; i++ )
+	{
+	    re1[ i ] = pseudo_random( &rnd ) / 32768.0f - 0.5f;
+	    re2[ i ] = re1[ i ];
+	}
+	for( int inv = 0; inv <= 1; inv++ )
+	{
+	    uint32_t flags = inv ? FFT_FLAG_INVERSE : 0;
+	    fft( flags, im1, re1, size );
+	    fft_plan_run( p, flags, im2, re2 );
+	    float peak = 0;
+	    float diff = 0;
+	    for( int i = 0; i < size; i++ )
+	    {
+		float v = fabs( re1[ i ] ) + fabs( im1[ i ] );
+		float d = fabs( re1[ i ] - re2[ i ] ) + fabs( im1[ i ] - im2[ i ] );
+		if( v > peak ) peak = v;
+		if( d > diff ) diff = d;
+	    }
+	    if( diff > peak * 1e-5f )
+	    {
+		slog( "fft_plan_run( %d, %d ): diff %.10f; peak %f\n", size, flags, diff, peak );
+		err += 1;
+	    }
+	}
+	fft_plan_remove( p );
+	smem_free( im1 );
+	smem_free( re1 );
+	smem_free( im2 );
+	smem_free( re2 );
+    }
     return err;
 }
 void fft_speed_test()
@@ -291,6 +663,70 @@ void fft_speed_test()
     smem_free( re_initial );
     smem_free( buf1 );
     smem_free( buf2 );
+
+    //fft() vs fft_plan:
+    for( size = 256; size <= 65536; size *= 2 )
+    {
+	fft_plan* p = fft_plan_new( size );
+	fft_plan* p2 = fft_plan_new( size / 2 );
+	float* src = SMEM_ALLOC2( float, size );
+	float* im1 = SMEM_ZALLOC2( float, size );
+	float* re1 = SMEM_ALLOC2( float, size );
+	float* im2 = SMEM_ZALLOC2( float, size );
+	float* re2 = SMEM_ALLOC2( float, size );
+	for( int i = 0; i < size; i++ )
+	{
+	    src[ i ] = pseudo_random( &rnd ) / 32768.0f + sin( i / 256.0f );
+	    re1[ i ] = src[ i ];
+	    re2[ i ] = src[ i ];
+	}
+	fft( 0, im1, re1, size );
+	fft_plan_run( p, 0, im2, re2 );
+	float err1 = 0;
+	for( int i = 0; i < size; i++ ) err1 += fabs( re1[ i ] - re2[ i ] ) + fabs( im1[ i ] - im2[ i ] );
+	fft_plan_run_real( p2, 0, src, im2, re2 );
+	float err2 = 0;
+	for( int i = 0; i <= size / 2; i++ ) err2 += fabs( re1[ i ] - re2[ i ] ) + fabs( im1[ i ] - im2[ i ] );
+	fft_plan_run_real( p2, FFT_FLAG_INVERSE, re1, im2, re2 );
+	float err3 = 0;
+	for( int i = 0; i < size; i++ ) err3 += fabs( re1[ i ] - src[ i ] );
+
+	num_tests = ( 1 << 24 ) / size;
+	t1 = stime_ns();
+	for( int i = 0; i < num_tests; i++ )
+	{
+	    fft( 0, im1, re1, size );
+	    fft( FFT_FLAG_INVERSE, im1, re1, size );
+	}
+	t2 = stime_ns();
+	double time1 = (double)(t2-t1) / num_tests / 1000;
+	t1 = stime_ns();
+	for( int i = 0; i < num_tests; i++ )
+	{
+	    fft_plan_run( p, 0, im2, re2 );
+	    fft_plan_run( p, FFT_FLAG_INVERSE, im2, re2 );
+	}
+	t2 = stime_ns();
+	double time2 = (double)(t2-t1) / num_tests / 1000;
+	t1 = stime_ns();
+	for( int i = 0; i < num_tests; i++ )
+	{
+	    fft_plan_run_real( p2, 0, src, im2, re2 );
+	    fft_plan_run_real( p2, FFT_FLAG_INVERSE, src, im2, re2 );
+	}
+	t2 = stime_ns();
+	double time3 = (double)(t2-t1) / num_tests / 1000;
+	slog( "FFT %d: fft() %f us; fft_plan_run() %f us (x%.2f; err %f); fft_plan_run_real() %f us (x%.2f; err %f %f)\n",
+	    size, time1, time2, time1 / time2, err1, time3, time1 / time3, err2, err3 );
+
+	fft_plan_remove( p );
+	fft_plan_remove( p2 );
+	smem_free( src );
+	smem_free( im1 );
+	smem_free( re1 );
+	smem_free( im2 );
+	smem_free( re2 );
+    }
 }
 #endif
 
@@ -12,6 +12,10 @@
     #include <stdlib.h>
     #include <unistd.h> //for current dir
     #include <sys/stat.h> //mkdir
+#ifndef OS_EMSCRIPTEN
+    #include <sys/mman.h> //madvise
+    #define SFS_DISCARD
+#endif
 #ifndef OS_ANDROID
     #include <ftw.h>
 #endif
@@ -652,6 +656,13 @@ sfs_file sfs_open_in_memory( sundog_engine* sd, void* data, size_t size )
     return a + 1;
 }
 
+void sfs_set_discard( sfs_file f )
+{
+    f--;
+    if( (unsigned)f < SFS_MAX_DESCRIPTORS && g_sfs_fd[ f ] && g_sfs_fd[ f ]->type == SFS_FILE_IN_MEMORY )
+	g_sfs_fd[ f ]->virt_file_data_discard = true;
+}
+
 static bool sfs_is_vfs( const char* filename )
 {
     int p = 0;
@@ -987,6 +998,16 @@ size_t sfs_read( void* ptr, size_t el_size, size_t elements, sfs_file f )
 		if( (signed)size < 0 ) size = 0;
 		if( (signed)size > 0 )
 		    smem_copy( ptr, g_sfs_fd[ f ]->virt_file_data + g_sfs_fd[ f ]->virt_file_ptr, size );
+#ifdef SFS_DISCARD
+		if( g_sfs_fd[ f ]->virt_file_data_discard && size >= 64 * 1024 )
+		{
+		    //Release the pages that are completely inside the copied range:
+		    size_t page = (size_t)sysconf( _SC_PAGESIZE );
+		    size_t begin = ( (size_t)g_sfs_fd[ f ]->virt_file_data + g_sfs_fd[ f ]->virt_file_ptr + page - 1 ) & ~( page - 1 );
+		    size_t end = ( (size_t)g_sfs_fd[ f ]->virt_file_data + g_sfs_fd[ f ]->virt_file_ptr + size ) & ~( page - 1 );
+		    if( end > begin ) madvise( (void*)begin, end - begin, MADV_DONTNEED );
+		}
+#endif
 		g_sfs_fd[ f ]->virt_file_ptr += size;
 		retval = size / el_size;
 	    }
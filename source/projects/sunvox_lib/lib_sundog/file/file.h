@@ -122,6 +122,7 @@ struct sfs_fd_struct
     sfs_fd_type    	type;
     int8_t*	    	virt_file_data;
     bool		virt_file_data_autofree;
+    bool		virt_file_data_discard; //see sfs_set_discard()
     size_t	    	virt_file_ptr;
     size_t	    	virt_file_size;
     size_t		user_data; //Some user-defined parameter
@@ -144,6 +145,9 @@ void sfs_set_user_data( sfs_file f, size_t user_data );
 size_t sfs_get_user_data( sfs_file f );
 sfs_file sfs_open_in_memory( sundog_engine* sd, void* data, size_t size );
 inline sfs_file sfs_open_in_memory( void* data, size_t size ) { return sfs_open_in_memory( nullptr, data, size ); }
+//SFS_FILE_IN_MEMORY opened for reading a temporary copy of the data: sfs_read() releases the memory pages that are already read
+//(their content is lost, but the block itself stays valid and must be freed as usual):
+void sfs_set_discard( sfs_file f );
 sfs_file sfs_open( sundog_engine* sd, const char* filename, const char* filemode );
 inline sfs_file sfs_open( const char* filename, const char* filemode ) { return sfs_open( nullptr, filename, filemode ); }
 int sfs_close( sfs_file f );
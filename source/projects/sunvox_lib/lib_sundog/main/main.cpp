@@ -622,6 +622,7 @@ int sundog_test( sundog_engine* sd )
 	//slog("\n"); i = ssemaphore_test( sd ); if( i ) { slog( "ssemaphore_test() ERROR %d\n", i ); rv++; }
 	//slog("\n"); i = srwlock_test( sd ); if( i ) { slog( "srwlock_test() ERROR %d\n", i ); rv++; }
 	//slog("\n"); i = smutex_test( sd ); if( i ) { slog( "smutex_test() ERROR %d\n", i ); rv++; }
+	//slog("\n"); i = smem_stress_test( sd ); if( i ) { slog( "smem_stress_test() ERROR %d\n", i ); rv++; }
 	//slog("\n");
 	break;
     }
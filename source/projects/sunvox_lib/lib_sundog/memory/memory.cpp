@@ -21,11 +21,220 @@
 
 smem_block* g_smem_start = NULL;
 smem_block* g_smem_prev_block = NULL;  //Previous memory block
-size_t g_smem_size = 0;
-size_t g_smem_max_size = 0;
+std::atomic_size_t g_smem_size;
+std::atomic_size_t g_smem_max_size;
 smutex g_smem_mutex;
 size_t g_smem_error = 0;
 
+static thread_local smem_thread_usage* g_smem_thread_usage = NULL;
+
+static inline void smem_usage_add( size_t size )
+{
+    size_t s = atomic_fetch_add( &g_smem_size, size ) + size;
+    size_t max = atomic_load( &g_smem_max_size );
+    while( s > max && !atomic_compare_exchange_weak( &g_smem_max_size, &max, s ) ) {}
+    smem_thread_usage* u = g_smem_thread_usage;
+    if( u )
+    {
+	u->size += size;
+	if( u->size > u->max_size ) u->max_size = u->size;
+    }
+}
+
+static inline void smem_usage_sub( size_t size )
+{
+    atomic_fetch_sub( &g_smem_size, size );
+    smem_thread_usage* u = g_smem_thread_usage;
+    if( u ) u->size -= size;
+}
+
+#if !defined(SMEM_FAST_MODE) && !defined(SMEM_USE_NAMES) && !defined(NO_BUILTIN_ATOMIC_OPS) && !defined(SMEM_NO_POOLS)
+    #define SMEM_POOLS
+#endif
+
+#ifdef SMEM_POOLS
+/*
+    Small blocks (<= SMEM_POOL_MAX_SIZE) are taken from the size class pools without any locks:
+    each thread has its own cache of free blocks;
+    the block freed by some other thread goes to the lock-free list of the owner cache (remote_blocks);
+    the cache of the finished thread will be used by the next new thread.
+    Pool block: smem_block.prev = owner cache; smem_block.next = next free block.
+    Large blocks are allocated by malloc() and linked to the global list (g_smem_start) as before.
+*/
+#define SMEM_POOL_CLASSES	16
+#define SMEM_POOL_MAX_SIZE	4096
+#define SMEM_POOL_CHUNK_SIZE	( 64 * 1024 )
+static const uint16_t g_smem_pool_class_size[ SMEM_POOL_CLASSES ] = { 16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048, 3072, 4096 };
+struct smem_pool_chunk
+{
+    smem_pool_chunk* next;
+    size_t tmp; //to make sure the block alignment is the same as in malloc()
+};
+struct smem_pool_cache
+{
+    smem_block* free_blocks[ SMEM_POOL_CLASSES ];
+    std::atomic<smem_block*> remote_blocks; //blocks freed by other threads
+    std::atomic_int owned; //1 - used by some thread
+    int8_t* arena; //preallocated memory for the new blocks (smem_thread_arena())
+    size_t arena_size;
+    size_t arena_ptr;
+    smem_pool_cache* next;
+};
+struct smem_pool_thread
+{
+    smem_pool_cache* c;
+    int gen;
+    ~smem_pool_thread();
+};
+static std::atomic<smem_pool_chunk*> g_smem_pool_chunks; //all chunks; they will be freed in smem_global_deinit()
+static std::atomic<smem_pool_cache*> g_smem_pool_caches;
+static std::atomic_int g_smem_pool_gen; //+1 after each smem_global_deinit() with the pools removed
+static thread_local smem_pool_thread g_smem_pool_thread;
+
+smem_pool_thread::~smem_pool_thread()
+{
+    if( c && gen == atomic_load( &g_smem_pool_gen ) ) atomic_store( &c->owned, 0 );
+}
+
+static inline int smem_pool_class( size_t size )
+{
+    int cls = 0;
+    while( g_smem_pool_class_size[ cls ] < size ) cls++;
+    return cls;
+}
+
+static smem_pool_cache* smem_pool_get_cache()
+{
+    smem_pool_thread* t = &g_smem_pool_thread;
+    int gen = atomic_load( &g_smem_pool_gen );
+    if( t->c && t->gen == gen ) return t->c;
+    t->c = NULL;
+    t->gen = gen;
+    smem_pool_cache* c = atomic_load( &g_smem_pool_caches );
+    for( ; c; c = c->next )
+    {
+	int v = 0;
+	if( atomic_load( &c->owned ) == 0 && atomic_compare_exchange_strong( &c->owned, &v, 1 ) )
+	{
+	    t->c = c;
+	    return c;
+	}
+    }
+    c = (smem_pool_cache*)calloc( 1, sizeof( smem_pool_cache ) );
+    if( !c ) return NULL;
+    atomic_store( &c->remote_blocks, (smem_block*)NULL );
+    atomic_store( &c->owned, 1 );
+    c->next = atomic_load( &g_smem_pool_caches );
+    while( !atomic_compare_exchange_weak( &g_smem_pool_caches, &c->next, c ) ) {}
+    t->c = c;
+    return c;
+}
+
+static inline void smem_pool_put( smem_pool_cache* c, smem_block* m )
+{
+    int cls = smem_pool_class( m->size );
+    m->next = c->free_blocks[ cls ];
+    c->free_blocks[ cls ] = m;
+}
+
+static void smem_pool_collect_remote_blocks( smem_pool_cache* c )
+{
+    smem_block* m = atomic_exchange( &c->remote_blocks, (smem_block*)NULL );
+    while( m )
+    {
+	smem_block* next = m->next;
+	smem_pool_put( c, m );
+	m = next;
+    }
+}
+
+static bool smem_pool_add_blocks( smem_pool_cache* c, int cls )
+{
+    size_t block_size = ( sizeof( smem_block ) + g_smem_pool_class_size[ cls ] + 15 ) & ~(size_t)15;
+    int8_t* p = NULL;
+    size_t size = 0;
+    if( c->arena && c->arena_size - c->arena_ptr >= block_size )
+    {
+	size = SMEM_POOL_CHUNK_SIZE / 8;
+	if( size < block_size ) size = block_size;
+	if( size > c->arena_size - c->arena_ptr ) size = c->arena_size - c->arena_ptr;
+	p = c->arena + c->arena_ptr;
+	c->arena_ptr += size;
+    }
+    else
+    {
+	smem_pool_chunk* chunk = (smem_pool_chunk*)malloc( sizeof( smem_pool_chunk ) + SMEM_POOL_CHUNK_SIZE );
+	if( !chunk ) return false;
+	chunk->next = atomic_load( &g_smem_pool_chunks );
+	while( !atomic_compare_exchange_weak( &g_smem_pool_chunks, &chunk->next, chunk ) ) {}
+	p = (int8_t*)( chunk + 1 );
+	size = SMEM_POOL_CHUNK_SIZE;
+    }
+    for( size_t i = 0; i + block_size <= size; i += block_size )
+    {
+	smem_block* m = (smem_block*)( p + i );
+	m->prev = (smem_block*)c;
+	m->next = c->free_blocks[ cls ];
+	c->free_blocks[ cls ] = m;
+    }
+    return true;
+}
+
+static smem_block* smem_pool_alloc( size_t size )
+{
+    smem_pool_cache* c = smem_pool_get_cache();
+    if( !c ) return NULL;
+    int cls = smem_pool_class( size );
+    smem_block* m = c->free_blocks[ cls ];
+    if( !m )
+    {
+	smem_pool_collect_remote_blocks( c );
+	m = c->free_blocks[ cls ];
+	if( !m )
+	{
+	    if( !smem_pool_add_blocks( c, cls ) ) return NULL;
+	    m = c->free_blocks[ cls ];
+	}
+    }
+    c->free_blocks[ cls ] = m->next;
+    return m;
+}
+
+static void smem_pool_free( smem_block* m )
+{
+    smem_pool_cache* owner = (smem_pool_cache*)m->prev;
+    smem_pool_thread* t = &g_smem_pool_thread;
+    if( t->c == owner && t->gen == atomic_load( &g_smem_pool_gen ) )
+    {
+	smem_pool_put( owner, m );
+    }
+    else
+    {
+	smem_block* head = atomic_load( &owner->remote_blocks );
+	do m->next = head; while( !atomic_compare_exchange_weak( &owner->remote_blocks, &head, m ) );
+    }
+}
+
+static void smem_pool_remove_all()
+{
+    smem_pool_chunk* chunk = atomic_exchange( &g_smem_pool_chunks, (smem_pool_chunk*)NULL );
+    while( chunk )
+    {
+	smem_pool_chunk* next = chunk->next;
+	free( chunk );
+	chunk = next;
+    }
+    smem_pool_cache* c = atomic_exchange( &g_smem_pool_caches, (smem_pool_cache*)NULL );
+    while( c )
+    {
+	smem_pool_cache* next = c->next;
+	free( c );
+	c = next;
+    }
+    atomic_fetch_add( &g_smem_pool_gen, 1 );
+}
+#endif //SMEM_POOLS
+
 static void free_all()
 {
 #ifndef SMEM_FAST_MODE
@@ -67,25 +276,33 @@ static void free_all()
     while( g_smem_start )
     {
 	next = g_smem_start->next;
-	g_smem_size -= g_smem_start->size + sizeof( smem_block );
+	smem_usage_sub( g_smem_start->size + sizeof( smem_block ) );
 	free( g_smem_start );
 	g_smem_start = next;
     }
     g_smem_start = NULL;
     g_smem_prev_block = NULL;
 #endif
-    if( g_smem_size )
+    size_t size = atomic_load( &g_smem_size );
+    if( size )
     {
-	slog( "Leaked memory: " PRINTF_SIZET "\n", PRINTF_SIZET_CONV g_smem_size );
+	slog( "Leaked memory: " PRINTF_SIZET "\n", PRINTF_SIZET_CONV size );
     }
+#ifdef SMEM_POOLS
+    else
+    {
+	//No small blocks in use:
+	smem_pool_remove_all();
+    }
+#endif
 }
 
 int smem_global_init()
 {
     g_smem_start = NULL;
     g_smem_prev_block = NULL;
-    g_smem_size = 0;
-    g_smem_max_size = 0;
+    atomic_store( &g_smem_size, (size_t)0 );
+    atomic_store( &g_smem_max_size, (size_t)0 );
     g_smem_error = 0;
 #ifndef SMEM_FAST_MODE
     smutex_init( &g_smem_mutex, 0 );
@@ -104,26 +321,93 @@ int smem_global_deinit()
 
 size_t smem_get_usage()
 {
-    return g_smem_size;
+    return atomic_load( &g_smem_size );
+}
+
+size_t smem_get_max_usage()
+{
+    return atomic_load( &g_smem_max_size );
+}
+
+void smem_set_thread_usage( smem_thread_usage* u )
+{
+    g_smem_thread_usage = u;
 }
 
 void smem_print_usage()
 {
+    size_t max_size = atomic_load( &g_smem_max_size );
+    size_t size = atomic_load( &g_smem_size );
 #ifdef VULKAN
-    slog( "Max memory used: CPU " PRINTF_SIZET "; GPU " PRINTF_SIZET "\n", PRINTF_SIZET_CONV g_smem_max_size, PRINTF_SIZET_CONV sundog::g_vk_mem_max_size );
+    slog( "Max memory used: CPU " PRINTF_SIZET "; GPU " PRINTF_SIZET "\n", PRINTF_SIZET_CONV max_size, PRINTF_SIZET_CONV sundog::g_vk_mem_max_size );
 #else
-    slog( "Max memory used: " PRINTF_SIZET "\n", PRINTF_SIZET_CONV g_smem_max_size );
+    slog( "Max memory used: " PRINTF_SIZET "\n", PRINTF_SIZET_CONV max_size );
 #endif
-    if( g_smem_size )
+    if( size )
     {
-	slog( "Not freed: " PRINTF_SIZET "\n", PRINTF_SIZET_CONV g_smem_size );
+	slog( "Not freed: " PRINTF_SIZET "\n", PRINTF_SIZET_CONV size );
     }
 }
 
+int smem_thread_arena( size_t size )
+{
+#ifdef SMEM_POOLS
+    smem_pool_cache* c = smem_pool_get_cache();
+    if( !c ) return -1;
+    if( c->arena ) return 0;
+    smem_pool_chunk* chunk = (smem_pool_chunk*)malloc( sizeof( smem_pool_chunk ) + size );
+    if( !chunk ) return -1;
+    chunk->next = atomic_load( &g_smem_pool_chunks );
+    while( !atomic_compare_exchange_weak( &g_smem_pool_chunks, &chunk->next, chunk ) ) {}
+    c->arena = (int8_t*)( chunk + 1 );
+    c->arena_size = size;
+    c->arena_ptr = 0;
+    return 0;
+#else
+    return -1;
+#endif
+}
+
+static void smem_unlink( smem_block* m )
+{
+#ifndef SMEM_FAST_MODE
+    smutex_lock( &g_smem_mutex );
+    smem_block* prev = m->prev;
+    smem_block* next = m->next;
+    if( prev && next )
+    {
+	prev->next = next;
+	next->prev = prev;
+    }
+    if( prev && next == NULL )
+    {
+	prev->next = NULL;
+	g_smem_prev_block = prev;
+    }
+    if( prev == NULL && next )
+    {
+	next->prev = NULL;
+	g_smem_start = next;
+    }
+    if( prev == NULL && next == NULL )
+    {
+	g_smem_prev_block = NULL;
+	g_smem_start = NULL;
+    }
+    smutex_unlock( &g_smem_mutex );
+#endif
+}
+
 void* smem_alloc( size_t size  SMEM_NAME_PARS )
 {
     size_t new_size = size + sizeof( smem_block ); //Add structure with info to our memory block
-    smem_block* m = (smem_block*)malloc( new_size );
+    smem_block* m;
+#ifdef SMEM_POOLS
+    if( size <= SMEM_POOL_MAX_SIZE )
+	m = smem_pool_alloc( size );
+    else
+#endif
+    m = (smem_block*)malloc( new_size );
 
     //Save info about new memory block:
     if( m )
@@ -135,29 +419,31 @@ void* smem_alloc( size_t size  SMEM_NAME_PARS )
 #endif
 
 #ifndef SMEM_FAST_MODE
-	smutex_lock( &g_smem_mutex );
-
-	m->prev = g_smem_prev_block;
-	m->next = NULL;
-	if( g_smem_prev_block == NULL )
-	{
-	    //It is the first block. Save address:
-	    g_smem_start = m;
-	    g_smem_prev_block = m;
-	}
-	else
+#ifdef SMEM_POOLS
+	if( size > SMEM_POOL_MAX_SIZE )
+#endif
 	{
-	    //It is not the first block:
-	    g_smem_prev_block->next = m;
-	    g_smem_prev_block = m;
-	}
+	    smutex_lock( &g_smem_mutex );
 
-	g_smem_size += new_size; if( g_smem_size > g_smem_max_size ) g_smem_max_size = g_smem_size;
+	    m->prev = g_smem_prev_block;
+	    m->next = NULL;
+	    if( g_smem_prev_block == NULL )
+	    {
+		//It is the first block. Save address:
+		g_smem_start = m;
+		g_smem_prev_block = m;
+	    }
+	    else
+	    {
+		//It is not the first block:
+		g_smem_prev_block->next = m;
+		g_smem_prev_block = m;
+	    }
 
-	smutex_unlock( &g_smem_mutex );
-#else
-	g_smem_size += new_size; if( g_smem_size > g_smem_max_size ) g_smem_max_size = g_smem_size;
+	    smutex_unlock( &g_smem_mutex );
+	}
 #endif
+	smem_usage_add( new_size );
     }
     else
     {
@@ -183,38 +469,17 @@ void smem_free( void* ptr )
 
     smem_block* m = (smem_block*)( (int8_t*)ptr - sizeof( smem_block ) );
 
-#ifndef SMEM_FAST_MODE
-    smutex_lock( &g_smem_mutex );
-#endif
-
-    g_smem_size -= m->size + sizeof( smem_block );
+    smem_usage_sub( m->size + sizeof( smem_block ) );
 
-#ifndef SMEM_FAST_MODE
-    smem_block* prev = m->prev;
-    smem_block* next = m->next;
-    if( prev && next )
-    {
-	prev->next = next;
-	next->prev = prev;
-    }
-    if( prev && next == NULL )
-    {
-	prev->next = NULL;
-	g_smem_prev_block = prev;
-    }
-    if( prev == NULL && next )
+#ifdef SMEM_POOLS
+    if( m->size <= SMEM_POOL_MAX_SIZE )
     {
-	next->prev = NULL;
-	g_smem_start = next;
-    }
-    if( prev == NULL && next == NULL )
-    {
-	g_smem_prev_block = NULL;
-	g_smem_start = NULL;
+	smem_pool_free( m );
+	return;
     }
+#endif
 
-    smutex_unlock( &g_smem_mutex );
-#endif //not SMEM_FAST_MODE
+    smem_unlink( m );
 
     free( m );
 }
@@ -228,38 +493,24 @@ void* smem_get_stdc_ptr( void* ptr, size_t* data_offset )
 
     smem_block* m = (smem_block*)( (int8_t*)ptr - sizeof( smem_block ) );
 
-#ifndef SMEM_FAST_MODE
-    smutex_lock( &g_smem_mutex );
-#endif
-
-    g_smem_size -= m->size + sizeof( smem_block );
-
-#ifndef SMEM_FAST_MODE
-    smem_block* prev = m->prev;
-    smem_block* next = m->next;
-    if( prev && next )
+#ifdef SMEM_POOLS
+    if( m->size <= SMEM_POOL_MAX_SIZE )
     {
-	prev->next = next;
-	next->prev = prev;
-    }
-    if( prev && next == NULL )
-    {
-	prev->next = NULL;
-	g_smem_prev_block = prev;
-    }
-    if( prev == NULL && next )
-    {
-	next->prev = NULL;
-	g_smem_start = next;
-    }
-    if( prev == NULL && next == NULL )
-    {
-	g_smem_prev_block = NULL;
-	g_smem_start = NULL;
+	//Pool block -> new malloc() block:
+	size_t size = m->size;
+	smem_block* m2 = (smem_block*)malloc( size + sizeof( smem_block ) );
+	if( !m2 ) return NULL;
+	m2->size = size;
+	memcpy( m2 + 1, ptr, size );
+	smem_free( ptr );
+	if( data_offset ) *data_offset = sizeof( smem_block );
+	return m2;
     }
+#endif
 
-    smutex_unlock( &g_smem_mutex );
-#endif //not SMEM_FAST_MODE
+    smem_usage_sub( m->size + sizeof( smem_block ) );
+
+    smem_unlink( m );
 
     if( data_offset ) *data_offset = sizeof( smem_block );
 
@@ -275,6 +526,30 @@ void* smem_resize( void* ptr, size_t new_size  SMEM_NAME_PARS )
 
     void* new_ptr = NULL;
 
+#ifdef SMEM_POOLS
+    if( old_size <= SMEM_POOL_MAX_SIZE || new_size <= SMEM_POOL_MAX_SIZE )
+    {
+	if( old_size <= SMEM_POOL_MAX_SIZE && new_size <= SMEM_POOL_MAX_SIZE && smem_pool_class( old_size ) == smem_pool_class( new_size ) )
+	{
+	    //Same size class:
+	    smem_block* m = (smem_block*)( (int8_t*)ptr - sizeof( smem_block ) );
+	    m->size = new_size;
+	    if( new_size > old_size )
+		smem_usage_add( new_size - old_size );
+	    else
+		smem_usage_sub( old_size - new_size );
+	    return ptr;
+	}
+	new_ptr = smem_alloc( new_size  SMEM_NAME_ARGS );
+	if( new_ptr )
+	{
+	    memcpy( new_ptr, ptr, old_size < new_size ? old_size : new_size );
+	    smem_free( ptr );
+	}
+	return new_ptr;
+    }
+#endif
+
     //realloc():
 #ifdef SMEM_FAST_MODE
     smem_block* m = (smem_block*)( (int8_t*)ptr - sizeof( smem_block ) );
@@ -283,7 +558,6 @@ void* smem_resize( void* ptr, size_t new_size  SMEM_NAME_PARS )
     {
 	new_ptr = (void*)( (int8_t*)new_m + sizeof( smem_block ) );
 	new_m->size = new_size;
-	g_smem_size += new_size - old_size; if( g_smem_size > g_smem_max_size ) g_smem_max_size = g_smem_size;
     }
 #else
     smutex_lock( &g_smem_mutex );
@@ -310,10 +584,16 @@ void* smem_resize( void* ptr, size_t new_size  SMEM_NAME_PARS )
 	{
 	    next->prev = new_m;
 	}
-	g_smem_size += new_size - old_size; if( g_smem_size > g_smem_max_size ) g_smem_max_size = g_smem_size;
     }
     smutex_unlock( &g_smem_mutex );
 #endif //not SMEM_FAST_MODE
+    if( new_m )
+    {
+	if( new_size > old_size )
+	    smem_usage_add( new_size - old_size );
+	else
+	    smem_usage_sub( old_size - new_size );
+    }
 
     return new_ptr;
 }
@@ -607,3 +887,108 @@ const char* smem_split_str( char* dest, size_t dest_size, const char* src, char
     else
 	return &src[ i + 1 ];
 }
+
+#ifdef SUNDOG_TEST
+#define SMEM_TEST_THREADS 4
+#define SMEM_TEST_SLOTS 256
+#define SMEM_TEST_SHARED_SLOTS 1024
+struct smem_test_data
+{
+    sthread th;
+    int n;
+    bool use_malloc;
+    int ops;
+    int errors;
+    stime_ns_t max_op_time;
+};
+static atomic_vptr g_smem_test_shared[ SMEM_TEST_SHARED_SLOTS ];
+static void smem_test_free( void* p, bool use_malloc, int* errors )
+{
+    if( !p ) return;
+    uint8_t* b = (uint8_t*)p;
+    size_t size = *(uint32_t*)p;
+    if( b[ size - 1 ] != (uint8_t)size ) (*errors)++;
+    if( use_malloc ) free( p ); else smem_free( p );
+}
+static void* smem_test_thread( void* user_data )
+{
+    smem_test_data* t = (smem_test_data*)user_data;
+    void* slots[ SMEM_TEST_SLOTS ];
+    memset( slots, 0, sizeof( slots ) );
+    uint32_t rnd = 12345 + t->n;
+    for( int i = 0; i < t->ops; i++ )
+    {
+	int r = pseudo_random( &rnd );
+	size_t size = 8 + ( r & 255 );
+	if( ( r & 0x3000 ) == 0 ) size = 8 + ( ( r & 255 ) << 4 ); //sometimes the large blocks
+	if( ( r & 0x7000 ) == 0x7000 ) size = 8 + ( ( r & 255 ) << 6 );
+	stime_ns_t t1 = stime_ns();
+	void* p = t->use_malloc ? malloc( size ) : smem_alloc( size );
+	stime_ns_t t2 = stime_ns();
+	if( t2 - t1 > t->max_op_time ) t->max_op_time = t2 - t1;
+	if( !p ) { t->errors++; break; }
+	*(uint32_t*)p = (uint32_t)size;
+	( (uint8_t*)p )[ size - 1 ] = (uint8_t)size;
+	if( r & 0x4000 )
+	{
+	    //Pass the block to some other thread:
+	    p = atomic_exchange( &g_smem_test_shared[ pseudo_random( &rnd ) % SMEM_TEST_SHARED_SLOTS ], p );
+	}
+	else
+	{
+	    int s = pseudo_random( &rnd ) % SMEM_TEST_SLOTS;
+	    void* p2 = slots[ s ];
+	    slots[ s ] = p;
+	    p = p2;
+	}
+	t1 = stime_ns();
+	smem_test_free( p, t->use_malloc, &t->errors );
+	t2 = stime_ns();
+	if( t2 - t1 > t->max_op_time ) t->max_op_time = t2 - t1;
+    }
+    for( int i = 0; i < SMEM_TEST_SLOTS; i++ ) smem_test_free( slots[ i ], t->use_malloc, &t->errors );
+    return NULL;
+}
+int smem_stress_test( sundog_engine* sd )
+{
+    int rv = 0;
+    size_t usage = smem_get_usage();
+    for( int m = 0; m < 2; m++ )
+    {
+	bool use_malloc = m == 0;
+	smem_test_data th[ SMEM_TEST_THREADS ];
+	for( int i = 0; i < SMEM_TEST_SHARED_SLOTS; i++ ) atomic_init( &g_smem_test_shared[ i ], (void*)NULL );
+	stime_ns_t t1 = stime_ns();
+	for( int i = 0; i < SMEM_TEST_THREADS; i++ )
+	{
+	    smem_test_data* t = &th[ i ];
+	    t->n = i;
+	    t->use_malloc = use_malloc;
+	    t->ops = 1000000;
+	    t->errors = 0;
+	    t->max_op_time = 0;
+	    sthread_create( &t->th, sd, smem_test_thread, t, 0 );
+	}
+	int errors = 0;
+	stime_ns_t max_op_time = 0;
+	for( int i = 0; i < SMEM_TEST_THREADS; i++ )
+	{
+	    sthread_destroy( &th[ i ].th, STHREAD_TIMEOUT_INFINITE );
+	    errors += th[ i ].errors;
+	    if( th[ i ].max_op_time > max_op_time ) max_op_time = th[ i ].max_op_time;
+	}
+	for( int i = 0; i < SMEM_TEST_SHARED_SLOTS; i++ ) smem_test_free( atomic_load( &g_smem_test_shared[ i ] ), use_malloc, &errors );
+	stime_ns_t t2 = stime_ns();
+	slog( "%s: %d threads x %d alloc/free; %f ms; max alloc/free time %f ms; errors: %d\n",
+	    use_malloc ? "malloc" : "smem_alloc", SMEM_TEST_THREADS, th[ 0 ].ops,
+	    (double)( t2 - t1 ) / 1000000, (double)max_op_time / 1000000, errors );
+	if( errors ) rv = 1;
+    }
+    if( smem_get_usage() != usage )
+    {
+	slog( "smem_stress_test(): usage " PRINTF_SIZET " != " PRINTF_SIZET "\n", PRINTF_SIZET_CONV smem_get_usage(), PRINTF_SIZET_CONV usage );
+	rv = 2;
+    }
+    return rv;
+}
+#endif
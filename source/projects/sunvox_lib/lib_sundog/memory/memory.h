@@ -31,7 +31,7 @@ struct smem_block
 #endif
 #ifndef SMEM_FAST_MODE
     smem_block* next;
-    smem_block* prev;
+    smem_block* prev; //small (pool) blocks: owner cache
 #endif
 };
 
@@ -55,7 +55,17 @@ FN3() - similar to FN2() but with automatic type detection (C++11 required)
 int smem_global_init();
 int smem_global_deinit();
 size_t smem_get_usage();
+size_t smem_get_max_usage();
 void smem_print_usage();
+struct smem_thread_usage
+{
+    int64_t		size; //allocated - freed by the thread (can be negative if it frees the blocks of the other threads)
+    int64_t		max_size;
+};
+void smem_set_thread_usage( smem_thread_usage* u ); //Count the allocations of the current thread in u (in addition to the global usage); NULL - stop
+#define SMEM_THREAD_ARENA_SIZE ( 256 * 1024 ) //default
+int smem_thread_arena( size_t size ); //Preallocate (once) the memory for the small blocks of the current thread (e.g. audio thread): no malloc() calls in smem_alloc() until this memory is exhausted; retval: 0 - ok
+int smem_stress_test( sundog_engine* sd );
 inline size_t smem_get_size( const void* ptr )
 {
     if( !ptr ) return 0;
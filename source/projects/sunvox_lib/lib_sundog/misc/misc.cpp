@@ -3837,12 +3837,20 @@ int export_import_file( sundog_engine* s, const char* filename, uint32_t flags )
 
 //Simple linear congruential generator:
 uint32_t g_rand_next = 1;
+static thread_local uint32_t* g_rand_local = NULL;
 void set_pseudo_random_seed( uint32_t seed )
 {
     g_rand_next = seed;
 }
+uint32_t* set_pseudo_random_local_seed( uint32_t* seed )
+{
+    uint32_t* prev = g_rand_local;
+    g_rand_local = seed;
+    return prev;
+}
 uint32_t pseudo_random()
 {
+    if( g_rand_local ) return pseudo_random( g_rand_local );
     g_rand_next = g_rand_next * 1103515245 + 12345;
     return ( (uint32_t)( g_rand_next / 65536 ) % 32768 );
 }
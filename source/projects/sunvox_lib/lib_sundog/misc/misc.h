@@ -531,6 +531,7 @@ period = 1<<31;
 */
 void set_pseudo_random_seed( uint32_t seed );
 uint32_t pseudo_random(); //OUT: 0...32767
+uint32_t* set_pseudo_random_local_seed( uint32_t* seed ); //pseudo_random() of the current thread will use this seed instead of the global one; NULL - back to the global seed; retval: previous local seed
 uint32_t pseudo_random( uint32_t* seed ); //OUT: 0...32767
 
 /*
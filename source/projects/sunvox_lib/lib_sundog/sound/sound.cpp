@@ -7,11 +7,20 @@
 
 #include "sundog.h"
 
+#ifdef SUNDOG_SOUND_SLOT_THREADS
+    #if defined(__SSE2__)
+	#include <emmintrin.h>
+    #elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#include <arm_neon.h>
+    #endif
+#endif
+
 int g_sample_size[ sound_buffer_max ] = 
 {
     0,
     sizeof( int16_t ),
-    sizeof( float )
+    sizeof( float ),
+    sizeof( double )
 };
 
 #ifndef SUNDOG_MODULE
@@ -92,6 +101,12 @@ int user_controlled_sound_callback(
 {
     if( !ss ) return 0; 
     if( !ss->initialized ) return 0;
+    if( ss->in_planar )
+    {
+	ss->in_planar = false;
+	ss->in_buffer = NULL;
+    }
+    ss->out_planar = NULL;
     ss->out_buffer = buffer;
     ss->out_frames = frames;
     ss->out_time = output_time;
@@ -110,6 +125,7 @@ int user_controlled_sound_callback(
 {
     if( !ss ) return 0; 
     if( !ss->initialized ) return 0;
+    ss->out_planar = NULL;
     ss->out_buffer = out_buffer;
     ss->out_frames = frames;
     ss->out_time = out_time;
@@ -118,9 +134,317 @@ int user_controlled_sound_callback(
     ss->in_type = in_type;
     ss->in_channels = in_channels;
     ss->in_buffer = in_buffer;
+    ss->in_planar = false;
     return sundog_sound_callback( ss, 0 );
 }
 
+int user_controlled_sound_callback_planar( 
+    sundog_sound* ss, 
+    void** out_buffers, 
+    int frames, int latency, stime_ticks_t out_time,
+    sound_buffer_type type,
+    int in_channels,
+    void** in_buffers )
+{
+    if( !ss ) return 0; 
+    if( !ss->initialized ) return 0;
+    if( type != sound_buffer_float32 && type != sound_buffer_float64 ) return 0;
+    if( in_channels > SUNDOG_SOUND_PLANAR_CHANNELS ) in_channels = SUNDOG_SOUND_PLANAR_CHANNELS;
+    ss->planar_type = type;
+    ss->out_planar = out_buffers;
+    ss->out_buffer = NULL;
+    ss->out_frames = frames;
+    ss->out_time = out_time;
+    ss->out_latency = latency;
+    ss->out_latency2 = latency;
+    if( in_buffers && in_channels > 0 )
+    {
+	ss->in_channels = in_channels;
+	ss->in_buffer = in_buffers;
+	ss->in_planar = true;
+    }
+    else
+    {
+	ss->in_buffer = NULL;
+	ss->in_planar = false;
+    }
+    return sundog_sound_callback( ss, 0 );
+}
+
+#ifndef NOSOUND
+
+static inline double sundog_sound_get_sample( sound_buffer_type type, void* buf, size_t i )
+{
+    switch( type )
+    {
+	case sound_buffer_int16: return (double)( (int16_t*)buf )[ i ] / 32768.0;
+	case sound_buffer_float32: return ( (float*)buf )[ i ];
+	case sound_buffer_float64: return ( (double*)buf )[ i ];
+	default: return 0;
+    }
+}
+
+static inline void sundog_sound_put_sample( sound_buffer_type type, void* buf, size_t i, double v )
+{
+    switch( type )
+    {
+	case sound_buffer_int16: SMP_FLOAT32_TO_INT16( ( (int16_t*)buf )[ i ], (float)v ); break;
+	case sound_buffer_float32: ( (float*)buf )[ i ] = (float)v; break;
+	case sound_buffer_float64: ( (double*)buf )[ i ] = v; break;
+	default: break;
+    }
+}
+
+//Planar output: out_planar[ ch ][ offset + i ] (+)= src[ i * out_channels + ch ];
+//src - interleaved slot buffer (out_type); NULL - zeros:
+static void sundog_sound_planar_write( sundog_sound* ss, void* src, int offset, int frames, bool add )
+{
+    int channels = ss->out_channels;
+    sound_buffer_type type = ss->planar_type;
+    for( int ch = 0; ch < channels; ch++ )
+    {
+	void* dest = ss->out_planar[ ch ];
+	if( !dest ) continue;
+	if( !src )
+	{
+	    if( !add ) smem_clear( (int8_t*)dest + offset * g_sample_size[ type ], frames * g_sample_size[ type ] );
+	    continue;
+	}
+	for( int i = 0; i < frames; i++ )
+	{
+	    double v = sundog_sound_get_sample( ss->out_type, src, i * channels + ch );
+	    if( add ) v += sundog_sound_get_sample( type, dest, offset + i );
+	    sundog_sound_put_sample( type, dest, offset + i, v );
+	}
+    }
+}
+
+//Input for the slot callback (starting from the frame offset):
+static void* sundog_sound_slot_input( sundog_sound* ss, sundog_sound_slot* slot, void* in_buffer, int offset )
+{
+    if( !in_buffer ) return NULL;
+    if( ss->in_planar )
+    {
+	for( int ch = 0; ch < ss->in_channels; ch++ )
+	{
+	    int8_t* p = (int8_t*)( (void**)in_buffer )[ ch ];
+	    if( p ) p += offset * g_sample_size[ ss->planar_type ];
+	    slot->in_planar_buf[ ch ] = p;
+	}
+	return slot->in_planar_buf;
+    }
+    return (int8_t*)in_buffer + offset * g_sample_size[ ss->in_type ] * ss->in_channels;
+}
+
+//Interleave the planar buffers (src_type) into the capture buffer (type):
+static void sundog_sound_capture_planar( sundog_sound* ss, void** src, sound_buffer_type src_type, int channels, sound_buffer_type type, bool silence )
+{
+    int sample_size = g_sample_size[ type ];
+    size_t buf_mask = smem_get_size( ss->out_file_buf ) - 1;
+    size_t wp = ss->out_file_buf_wp;
+    for( int i = 0; i < ss->out_frames; i++ )
+    {
+	for( int ch = 0; ch < channels; ch++ )
+	{
+	    double v = 0;
+	    if( !silence && src[ ch ] ) v = sundog_sound_get_sample( src_type, src[ ch ], i );
+	    sundog_sound_put_sample( type, ss->out_file_buf + wp, 0, v );
+	    wp = ( wp + sample_size ) & buf_mask;
+	}
+    }
+    COMPILER_MEMORY_BARRIER();
+    ss->out_file_buf_wp = wp;
+}
+
+#endif
+
+#ifdef SUNDOG_SOUND_SLOT_THREADS
+
+//dest += src (with saturation for int16):
+static void sundog_sound_mix( sound_buffer_type type, void* dest, void* src, int size )
+{
+    int i = 0;
+    if( type == sound_buffer_int16 )
+    {
+	int16_t* d = (int16_t*)dest;
+	int16_t* s = (int16_t*)src;
+#if defined(__SSE2__)
+	for( ; i + 8 <= size; i += 8 )
+	    _mm_storeu_si128( (__m128i*)( d + i ), _mm_adds_epi16( _mm_loadu_si128( (__m128i*)( d + i ) ), _mm_loadu_si128( (__m128i*)( s + i ) ) ) );
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	for( ; i + 8 <= size; i += 8 )
+	    vst1q_s16( d + i, vqaddq_s16( vld1q_s16( d + i ), vld1q_s16( s + i ) ) );
+#endif
+	for( ; i < size; i++ )
+	{
+	    int v = (int)d[ i ] + s[ i ];
+	    LIMIT_NUM( v, -32768, 32767 );
+	    d[ i ] = (int16_t)v;
+	}
+    }
+    if( type == sound_buffer_float32 )
+    {
+	float* d = (float*)dest;
+	float* s = (float*)src;
+#if defined(__SSE2__)
+	for( ; i + 4 <= size; i += 4 )
+	    _mm_storeu_ps( d + i, _mm_add_ps( _mm_loadu_ps( d + i ), _mm_loadu_ps( s + i ) ) );
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	for( ; i + 4 <= size; i += 4 )
+	    vst1q_f32( d + i, vaddq_f32( vld1q_f32( d + i ), vld1q_f32( s + i ) ) );
+#endif
+	for( ; i < size; i++ )
+	    d[ i ] += s[ i ];
+    }
+}
+
+static void sundog_sound_render_slot_jobs( sundog_sound* ss )
+{
+    while( 1 )
+    {
+	int j = atomic_fetch_add( &ss->slot_jobs_next, 1 );
+	if( j >= ss->slot_jobs_num ) break;
+	int slot_num = ss->slot_jobs[ j ];
+	ss->slot_results[ slot_num ] = ss->slots[ slot_num ].callback( ss, slot_num );
+	atomic_fetch_add( &ss->slot_jobs_done, 1 );
+    }
+}
+
+static void* sundog_sound_slot_thread( void* data )
+{
+    sundog_sound* ss = (sundog_sound*)data;
+    smem_thread_arena( SMEM_THREAD_ARENA_SIZE );
+    while( 1 )
+    {
+	ssemaphore_wait( &ss->slot_th_sem, STHREAD_TIMEOUT_INFINITE );
+	if( ss->slot_th_exit_request ) break;
+	atomic_fetch_add( &ss->slot_th_work_cnt, 1 );
+	if( atomic_load( &ss->slot_th_work ) )
+	    sundog_sound_render_slot_jobs( ss );
+	atomic_fetch_sub( &ss->slot_th_work_cnt, 1 );
+    }
+    return NULL;
+}
+
+static void sundog_sound_slot_threads_init( sundog_sound* ss )
+{
+    int th_num = sconfig_get_int_value( APP_CFG_SND_SLOT_THREADS, 1, 0 );
+    if( th_num <= 0 ) th_num = sthread_get_cpu_count();
+    if( th_num > SUNDOG_SOUND_SLOTS ) th_num = SUNDOG_SOUND_SLOTS;
+    ss->slot_th_num = th_num;
+    atomic_init( &ss->slot_th_work, 0 );
+    atomic_init( &ss->slot_th_work_cnt, 0 );
+    atomic_init( &ss->slot_jobs_next, 0 );
+    atomic_init( &ss->slot_jobs_done, 0 );
+    if( th_num <= 1 ) return;
+    //Private slot buffers (same size as ss->slot_buffer); never reallocated in the audio callback:
+    int frame_size = g_sample_size[ ss->out_type ] * ss->out_channels;
+    for( int i = 0; i < SUNDOG_SOUND_SLOTS; i++ )
+    {
+	ss->slot_buffers[ i ] = SMEM_ALLOC( ss->slot_buffer_size * frame_size );
+	if( !ss->slot_buffers[ i ] ) th_num = 1;
+    }
+    if( th_num <= 1 )
+    {
+	ss->slot_th_num = 1;
+	return;
+    }
+    ssemaphore_create( &ss->slot_th_sem, NULL, 0, 0 );
+    ss->slot_th = SMEM_ZALLOC2( sthread, th_num - 1 );
+    for( int i = 0; i < th_num - 1; i++ )
+	sthread_create( &ss->slot_th[ i ], ss->sd, sundog_sound_slot_thread, ss, 0 );
+}
+
+static void sundog_sound_slot_threads_deinit( sundog_sound* ss )
+{
+    if( ss->slot_th_num > 1 )
+    {
+	ss->slot_th_exit_request = true;
+	for( int i = 0; i < ss->slot_th_num - 1; i++ ) ssemaphore_release( &ss->slot_th_sem );
+	for( int i = 0; i < ss->slot_th_num - 1; i++ ) sthread_destroy( &ss->slot_th[ i ], 1000 );
+	smem_free( ss->slot_th );
+	ss->slot_th = NULL;
+	ssemaphore_destroy( &ss->slot_th_sem );
+    }
+    for( int i = 0; i < SUNDOG_SOUND_SLOTS; i++ )
+    {
+	smem_free( ss->slot_buffers[ i ] );
+	ss->slot_buffers[ i ] = NULL;
+    }
+    ss->slot_th_num = 0;
+}
+
+//Render all active slots (except the ones waiting for slot_sync) in parallel, each into its own buffer;
+//then mix them in the order of the slot numbers (same result as the single-threaded mixer):
+static void sundog_sound_render_slots_parallel( sundog_sound* ss, void* in_buffer, uint32_t* rendered_slots, bool* not_filled, bool* silence )
+{
+    int frame_size = g_sample_size[ ss->out_type ] * ss->out_channels;
+    int jobs = 0;
+    for( int slot_num = 0; slot_num < ss->slot_cnt; slot_num++ )
+    {
+	sundog_sound_slot* slot = &ss->slots[ slot_num ];
+	if( !slot->callback || slot->suspended || slot->wait_for_sync ) continue;
+	ss->slot_jobs[ jobs++ ] = slot_num;
+    }
+    if( jobs < 2 ) return;
+    if( ss->out_frames > ss->slot_buffer_size ) return; //too large for the slot buffers: use the single-threaded mixer (it renders in pieces)
+    size_t buf_size = ss->out_frames * frame_size;
+    for( int j = 0; j < jobs; j++ )
+    {
+	int slot_num = ss->slot_jobs[ j ];
+	sundog_sound_slot* slot = &ss->slots[ slot_num ];
+	slot->out_buf_ptr = 0;
+	slot->sync = 0;
+	slot->in_buffer = sundog_sound_slot_input( ss, slot, in_buffer, 0 );
+	slot->buffer = ss->slot_buffers[ slot_num ];
+	slot->planar = NULL;
+	slot->frames = ss->out_frames;
+	slot->time = ss->out_time;
+	ss->slot_results[ slot_num ] = 0;
+    }
+    ss->slot_jobs_num = jobs;
+    atomic_store( &ss->slot_jobs_next, 0 );
+    atomic_store( &ss->slot_jobs_done, 0 );
+    ss->slot_th_active = true;
+    atomic_store( &ss->slot_th_work, 1 );
+    int wake = ss->slot_th_num - 1;
+    if( wake > jobs - 1 ) wake = jobs - 1;
+    for( int i = 0; i < wake; i++ ) ssemaphore_release( &ss->slot_th_sem );
+    sundog_sound_render_slot_jobs( ss );
+    while( atomic_load( &ss->slot_jobs_done ) < jobs ) sthread_yield();
+    atomic_store( &ss->slot_th_work, 0 );
+    while( atomic_load( &ss->slot_th_work_cnt ) != 0 ) sthread_yield();
+    ss->slot_th_active = false;
+    for( int j = 0; j < jobs; j++ )
+    {
+	int slot_num = ss->slot_jobs[ j ];
+	sundog_sound_slot* slot = &ss->slots[ slot_num ];
+	if( slot->sync ) { ss->slot_sync = slot->sync; slot->sync = 0; }
+	int r = ss->slot_results[ slot_num ];
+	if( r == 1 ) *silence = false;
+	if( r )
+	{
+	    if( ss->out_planar )
+	    {
+		sundog_sound_planar_write( ss, slot->buffer, 0, ss->out_frames, !*not_filled );
+		*not_filled = false;
+	    }
+	    else if( *not_filled )
+	    {
+		smem_copy( ss->out_buffer, slot->buffer, buf_size );
+		*not_filled = false;
+	    }
+	    else
+	    {
+		sundog_sound_mix( ss->out_type, ss->out_buffer, slot->buffer, ss->out_frames * ss->out_channels );
+	    }
+	}
+	*rendered_slots |= 1 << slot_num;
+    }
+}
+
+#endif
+
 int sundog_sound_callback( sundog_sound* ss, uint32_t flags )
 {
 #ifdef NOSOUND
@@ -129,6 +453,8 @@ int sundog_sound_callback( sundog_sound* ss, uint32_t flags )
     bool not_filled = true;
     bool silence = true;
 
+    smem_thread_arena( SMEM_THREAD_ARENA_SIZE ); //only once for each audio thread
+
     int frame_size = g_sample_size[ ss->out_type ] * ss->out_channels;
     int in_frame_size = 0;
     void* in_buffer = NULL;
@@ -145,6 +471,11 @@ int sundog_sound_callback( sundog_sound* ss, uint32_t flags )
 	in_buffer = ss->in_buffer;
     }
 
+#ifdef SUNDOG_SOUND_SLOT_THREADS
+    if( ss->slot_th_num > 1 )
+	sundog_sound_render_slots_parallel( ss, in_buffer, &rendered_slots, &not_filled, &silence );
+#endif
+
     for( int a = 0; a < 2; a++ )
     {
 	for( int slot_num = 0, slot_bit = 1; slot_num < ss->slot_cnt; slot_num++, slot_bit<<=1 )
@@ -162,15 +493,19 @@ int sundog_sound_callback( sundog_sound* ss, uint32_t flags )
 		slot->wait_for_sync = 0;
 		if( not_filled )
 		{
-		    smem_clear( ss->out_buffer, ss->out_frames * frame_size );
+		    if( ss->out_planar )
+			sundog_sound_planar_write( ss, NULL, 0, ss->out_frames, false );
+		    else
+			smem_clear( ss->out_buffer, ss->out_frames * frame_size );
 		    not_filled = false;
 		}
 	    }
 	    slot->in_buffer = NULL;
 	    if( not_filled )
 	    {
-		slot->in_buffer = in_buffer;
+		slot->in_buffer = sundog_sound_slot_input( ss, slot, in_buffer, 0 );
 		slot->buffer = ss->out_buffer;
+		slot->planar = ss->out_planar;
 		slot->frames = ss->out_frames;
 		slot->time = ss->out_time;
 		int r = callback( ss, slot_num );
@@ -183,13 +518,13 @@ int sundog_sound_callback( sundog_sound* ss, uint32_t flags )
 	    else
 	    {
 		slot->buffer = ss->slot_buffer;
+		slot->planar = NULL;
 	        while( 1 )
 	        {
 	            int size = ss->out_frames - slot->out_buf_ptr;
 	            if( size > ss->slot_buffer_size )
 	    		size = ss->slot_buffer_size;
-	    	    if( in_buffer )
-			slot->in_buffer = (int8_t*)in_buffer + slot->out_buf_ptr * in_frame_size;
+		    slot->in_buffer = sundog_sound_slot_input( ss, slot, in_buffer, slot->out_buf_ptr );
 		    slot->frames = size;
 	    	    slot->time = ss->out_time;
 		    if( slot->out_buf_ptr )
@@ -201,7 +536,9 @@ int sundog_sound_callback( sundog_sound* ss, uint32_t flags )
 	    		//Add result to the main buffer:
 			int size2 = size * ss->out_channels;
 	    		int dest_offset = slot->out_buf_ptr * ss->out_channels;
-		        if( ss->out_type == sound_buffer_int16 )
+			if( ss->out_planar )
+			    sundog_sound_planar_write( ss, ss->slot_buffer, slot->out_buf_ptr, size, true );
+		        else if( ss->out_type == sound_buffer_int16 )
 	    		{
 	    	    	    int16_t* dest = (int16_t*)ss->out_buffer + dest_offset;
 	    	    	    int16_t* src = (int16_t*)ss->slot_buffer;
@@ -212,7 +549,7 @@ int sundog_sound_callback( sundog_sound* ss, uint32_t flags )
 				dest[ i ] = (int16_t)v;
 	    		    }
 			}
-	    		if( ss->out_type == sound_buffer_float32 )
+	    		else if( ss->out_type == sound_buffer_float32 )
 			{
 	    		    float* dest = (float*)ss->out_buffer + dest_offset;
 			    float* src = (float*)ss->slot_buffer;
@@ -241,7 +578,14 @@ int sundog_sound_callback( sundog_sound* ss, uint32_t flags )
     ss->slot_sync -= ss->out_frames;
     if( ss->slot_sync < 0 ) ss->slot_sync = 0;
 
-    if( ss->out_file )
+    if( ss->out_file && ss->out_planar )
+    {
+	if( in_buffer && ( ss->out_file_flags & SCAP_FLAG_INPUT ) != 0 )
+	    sundog_sound_capture_planar( ss, (void**)in_buffer, ss->planar_type, ss->in_channels, ss->in_type, false );
+	else
+	    sundog_sound_capture_planar( ss, ss->out_planar, ss->planar_type, ss->out_channels, ss->out_type, silence );
+    }
+    else if( ss->out_file )
     {
 	uint8_t* src = (uint8_t*)ss->out_buffer;
 	bool from_input = false;
@@ -282,7 +626,10 @@ mutex_end:
 
     if( not_filled )
     {
-	smem_clear( ss->out_buffer, ss->out_frames * frame_size );
+	if( ss->out_planar )
+	    sundog_sound_planar_write( ss, NULL, 0, ss->out_frames, false );
+	else
+	    smem_clear( ss->out_buffer, ss->out_frames * frame_size );
     }
 
     if( silence )
@@ -420,6 +767,9 @@ int sundog_sound_init( sundog_sound* ss, sundog_engine* sd, sound_buffer_type ty
 	int frame = g_sample_size[ ss->out_type ] * ss->out_channels;
 	ss->slot_buffer_size = 1024 * 8;
 	ss->slot_buffer = SMEM_ALLOC( ss->slot_buffer_size * frame );
+#ifdef SUNDOG_SOUND_SLOT_THREADS
+	sundog_sound_slot_threads_init( ss );
+#endif
 
 	if( sd )
 	{
@@ -500,6 +850,9 @@ int sundog_sound_deinit( sundog_sound* ss )
 	}
     }
 
+#ifdef SUNDOG_SOUND_SLOT_THREADS
+    sundog_sound_slot_threads_deinit( ss );
+#endif
     if( ss->slot_buffer )
 	smem_free( ss->slot_buffer );
 
@@ -706,6 +1059,13 @@ void sundog_sound_slot_sync( sundog_sound* ss, int slot, int frame_number )
     if( !ss ) return;
     if( !ss->initialized ) return;
     if( (unsigned)slot >= SUNDOG_SOUND_SLOTS ) return;
+#ifdef SUNDOG_SOUND_SLOT_THREADS
+    if( ss->slot_th_active )
+    {
+	ss->slots[ slot ].sync = ss->slots[ slot ].out_buf_ptr + frame_number + 1;
+	return;
+    }
+#endif
     ss->slot_sync = ss->slots[ slot ].out_buf_ptr + frame_number + 1;
     //printf( "SLOT %d SET SYNC %d + %d + 1\n", slot, ss->slots[ slot ].out_buf_ptr, frame_number );
 
@@ -12,8 +12,13 @@
 #define APP_CFG_JACK_NO_DEF_IN		"jack_nodefin" //don't set default JACK input connections: default = auto; any value = don't set;
 #define APP_CFG_JACK_NO_DEF_OUT		"jack_nodefout" //don't set default JACK output connections: default = auto; any value = don't set;
 #define APP_CFG_JACK_DONT_RESTORE_MIDIIN "jack_drmin" //don't restore JACK MIDI IN connections: default = auto; any value = don't restore;
+#define APP_CFG_SND_SLOT_THREADS	"slot_threads" //number of threads for the parallel rendering of the sound slots: default = 1 (off); 0 = auto (number of CPU cores);
 
 #define SUNDOG_SOUND_SLOTS			16
+#if !defined(NO_BUILTIN_ATOMIC_OPS) && !defined(NOSOUND)
+    #define SUNDOG_SOUND_SLOT_THREADS //each active slot can be rendered by its own thread (into its own buffer)
+#endif
+#define SUNDOG_SOUND_PLANAR_CHANNELS		8 //max number of per-channel (planar) input buffers
 #define SUNDOG_SOUND_DEFAULT_TIMEOUT_MS		400
 #define SUNDOG_MIDI_PORTS			64
 
@@ -80,6 +85,7 @@ enum sound_buffer_type
     sound_buffer_default,
     sound_buffer_int16,
     sound_buffer_float32,
+    sound_buffer_float64, //planar buffers only (user_controlled_sound_callback_planar())
     sound_buffer_max
 };
 extern int g_sample_size[ sound_buffer_max ];
@@ -98,14 +104,17 @@ struct sundog_sound_slot
     sundog_sound_slot_callback_t	callback;
     void*				user_data;
 
-    void*		in_buffer;
+    void*		in_buffer; //sundog_sound.in_planar: array of per-channel buffers (in_planar_buf)
     void*		buffer;
+    void**		planar; //per-channel output buffers (sundog_sound.planar_type) instead of the buffer; NULL - not used
+    void*		in_planar_buf[ SUNDOG_SOUND_PLANAR_CHANNELS ];
     int 		frames;
     int			out_buf_ptr; //can be used for slot_sync (slot_sync = out_buf_ptr + user_callback_ptr + 1)
     stime_ticks_t	time; //output time
 
     bool		suspended;
     bool		wait_for_sync; //suspended until slot_sync
+    int			sync; //slot_sync signal from this slot (parallel rendering only; applied after all slots are rendered)
 };
 
 /*
@@ -142,6 +151,22 @@ struct sundog_sound
     void*		slot_buffer;
     int			slot_buffer_size;
     int			slot_sync; //global (for all slots) sync signal (frame number + 1); can be assigned from the sound callback code only!
+#ifdef SUNDOG_SOUND_SLOT_THREADS
+    //Parallel rendering of the slots (APP_CFG_SND_SLOT_THREADS):
+    int			slot_th_num; //number of threads (including the sound callback thread); 1 - off
+    sthread*		slot_th;
+    ssemaphore		slot_th_sem;
+    volatile bool	slot_th_exit_request;
+    bool		slot_th_active; //slots are being rendered by the threads
+    std::atomic_int	slot_th_work;
+    std::atomic_int	slot_th_work_cnt;
+    void*		slot_buffers[ SUNDOG_SOUND_SLOTS ]; //private buffer for each slot
+    int			slot_results[ SUNDOG_SOUND_SLOTS ]; //slot callback retval
+    int			slot_jobs[ SUNDOG_SOUND_SLOTS ]; //slot numbers
+    int			slot_jobs_num;
+    std::atomic_int	slot_jobs_next;
+    std::atomic_int	slot_jobs_done;
+#endif
 
     sound_buffer_type	in_type;
     int			in_channels;
@@ -158,6 +183,11 @@ struct sundog_sound
     void*		out_buffer;
     int 		out_frames;
     stime_ticks_t	out_time; //output time; see description above
+
+    //Planar mode (user_controlled_sound_callback_planar()):
+    void**		out_planar; //per-channel output buffers; NULL - interleaved out_buffer is used
+    bool		in_planar; //in_buffer is an array of per-channel buffers
+    sound_buffer_type	planar_type; //float32 or float64
     
     sfs_file		out_file;
     uint32_t		out_file_flags; //SCAP_*
@@ -228,6 +258,16 @@ int user_controlled_sound_callback(
     sound_buffer_type in_type,
     int in_channels,
     void* in_buffer );
+//Same, but with the separate (non-interleaved) buffer for each channel:
+//type = sound_buffer_float32 or sound_buffer_float64 (for both output and input);
+//the first active slot is rendered directly into out_buffers (without intermediate buffers);
+int user_controlled_sound_callback_planar(
+    sundog_sound* ss,
+    void** out_buffers,
+    int frames, int latency, stime_ticks_t out_time,
+    sound_buffer_type type,
+    int in_channels,
+    void** in_buffers );
 
 //Main sound callback + slot mixer (sound_player.cpp):
 //can be called automatically (from device_sound_*) or by user (from user_controlled_sound_callback);
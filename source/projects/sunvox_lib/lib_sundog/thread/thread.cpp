@@ -14,6 +14,7 @@
 #ifdef OS_UNIX
     #include <errno.h>
     #include <unistd.h>
+    #include <sched.h>
     #include <sys/syscall.h>
     #include <sys/stat.h> //mode constants
     #include <fcntl.h> // O_* constants
@@ -253,6 +254,31 @@ sthread_pid_t sthread_getpid()
     return 0;
 }
 
+void sthread_yield()
+{
+#ifdef OS_UNIX
+    sched_yield();
+#endif
+#if defined(OS_WIN) || defined(OS_WINCE)
+    SwitchToThread();
+#endif
+}
+
+int sthread_get_cpu_count()
+{
+    int rv = 1;
+#ifdef OS_UNIX
+    long n = sysconf( _SC_NPROCESSORS_ONLN );
+    if( n > 0 ) rv = (int)n;
+#endif
+#if defined(OS_WIN) || defined(OS_WINCE)
+    SYSTEM_INFO si;
+    GetSystemInfo( &si );
+    if( si.dwNumberOfProcessors > 0 ) rv = (int)si.dwNumberOfProcessors;
+#endif
+    return rv;
+}
+
 //
 // Mutex
 //
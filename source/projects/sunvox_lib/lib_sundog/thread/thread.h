@@ -44,6 +44,8 @@ typedef uint64_t sthread_pid_t;
 
 sthread_tid_t sthread_gettid();
 sthread_pid_t sthread_getpid();
+void sthread_yield(); //give the rest of the time slice to other threads
+int sthread_get_cpu_count(); //number of online CPU cores (min 1)
 
 //
 // Mutex
@@ -5,7 +5,10 @@
 
 #include "sundog.h"
 
-//#define PSYNTH_MULTITHREADED
+#if !defined(NO_BUILTIN_ATOMIC_OPS) && !defined(PSYNTH_SINGLETHREADED)
+    #define PSYNTH_MULTITHREADED //multi-core rendering of the main module graph; the number of threads is set by the "render_threads" config option
+#endif
+#define PSYNTH_MAX_THREADS 16
 
 //Type of the controller value:
 typedef int32_t		PS_CTYPE;
@@ -339,11 +342,13 @@ struct psynth_ctl
 #define PS_CHUNK_SMP_CH_MASK  		( 3 << PS_CHUNK_SMP_CH_OFFSET )
 //temp flags:
 #define PS_CHUNK_FLAG_DONT_SAVE	    	( 1 << 5 )
+struct psynth_shared_chunk;
 struct psynth_chunk
 {
     void* 		data;
     uint32_t		flags; //PS_CHUNK_SMP_* | PS_CHUNK_FLAG_*
     int32_t		freq; //sample rate
+    psynth_shared_chunk* shared; //not NULL: the data is read-only and belongs to the shared chunk store (see psynth_share_chunk())
 };
 
 struct psynth_event;
@@ -452,6 +457,8 @@ enum
 #define PSYNTH_FLAG2_NOTE_SENDER		( 1 << 1 ) //Note output
 #define PSYNTH_FLAG2_NOTE_RECEIVER		( 1 << 2 ) //Note input
 #define PSYNTH_FLAG2_NOTE_IO			( PSYNTH_FLAG2_NOTE_SENDER | PSYNTH_FLAG2_NOTE_RECEIVER )
+#define PSYNTH_FLAG2_PARALLEL_SETUP		( 1 << 3 ) //PS_CMD_SETUP_FINISHED touches the module's own data/chunks only: can be executed in a separate thread during the project loading
+#define PSYNTH_FLAG2_READONLY_INPUT		( 1 << 4 ) //The module never writes to channels_in[]: with a single input they may point to the output of that module (no copy)
 #define PSYNTH_FLAG2_JUST_LOADED		(unsigned)( 1 << 29 ) //MUST BE cleared automatically!
 #define PSYNTH_FLAG2_SELECTED2			(unsigned)( 1 << 30 ) //MUST BE cleared automatically! (temp selection, not visible for the user; used in SUNVOX_ACTION_PROJ_AFTERMERGE)
 #define PSYNTH_FLAG2_LAST			(unsigned)( 1 << 31 ) //MUST BE cleared automatically!
@@ -491,6 +498,22 @@ struct psynth_midimsg_map
 };
 
 #define PSYNTH_MAX_CHANNELS			2
+//Module output capture (see psynth_set_scope()); nothing is captured for the modules without these flags:
+#define PSYNTH_SCOPE_FLAG_RAW			( 1 << 0 ) //scope ring: psynth_get_scope_buffer()
+#define PSYNTH_SCOPE_FLAG_PEAKS			( 1 << 1 ) //decimated min/max/RMS stream: psynth_get_peaks()
+#define PSYNTH_PEAKS_SIZE			1024 //number of entries in the peak ring (power of 2)
+#define PSYNTH_PEAKS_DEF_RESOLUTION		256 //frames per entry
+struct psynth_peaks
+{
+    int			resolution; //frames per entry
+    int			frames; //frames in the current entry
+    float		min[ PSYNTH_MAX_CHANNELS ];
+    float		max[ PSYNTH_MAX_CHANNELS ];
+    float		sum2[ PSYNTH_MAX_CHANNELS ];
+    float		buf[ PSYNTH_MAX_CHANNELS ][ PSYNTH_PEAKS_SIZE * 3 ]; //min, max, RMS
+    std::atomic_uint	wp; //number of entries written
+};
+
 struct psynth_module
 {
     psynth_net*		pnet;
@@ -512,6 +535,9 @@ struct psynth_module
     PS_STYPE*		channels_out[ PSYNTH_MAX_CHANNELS ];
     int		    	in_empty[ PSYNTH_MAX_CHANNELS ]; //Number of zero frames
     int		    	out_empty[ PSYNTH_MAX_CHANNELS ]; //Number of zero frames
+    PS_STYPE*		channels_in_own[ PSYNTH_MAX_CHANNELS ]; //Own input buffers while channels_in[] are shared with the input module
+    int		    	in_own_empty[ PSYNTH_MAX_CHANNELS ];
+    uint		in_shared; //Bit mask of the shared channels_in[] (PSYNTH_FLAG2_READONLY_INPUT)
 
     //Number of channels:
     int		    	input_channels;
@@ -524,6 +550,7 @@ struct psynth_module
 
     int*      		events;
     uint		events_num;
+    uint		events_overflow; //number of events dropped because the events[] array was full
 
     //Standard properties:
     int		    	finetune; //-256...256
@@ -541,6 +568,8 @@ struct psynth_module
 
     //Scope buffers:
     PS_STYPE*		scope_buf[ PSYNTH_MAX_CHANNELS ];
+    volatile uint	scope_flags; //PSYNTH_SCOPE_FLAG_*
+    psynth_peaks*	peaks;
 
     volatile float	cpu_usage; //In percents (0..100)
     int             	cpu_usage_ticks;
@@ -695,6 +724,41 @@ struct psynth_thread
     // +PSYNTH_MAX_CHANNELS (mode1): [ TAIL:previous frames (from the previous resampling iteration) ] [ INPUT DELAY ] [ NEW FRAMES ] [ .. ]
 };
 
+//Module render profiler (psynth_prof_*):
+#define PSYNTH_PROF_RING_SIZE	    		32768 //records per render thread (power of 2)
+#define PSYNTH_PROF_HIST_SIZE			256 //log2 histogram of the render time: 8 steps per octave
+struct psynth_prof_record
+{
+    int			mod_num;
+    int			th; //render thread
+    uint32_t		block; //render_counter
+    uint32_t		dur; //ns
+    stime_ns_t		t; //start time (ns)
+};
+struct psynth_prof_ring //one writer (render thread) + one reader
+{
+    psynth_prof_record*	r;
+    std::atomic_uint	wp;
+    std::atomic_uint	rp;
+};
+struct psynth_prof_stat
+{
+    uint32_t		cnt;
+    uint32_t		min;
+    uint32_t		max;
+    uint64_t		sum;
+    uint32_t		hist[ PSYNTH_PROF_HIST_SIZE ];
+};
+struct psynth_prof
+{
+    psynth_prof_ring*	rings;
+    int			rings_num;
+    std::atomic_uint	lost; //ring overflow: number of dropped records
+    psynth_prof_stat*	stats; //per module; updated by psynth_prof_read()
+    uint		stats_num;
+    stime_ns_t		t0; //time of psynth_prof_enable()
+};
+
 //Sound net flags:
 #define PSYNTH_NET_FLAG_MAIN			( 1 << 0 )
 #define PSYNTH_NET_FLAG_CREATE_MODULES		( 1 << 1 )
@@ -712,12 +776,19 @@ struct psynth_net
     psynth_module*	mods;
     uint		mods_num; //mods capacity (may be larger than number of modules in project)
     smutex		mods_mutex; //May be used by synths for access to some global data
-    psynth_event*	events_heap;
+    psynth_event*	events_heap; //Event arena: preallocated by psynth_plan_events(); never resized in the audio thread
+    int			events_cap; //events_heap capacity
 #ifdef PSYNTH_MULTITHREADED
     std::atomic_int	events_num;
+    std::atomic_int	events_overflow; //number of dropped events (arena overflow)
 #else
     uint		events_num;
+    uint		events_overflow;
 #endif
+    int			events_peak; //max number of events per block
+    int			events_overflow_planned; //events_overflow value at the last psynth_plan_events()
+    int*		events_mods; //modules that received the events in the current block
+    uint		events_mods_num;
 
     //MIDI:
 
@@ -744,7 +815,8 @@ struct psynth_net
     int			buf_size;
     //uint32_t		frame_cnt; //increases at the end of psynth_render_all()
     stime_ticks_t	out_time;
-    uint8_t		cpu_usage_enable; //bits: 1<<0 - modules+net; 1<<1 - net;
+    uint8_t		cpu_usage_enable; //bits: 1<<0 - modules+net; 1<<1 - net; 1<<2 - module render profiler;
+    psynth_prof*	prof;
     volatile float	cpu_usage1; //for monitor1 (cpu+modules): in percents (0..100)
     volatile float	cpu_usage2; //for monitor2 (cpu+graph): in percents (0..100)
     stime_ticks_t	cpu_usage_t1;
@@ -760,10 +832,31 @@ struct psynth_net
     psynth_thread*	th;
     int			th_num; //number of threads (min 1)
     volatile bool	th_exit_request;
+    void*		metamodule_pool; //worker threads of the pipelined MetaModules (psynths_metamodule.cpp)
     volatile stime_ticks_t	th_work_t;
 #ifdef PSYNTH_MULTITHREADED
-    volatile bool	th_work;
+    std::atomic_int	th_work;
     std::atomic_int	th_work_cnt;
+    ssemaphore		th_sem; //wakes up the worker threads (one release per worker per block)
+    bool		th_parallel; //true while the worker threads are rendering the modules
+    //Render schedule (rebuilt when change_counter2 is changed):
+    int			th_sched_cc2;
+    uint		th_sched_mods_num;
+    int			th_sched_num; //number of modules in the schedule
+    int*		th_sched_mods; //rank -> module number (in the order of the single-threaded psynth_render_all())
+    int*		th_sched_rank; //module number -> rank (-1 - not in schedule)
+    int*		th_sched_deps; //dependents of each rank (CSR: th_sched_deps_ptr[ rank ] ... th_sched_deps_ptr[ rank + 1 ] - 1)
+    int*		th_sched_deps_ptr;
+    int*		th_sched_pending0; //initial number of unrendered dependencies
+    std::atomic_int*	th_sched_pending;
+    std::atomic_int*	th_queue; //ready queue: rank + 1 (0 - empty slot)
+    std::atomic_int	th_queue_head;
+    std::atomic_int	th_queue_tail;
+    std::atomic_int	th_done;
+    //Events sent from the modules during the parallel rendering:
+    smutex		th_events_mutex;
+    int			th_events_start; //events_num at the beginning of the parallel rendering
+    int*		th_events_rank; //sender rank for each event >= th_events_start
 #endif
 
     //Global input (microphone / line-in):
@@ -771,6 +864,7 @@ struct psynth_net
     void*		in_buf;
     sound_buffer_type	in_buf_type;
     int			in_buf_channels;
+    bool		in_buf_planar; //in_buf is an array of per-channel buffers (void*[ in_buf_channels ])
 
     //Scope buffers:
 
@@ -954,6 +1048,10 @@ void psynth_set_chunk_flags( uint mod_num, uint num, psynth_net* pnet, uint32_t
 void* psynth_resize_chunk( uint mod_num, uint num, size_t new_size, psynth_net* pnet );
 void psynth_remove_chunk( uint mod_num, uint num, psynth_net* pnet );
 void psynth_remove_chunks( uint mod_num, psynth_net* pnet ); //Remove all chunks in module
+//Shared chunks: identical data (e.g. the same sample in several MetaModules or slots) is kept in memory only once.
+//The module must not write to the shared data directly: psynth_unshare_chunk() returns its own copy (copy-on-write).
+void psynth_share_chunk( uint mod_num, uint num, psynth_net* pnet ); //Replace the chunk data by the shared copy (only for large chunks)
+void* psynth_unshare_chunk( uint mod_num, uint num, psynth_net* pnet ); //Get writable chunk data
 
 //Number of inputs/outputs:
 int psynth_get_number_of_outputs( uint mod_num, psynth_net* pnet );
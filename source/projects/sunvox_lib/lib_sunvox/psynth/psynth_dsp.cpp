@@ -27,6 +27,11 @@ IN THE SOFTWARE.
 */
 
 #include "psynth.h"
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+#endif
 biquad_filter* biquad_filter_new( uint32_t flags )
 {
     biquad_filter* f = SMEM_ZALLOC2( biquad_filter, 1 );
@@ -487,6 +492,172 @@ void biquad_filter_run( biquad_filter* f, int ch, PS_STYPE* in, PS_STYPE* out, s
 	}
     }
 }
+#if defined(__SSE2__)
+    #define BIQUAD_FILTER_SIMD
+    typedef __m128d biquad_v2;
+    #define BQ_V2_SET( CH0, CH1 ) _mm_set_pd( CH1, CH0 )
+    #define BQ_V2_SET1( V ) _mm_set1_pd( V )
+    #define BQ_V2_LOAD( P ) _mm_loadu_pd( P )
+    #define BQ_V2_STORE( P, V ) _mm_storeu_pd( P, V )
+    #define BQ_V2_ADD( A, B ) _mm_add_pd( A, B )
+    #define BQ_V2_SUB( A, B ) _mm_sub_pd( A, B )
+    #define BQ_V2_MUL( A, B ) _mm_mul_pd( A, B )
+    #define BQ_V2_GET( V, CH0, CH1 ) { CH0 = _mm_cvtsd_f64( V ); CH1 = _mm_cvtsd_f64( _mm_unpackhi_pd( V, V ) ); }
+#elif ( defined(__ARM_NEON) || defined(__ARM_NEON__) ) && defined(__aarch64__)
+    #define BIQUAD_FILTER_SIMD
+    typedef float64x2_t biquad_v2;
+    #define BQ_V2_SET( CH0, CH1 ) vcombine_f64( vdup_n_f64( CH0 ), vdup_n_f64( CH1 ) )
+    #define BQ_V2_SET1( V ) vdupq_n_f64( V )
+    #define BQ_V2_LOAD( P ) vld1q_f64( P )
+    #define BQ_V2_STORE( P, V ) vst1q_f64( P, V )
+    #define BQ_V2_ADD( A, B ) vaddq_f64( A, B )
+    #define BQ_V2_SUB( A, B ) vsubq_f64( A, B )
+    #define BQ_V2_MUL( A, B ) vmulq_f64( A, B )
+    #define BQ_V2_GET( V, CH0, CH1 ) { CH0 = vgetq_lane_f64( V, 0 ); CH1 = vgetq_lane_f64( V, 1 ); }
+#endif
+//The operation order is the same as in biquad_filter_run(), but the compiler may contract or reorder the scalar code differently
+//(-ffast-math, FMA), so the result is not guaranteed to be bit-identical; check with sunvox_bench -e "Filter Pro" -c DIR;
+void biquad_filter_run_stereo( biquad_filter* f, PS_STYPE** in, PS_STYPE** out, size_t len )
+{
+#ifdef BIQUAD_FILTER_SIMD
+    if( BIQUAD_FILTER_CHANNELS >= 2 && f->interp_ptr[ 0 ] == f->interp_ptr[ 1 ] )
+    {
+	biquad_filter_ftype ftype = get_biquad_filter_ftype( f->type );
+	int stages = get_biquad_filter_stages2( f );
+	for( int scnt = 0; scnt < 2; scnt++ )
+	{
+    	    biquad_filter_state* fs = &f->state;
+    	    int interp_ptr = 0;
+	    size_t size = len;
+    	    if( scnt )
+    	    {
+    		interp_ptr = f->interp_ptr[ 0 ];
+		if( (unsigned)interp_ptr >= (unsigned)f->interp_len )
+	    	    break;
+    		fs = &f->interp_state;
+    		if( (size_t)( f->interp_len - interp_ptr ) < size )
+    		    size = f->interp_len - interp_ptr;
+    	    }
+	    biquad_v2 a1 = BQ_V2_SET1( fs->a[ 1 ] );
+	    biquad_v2 a2 = BQ_V2_SET1( fs->a[ 2 ] );
+	    biquad_v2 b0 = BQ_V2_SET1( fs->b[ 0 ] );
+	    biquad_v2 b1 = BQ_V2_SET1( fs->b[ 1 ] );
+	    biquad_v2 b2 = BQ_V2_SET1( fs->b[ 2 ] );
+	    biquad_v2 b0_1 = BQ_V2_SET1( 1 - fs->b[ 0 ] );
+	    biquad_filter_float* RESTRICT buf = f->buf;
+	    size_t i = 0;
+	    while( i < size )
+	    {
+		size_t s = size - i;
+		if( s > (unsigned)BIQUAD_FILTER_BUF_SIZE ) s = BIQUAD_FILTER_BUF_SIZE;
+		for( int ch = 0; ch < 2; ch++ )
+		{
+		    PS_STYPE* RESTRICT in2 = in[ ch ] + i;
+		    for( size_t i2 = 0; i2 < s; i2++ )
+		    {
+#ifdef PS_STYPE_FLOATINGPOINT
+			biquad_filter_float v = in2[ i2 ];
+			psynth_denorm_add_white_noise( v );
+			buf[ i2 * 2 + ch ] = v;
+#else
+			buf[ i2 * 2 + ch ] = (biquad_filter_float)in2[ i2 ] / (biquad_filter_float)PS_STYPE_ONE;
+#endif
+		    }
+		}
+		for( int stage = 0; stage < stages; stage++ )
+		{
+		    biquad_filter_float* sx = &fs->x[ BIQUAD_FILTER_POLES * BIQUAD_FILTER_CHANNELS * stage ];
+		    biquad_filter_float* sy = &fs->y[ BIQUAD_FILTER_POLES * BIQUAD_FILTER_CHANNELS * stage ];
+		    biquad_v2 x0;
+		    biquad_v2 x1 = BQ_V2_SET( sx[ 0 ], sx[ BIQUAD_FILTER_POLES + 0 ] );
+		    biquad_v2 x2 = BQ_V2_SET( sx[ 1 ], sx[ BIQUAD_FILTER_POLES + 1 ] );
+		    biquad_v2 y0;
+		    biquad_v2 y1 = BQ_V2_SET( sy[ 0 ], sy[ BIQUAD_FILTER_POLES + 0 ] );
+		    biquad_v2 y2 = BQ_V2_SET( sy[ 1 ], sy[ BIQUAD_FILTER_POLES + 1 ] );
+		    if( ftype >= BIQUAD_FILTER_1POLE_LPF )
+		    {
+			if( ftype == BIQUAD_FILTER_1POLE_HPF )
+			    for( size_t i2 = 0; i2 < s * 2; i2 += 2 )
+			    {
+				x0 = BQ_V2_LOAD( buf + i2 );
+				y0 = BQ_V2_SUB( BQ_V2_MUL( b0_1, x0 ), BQ_V2_MUL( a1, y1 ) );
+				y1 = y0;
+				BQ_V2_STORE( buf + i2, BQ_V2_SUB( x0, y0 ) );
+			    }
+			else
+			    for( size_t i2 = 0; i2 < s * 2; i2 += 2 )
+			    {
+				x0 = BQ_V2_LOAD( buf + i2 );
+				y0 = BQ_V2_SUB( BQ_V2_MUL( b0, x0 ), BQ_V2_MUL( a1, y1 ) );
+				y1 = y0;
+				BQ_V2_STORE( buf + i2, y0 );
+			    }
+		    }
+		    else
+		    {
+			for( size_t i2 = 0; i2 < s * 2; i2 += 2 )
+			{
+			    x0 = BQ_V2_LOAD( buf + i2 );
+			    y0 = BQ_V2_ADD( BQ_V2_ADD( BQ_V2_MUL( b0, x0 ), BQ_V2_MUL( b1, x1 ) ), BQ_V2_MUL( b2, x2 ) );
+			    y0 = BQ_V2_SUB( BQ_V2_SUB( y0, BQ_V2_MUL( a1, y1 ) ), BQ_V2_MUL( a2, y2 ) );
+			    x2 = x1;
+			    x1 = x0;
+			    y2 = y1;
+			    y1 = y0;
+			    BQ_V2_STORE( buf + i2, y0 );
+			}
+		    }
+		    BQ_V2_GET( x1, sx[ 0 ], sx[ BIQUAD_FILTER_POLES + 0 ] );
+		    BQ_V2_GET( x2, sx[ 1 ], sx[ BIQUAD_FILTER_POLES + 1 ] );
+		    BQ_V2_GET( y1, sy[ 0 ], sy[ BIQUAD_FILTER_POLES + 0 ] );
+		    BQ_V2_GET( y2, sy[ 1 ], sy[ BIQUAD_FILTER_POLES + 1 ] );
+		}
+		for( int ch = 0; ch < 2; ch++ )
+		{
+		    PS_STYPE* RESTRICT out2 = out[ ch ] + i;
+		    if( scnt == 0 )
+		    {
+			for( size_t i2 = 0; i2 < s; i2++ )
+			{
+#ifdef PS_STYPE_FLOATINGPOINT
+			    out2[ i2 ] = buf[ i2 * 2 + ch ];
+#else
+			    out2[ i2 ] = (PS_STYPE)( buf[ i2 * 2 + ch ] * (biquad_filter_float)PS_STYPE_ONE );
+#endif
+			}
+		    }
+		    else
+		    {
+			int ip = interp_ptr;
+			for( size_t i2 = 0; i2 < s; i2++, ip++ )
+			{
+			    PS_STYPE2 v1 = out2[ i2 ];
+			    PS_STYPE2 v2;
+#ifdef PS_STYPE_FLOATINGPOINT
+			    v2 = buf[ i2 * 2 + ch ];
+#else
+			    v2 = (PS_STYPE2)( buf[ i2 * 2 + ch ] * (biquad_filter_float)PS_STYPE_ONE );
+#endif
+			    v1 = (PS_STYPE2)( v1 * ip + v2 * ( f->interp_len - ip ) ) / (PS_STYPE2)f->interp_len;
+			    out2[ i2 ] = (PS_STYPE)v1;
+			}
+		    }
+		}
+		i += s;
+		interp_ptr += s;
+	    }
+	    if( scnt )
+	    {
+		f->interp_ptr[ 0 ] = interp_ptr;
+		f->interp_ptr[ 1 ] = interp_ptr;
+	    }
+	}
+	return;
+    }
+#endif
+    biquad_filter_run( f, 0, in[ 0 ], out[ 0 ], len );
+    biquad_filter_run( f, 1, in[ 1 ], out[ 1 ], len );
+}
 biquad_filter_float biquad_filter_freq_response( biquad_filter* f, biquad_filter_float freq )
 {
     biquad_filter_state* fs = &f->state;
@@ -69,7 +69,7 @@ struct biquad_filter
     int				interp_ptr[ BIQUAD_FILTER_CHANNELS ];
 
     //Internal filter stuff:
-    biquad_filter_float		buf[ BIQUAD_FILTER_BUF_SIZE ];
+    biquad_filter_float		buf[ BIQUAD_FILTER_BUF_SIZE * BIQUAD_FILTER_CHANNELS ]; //biquad_filter_run_stereo(): {ch0, ch1}, {ch0, ch1}, ...
 };
 
 #define BFT_FTYPE_BITS		5
@@ -120,6 +120,7 @@ bool biquad_filter_change(
     biquad_filter_float         dBgain,
     biquad_filter_float         Q );
 void biquad_filter_run( biquad_filter* f, int ch, PS_STYPE* in, PS_STYPE* out, size_t len );
+void biquad_filter_run_stereo( biquad_filter* f, PS_STYPE** in, PS_STYPE** out, size_t len ); //like biquad_filter_run() for ch 0 and 1, but both channels are processed at once; results may differ by the rounding error
 biquad_filter_float biquad_filter_freq_response( biquad_filter* f, biquad_filter_float freq );
 
 //
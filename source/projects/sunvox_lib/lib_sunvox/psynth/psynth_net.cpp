@@ -28,8 +28,14 @@ IN THE SOFTWARE.
 
 #include "psynth_net.h"
 #include "sunvox_engine.h"
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+#elif ( defined(__ARM_NEON) || defined(__ARM_NEON__) ) && defined(__aarch64__)
+    #include <arm_neon.h>
+#endif
 #define DEFAULT_MODULE_EVENTS_NUM 128
 #define DEFAULT_HEAP_EVENTS_NUM 256
+#define HEAP_EVENTS_PER_MODULE 16
 #if defined(OS_LINUX) && (CPUMARK >= 10) && defined(SMEM_USE_NAMES) && defined(SUNVOX_GUI)
     #define EVT_HEAP_DEBUG_MESSAGES
 #endif
@@ -129,6 +135,17 @@ atomic_vptr g_noise_table;
 #define MAX_SINE_TABLES 16
 atomic_vptr g_sine_tables[ MAX_SINE_TABLES ];
 atomic_vptr g_base_wavetable;
+#define SHARED_CHUNKS_HASH_SIZE		256 //must be a power of 2
+#define SHARED_CHUNK_MIN_SIZE		4096
+struct psynth_shared_chunk
+{
+    void*		data;
+    uint64_t		hash;
+    int			refs;
+    psynth_shared_chunk* next;
+};
+static smutex g_shared_chunks_mutex;
+static psynth_shared_chunk* g_shared_chunks[ SHARED_CHUNKS_HASH_SIZE ];
 int psynth_global_init()
 {
     atomic_init( &g_noise_table, (void*)NULL );
@@ -137,6 +154,7 @@ int psynth_global_init()
 	atomic_init( &g_sine_tables[ i ], (void*)NULL );
     }
     atomic_init( &g_base_wavetable, (void*)NULL );
+    smutex_init( &g_shared_chunks_mutex, 0 );
     return 0;
 }
 int psynth_global_deinit()
@@ -147,27 +165,74 @@ int psynth_global_deinit()
 	p = atomic_exchange( &g_sine_tables[ i ], (void*)NULL ); smem_free( p );
     }
     p = atomic_exchange( &g_base_wavetable, (void*)NULL ); smem_free( p );
+    for( int i = 0; i < SHARED_CHUNKS_HASH_SIZE; i++ )
+    {
+	psynth_shared_chunk* sc = g_shared_chunks[ i ];
+	while( sc )
+	{
+	    psynth_shared_chunk* next = sc->next;
+	    smem_free( sc->data );
+	    smem_free( sc );
+	    sc = next;
+	}
+	g_shared_chunks[ i ] = NULL;
+    }
+    smutex_destroy( &g_shared_chunks_mutex );
     return 0;
 }
 #ifdef PSYNTH_MULTITHREADED
+static thread_local int g_psynth_th_rank = -1; //rank of the module rendered by the current thread (parallel mode)
+static int psynth_render( int start_mod, psynth_net* pnet );
+static int psynth_render_module0( psynth_net* pnet );
+static void psynth_render_scheduled( int th_n, psynth_net* pnet )
+{
+    int total = pnet->th_sched_num;
+    int idle = 0;
+    while( 1 )
+    {
+	int h = atomic_load( &pnet->th_queue_head );
+	if( h >= atomic_load( &pnet->th_queue_tail ) || atomic_load( &pnet->th_queue[ h ] ) == 0 )
+	{
+	    if( atomic_load( &pnet->th_done ) >= total ) break;
+	    if( ++idle > 256 ) { idle = 0; sthread_yield(); }
+	    continue;
+	}
+	if( !atomic_compare_exchange_weak( &pnet->th_queue_head, &h, h + 1 ) ) continue;
+	idle = 0;
+	int rank = atomic_load( &pnet->th_queue[ h ] ) - 1;
+	int mod_num = pnet->th_sched_mods[ rank ];
+	pnet->mods[ mod_num ].th_id = th_n;
+	g_psynth_th_rank = rank;
+	if( mod_num == 0 )
+	    psynth_render_module0( pnet );
+	else
+	    psynth_render( mod_num, pnet );
+	g_psynth_th_rank = -1;
+	for( int i = pnet->th_sched_deps_ptr[ rank ]; i < pnet->th_sched_deps_ptr[ rank + 1 ]; i++ )
+	{
+	    int d = pnet->th_sched_deps[ i ];
+	    if( atomic_fetch_sub( &pnet->th_sched_pending[ d ], 1 ) == 1 )
+		atomic_store( &pnet->th_queue[ atomic_fetch_add( &pnet->th_queue_tail, 1 ) ], d + 1 );
+	}
+	atomic_fetch_add( &pnet->th_done, 1 );
+    }
+}
 void* psynth_thread_body( void* data )
 {
     psynth_thread* th = (psynth_thread*)data;
-    printf( "PSYNTH THREAD %d BEGIN\n", th->n );
+    psynth_net* pnet = th->pnet;
+    smem_thread_arena( SMEM_THREAD_ARENA_SIZE );
     while( 1 )
     {
-	if( th->pnet->th_exit_request ) break;
-	if( th->pnet->th_work )
+	ssemaphore_wait( &pnet->th_sem, STHREAD_TIMEOUT_INFINITE );
+	if( pnet->th_exit_request ) break;
+	atomic_fetch_add( &pnet->th_work_cnt, 1 );
+	if( atomic_load( &pnet->th_work ) )
 	{
-	    atomic_fetch_add( &th->pnet->th_work_cnt, 1 );
-	    if( th->pnet->th_work )
-	    {
-	        printf( "TH%d: %d\n", th->n, stime_ticks() - th->pnet->th_work_t );
-	    }
-	    atomic_fetch_sub( &th->pnet->th_work_cnt, 1 );
+	    psynth_render_scheduled( th->n, pnet );
 	}
+	atomic_fetch_sub( &pnet->th_work_cnt, 1 );
     }
-    printf( "PSYNTH THREAD %d END\n", th->n );
     return NULL;
 }
 #endif
@@ -178,7 +243,20 @@ static void psynth_thread_init( int n, psynth_net* pnet )
     th->pnet = pnet;
     sundog_engine* sd = nullptr; GET_SD_FROM_PSYNTH_NET( pnet, sd );
 #ifdef PSYNTH_MULTITHREADED
-    if( n == 0 ) atomic_init( &pnet->th_work_cnt, 0 );
+    if( n == 0 )
+    {
+	atomic_init( &pnet->th_work, 0 );
+	atomic_init( &pnet->th_work_cnt, 0 );
+	atomic_init( &pnet->th_queue_head, 0 );
+	atomic_init( &pnet->th_queue_tail, 0 );
+	atomic_init( &pnet->th_done, 0 );
+	pnet->th_sched_cc2 = pnet->change_counter2 - 1;
+	if( pnet->th_num > 1 )
+	{
+	    ssemaphore_create( &pnet->th_sem, NULL, 0, 0 );
+	    smutex_init( &pnet->th_events_mutex, SMUTEX_FLAG_ATOMIC_SPINLOCK );
+	}
+    }
     if( n > 0 )
     {
 	sthread_create( &th->th, sd, psynth_thread_body, th, 0 );
@@ -197,6 +275,14 @@ static void psynth_thread_deinit( int n, psynth_net* pnet )
     for( int i = 0; i < PSYNTH_MAX_CHANNELS; i++ ) smem_free( th->temp_buf[ i ] );
     for( int i = 0; i < PSYNTH_MAX_CHANNELS * 2; i++ ) smem_free( th->resamp_buf[ i ] );
 }
+static void psynth_prof_free( psynth_prof* prof )
+{
+    if( !prof ) return;
+    for( int i = 0; i < prof->rings_num; i++ ) smem_free( prof->rings[ i ].r );
+    smem_free( prof->rings );
+    smem_free( prof->stats );
+    smem_free( prof );
+}
 void psynth_init( uint flags, int freq, int bpm, int tpl, void* host, uint base_host_version, psynth_net* pnet )
 {
     smem_clear( pnet, sizeof( psynth_net ) ); 
@@ -204,17 +290,22 @@ void psynth_init( uint flags, int freq, int bpm, int tpl, void* host, uint base_
     smutex_init( &pnet->mods_mutex, 0 );
     pnet->mods = SMEM_ZALLOC2( psynth_module, 4 );
     pnet->mods_num = 4;
-    int heap_size = DEFAULT_HEAP_EVENTS_NUM;
 #ifdef PSYNTH_MULTITHREADED
-    heap_size *= 4;
     atomic_init( &pnet->events_num, 0 );
+    atomic_init( &pnet->events_overflow, 0 );
 #endif
-    pnet->events_heap = SMEM_ALLOC2( psynth_event, heap_size );
     pnet->th_num = 1;
 #ifdef PSYNTH_MULTITHREADED
+    if( flags & PSYNTH_NET_FLAG_MAIN )
+    {
+	pnet->th_num = sconfig_get_int_value( "render_threads", 1, 0 );
+	if( pnet->th_num <= 0 ) pnet->th_num = sthread_get_cpu_count();
+	if( pnet->th_num > PSYNTH_MAX_THREADS ) pnet->th_num = PSYNTH_MAX_THREADS;
+    }
 #endif
     pnet->th = SMEM_ZALLOC2( psynth_thread, pnet->th_num );
     for( int i = 0; i < pnet->th_num; i++ ) psynth_thread_init( i, pnet );
+    psynth_plan_events( pnet );
     if( !( flags & PSYNTH_NET_FLAG_NO_MIDI ) )
     {
 	sunvox_engine* s = (sunvox_engine*)host;
@@ -277,10 +368,31 @@ void psynth_close( psynth_net* pnet )
     pnet->midi_in_mods_num = 0;
     smem_free( pnet->fft );
     smutex_destroy( &pnet->mods_mutex );
+    if( pnet->events_overflow ) slog( "%d events dropped (event arena overflow)\n", (int)pnet->events_overflow );
     smem_free( pnet->events_heap );
+    smem_free( pnet->events_mods );
+    psynth_prof_free( pnet->prof );
     pnet->th_exit_request = true;
+#ifdef PSYNTH_MULTITHREADED
+    for( int i = 1; i < pnet->th_num; i++ ) ssemaphore_release( &pnet->th_sem );
+#endif
     for( int i = 0; i < pnet->th_num; i++ ) psynth_thread_deinit( i, pnet );
     smem_free( pnet->th );
+#ifdef PSYNTH_MULTITHREADED
+    if( pnet->th_num > 1 )
+    {
+	ssemaphore_destroy( &pnet->th_sem );
+	smutex_destroy( &pnet->th_events_mutex );
+    }
+    smem_free( pnet->th_sched_mods );
+    smem_free( pnet->th_sched_rank );
+    smem_free( pnet->th_sched_deps );
+    smem_free( pnet->th_sched_deps_ptr );
+    smem_free( pnet->th_sched_pending0 );
+    smem_free( pnet->th_sched_pending );
+    smem_free( pnet->th_queue );
+    smem_free( pnet->th_events_rank );
+#endif
     smem_free( pnet );
 }
 void psynth_clear( psynth_net* pnet )
@@ -290,7 +402,7 @@ void psynth_clear( psynth_net* pnet )
 	for( uint i = 1; i < pnet->mods_num; i++ ) psynth_remove_module( i, pnet );
     }
 }
-uint32_t g_psynth_module_id_cnt = 0;
+std::atomic_uint g_psynth_module_id_cnt( 0 ); //modules may be created in parallel (MetaModule loading)
 int psynth_add_module(
     int n,
     psynth_handler_t handler,
@@ -341,7 +453,7 @@ int psynth_add_module(
     s->events_num = 0;
     s->events = SMEM_ALLOC2( int, DEFAULT_MODULE_EVENTS_NUM );
     if( !s->events ) return -1;
-    s->id = g_psynth_module_id_cnt++;
+    s->id = atomic_fetch_add( &g_psynth_module_id_cnt, 1 );
     if( name )
     {
 	smem_strcat( s->name, sizeof( s->name ), name );
@@ -454,6 +566,9 @@ int psynth_add_module(
 	    }
 	}
     }
+    s->scope_flags = 0;
+    s->peaks = NULL;
+#ifdef SUNVOX_GUI
     if( !( pnet->flags & PSYNTH_NET_FLAG_NO_SCOPE ) )
     {
 	for( int ch = 0; ch < max_channels; ch++ )
@@ -465,7 +580,9 @@ int psynth_add_module(
 		s->scope_buf[ ch ] = SMEM_ZALLOC2( PS_STYPE, PSYNTH_SCOPE_SIZE );
 	    }
 	}
+	s->scope_flags = PSYNTH_SCOPE_FLAG_RAW; 
     }
+#endif
     if( s->flags & PSYNTH_FLAG_GET_SPEED_CHANGES )
     {
 	evt.command = PS_CMD_SPEED_CHANGED;
@@ -491,6 +608,7 @@ int psynth_add_module(
 	psynth_remove_module( n, pnet );
 	n = -1;
     }
+    psynth_plan_events( pnet );
     return n;
 }
 void psynth_remove_module( uint mod_num, psynth_net* pnet )
@@ -529,6 +647,9 @@ void psynth_remove_module( uint mod_num, psynth_net* pnet )
 	smem_free( mod->scope_buf[ i ] );
 	mod->scope_buf[ i ] = NULL;
     }
+    mod->scope_flags = 0;
+    smem_free( mod->peaks );
+    mod->peaks = NULL;
     if( !( pnet->flags & PSYNTH_NET_FLAG_NO_MIDI ) )
     {
 	if( mod->midi_out >= 0 )
@@ -922,22 +1043,75 @@ void psynth_all_midi_notes_off( uint mod_num, stime_ticks_t t, psynth_net* pnet
     }
 #endif
 }
+void psynth_plan_events( psynth_net* pnet )
+{
+    int cap = DEFAULT_HEAP_EVENTS_NUM;
+#ifdef PSYNTH_MULTITHREADED
+    cap *= 4;
+#endif
+    if( cap < (int)pnet->mods_num * HEAP_EVENTS_PER_MODULE ) cap = pnet->mods_num * HEAP_EVENTS_PER_MODULE;
+    if( cap < pnet->events_peak * 2 ) cap = pnet->events_peak * 2; //headroom for the dense passages
+    if( cap > pnet->events_cap )
+    {
+#ifdef EVT_HEAP_DEBUG_MESSAGES
+	printf( "EVT HEAP RESIZE: %d -> %d\n", pnet->events_cap, cap );
+#endif
+	psynth_event* heap = SMEM_RESIZE2( pnet->events_heap, psynth_event, cap );
+	if( heap )
+	{
+	    pnet->events_heap = heap;
+	    pnet->events_cap = cap;
+	}
+    }
+#ifdef PSYNTH_MULTITHREADED
+    if( pnet->th_num > 1 && (int)SMEM_GET_SIZE2( pnet->th_events_rank ) < pnet->events_cap )
+	pnet->th_events_rank = SMEM_RESIZE2( pnet->th_events_rank, int, pnet->events_cap );
+#endif
+    if( SMEM_GET_SIZE2( pnet->events_mods ) < pnet->mods_num )
+	pnet->events_mods = SMEM_ZRESIZE2( pnet->events_mods, int, pnet->mods_num );
+    for( uint i = 0; i < pnet->mods_num; i++ )
+    {
+	psynth_module* mod = &pnet->mods[ i ];
+	if( !( mod->flags & PSYNTH_FLAG_EXISTS ) || mod->events_overflow == 0 ) continue;
+	int prev_size = SMEM_GET_SIZE2( mod->events );
+	int size = prev_size + ( (int)mod->events_overflow > prev_size ? (int)mod->events_overflow : prev_size );
+	if( size > pnet->events_cap ) size = pnet->events_cap; //a module can't get more than the whole arena
+	mod->events_overflow = 0;
+	if( size <= prev_size ) continue;
+#ifdef EVT_HEAP_DEBUG_MESSAGES
+	printf( "EVT HEAP (%s) RESIZE: %d -> %d\n", mod->name, prev_size, size );
+#endif
+	int* events = SMEM_RESIZE2( mod->events, int, size );
+	if( events ) mod->events = events;
+    }
+    pnet->events_overflow_planned = pnet->events_overflow;
+}
+bool psynth_plan_events_needed( psynth_net* pnet )
+{
+    if( (int)pnet->events_overflow != pnet->events_overflow_planned ) return true;
+    if( pnet->events_peak * 2 > pnet->events_cap ) return true;
+#ifdef PSYNTH_MULTITHREADED
+    if( pnet->th_num > 1 && (int)SMEM_GET_SIZE2( pnet->th_events_rank ) < pnet->events_cap ) return true;
+#endif
+    return false;
+}
 void psynth_reset_events( psynth_net* pnet )
 {
 #ifdef PSYNTH_MULTITHREADED
-    if( atomic_exchange( &pnet->events_num, 0 ) == 0 ) return;
+    int events_num = atomic_exchange( &pnet->events_num, 0 );
 #else
-    if( pnet->events_num == 0 ) return;
+    int events_num = pnet->events_num;
     pnet->events_num = 0;
 #endif
-    for( uint i = 0; i < pnet->mods_num; i++ )
+    if( events_num == 0 ) return;
+    if( events_num > pnet->events_peak ) pnet->events_peak = events_num;
+    //Only the modules that received the events since the last reset:
+    for( uint i = 0; i < pnet->events_mods_num; i++ )
     {
-	psynth_module* mod = &pnet->mods[ i ];
-	if( mod->flags & PSYNTH_FLAG_EXISTS )
-	{
-	    mod->events_num = 0;
-	}
+	uint mod_num = pnet->events_mods[ i ];
+	if( mod_num < pnet->mods_num ) pnet->mods[ mod_num ].events_num = 0;
     }
+    pnet->events_mods_num = 0;
 }
 void psynth_add_event( uint mod_num, psynth_event* evt, psynth_net* pnet )
 {
@@ -949,36 +1123,42 @@ void psynth_add_event( uint mod_num, psynth_event* evt, psynth_net* pnet )
 #else
     int events_num = pnet->events_num++;
 #endif
-    if( events_num >= (int)smem_get_size( pnet->events_heap ) / (int)sizeof( psynth_event ) )
+    if( events_num >= pnet->events_cap )
     {
+	//Overflow policy: drop the newest event; psynth_plan_events() will take events_peak into account next time:
 #ifdef PSYNTH_MULTITHREADED
-	if( pnet->th_num == 1 )
+	atomic_fetch_add( &pnet->events_overflow, 1 );
 #else
-	if( 1 )
+	pnet->events_overflow++;
 #endif
-	{
-#ifdef EVT_HEAP_DEBUG_MESSAGES
-	    printf( "EVT HEAP RESIZE: %d -> %d\n", (int)( smem_get_size( pnet->events_heap ) / sizeof( psynth_event ) ), (int)events_num * 2 );
-#endif
-	    pnet->events_heap = SMEM_RESIZE2( pnet->events_heap, psynth_event, events_num * 2 );
-	}
-	else
-	{
-#ifdef EVT_HEAP_DEBUG_MESSAGES
-	    printf( "EVT HEAP OVERFLOW\n" );
+	return;
+    }
+    pnet->events_heap[ events_num ] = *evt;
+#ifdef PSYNTH_MULTITHREADED
+    bool parallel = pnet->th_parallel;
+    if( parallel )
+    {
+	pnet->th_events_rank[ events_num - pnet->th_events_start ] = g_psynth_th_rank;
+	smutex_lock( &pnet->th_events_mutex );
+    }
 #endif
-	    return;
-	}
+    if( mod->events_num < SMEM_GET_SIZE2( mod->events ) )
+    {
+	if( mod->events_num == 0 ) pnet->events_mods[ pnet->events_mods_num++ ] = mod_num;
+	mod->events[ mod->events_num++ ] = events_num;
     }
-    if( mod->events_num >= smem_get_size( mod->events ) / sizeof( int ) )
+    else
     {
-#ifdef EVT_HEAP_DEBUG_MESSAGES
-	printf( "EVT HEAP (%s) RESIZE: %d -> %d\n", mod->name, (int)( smem_get_size( mod->events ) / sizeof( int ) ), (int)mod->events_num * 2 );
+	mod->events_overflow++;
+#ifdef PSYNTH_MULTITHREADED
+	atomic_fetch_add( &pnet->events_overflow, 1 );
+#else
+	pnet->events_overflow++;
 #endif
-	mod->events = SMEM_RESIZE2( mod->events, int, mod->events_num * 2 );
     }
-    mod->events[ mod->events_num++ ] = events_num;
-    pnet->events_heap[ events_num ] = *evt;
+#ifdef PSYNTH_MULTITHREADED
+    if( parallel ) smutex_unlock( &pnet->th_events_mutex );
+#endif
 }
 void psynth_multisend( psynth_module* mod, psynth_event* evt, psynth_net* pnet )
 {
@@ -1039,6 +1219,196 @@ static void psynth_cpu_usage_recalc( int frames, psynth_net* pnet )
     if( cpu_usage > pnet->cpu_usage1 ) pnet->cpu_usage1 = cpu_usage;
     if( cpu_usage > pnet->cpu_usage2 ) pnet->cpu_usage2 = cpu_usage;
 }
+static void psynth_prof_add( int mod_num, stime_ns_t t, psynth_net* pnet )
+{
+    psynth_prof* prof = pnet->prof;
+    if( !prof ) return;
+    int th = 0;
+#ifdef PSYNTH_MULTITHREADED
+    if( pnet->th_parallel ) th = pnet->mods[ mod_num ].th_id;
+#endif
+    if( (unsigned)th >= (unsigned)prof->rings_num ) return;
+    psynth_prof_ring* ring = &prof->rings[ th ];
+    uint wp = atomic_load_explicit( &ring->wp, std::memory_order_relaxed );
+    if( wp - atomic_load_explicit( &ring->rp, std::memory_order_acquire ) >= PSYNTH_PROF_RING_SIZE )
+    {
+	atomic_fetch_add_explicit( &prof->lost, 1, std::memory_order_relaxed );
+	return;
+    }
+    psynth_prof_record* r = &ring->r[ wp & ( PSYNTH_PROF_RING_SIZE - 1 ) ];
+    r->mod_num = mod_num;
+    r->th = th;
+    r->block = pnet->render_counter;
+    r->t = t;
+    stime_ns_t dur = stime_ns() - t;
+    r->dur = dur > 0xFFFFFFFF ? 0xFFFFFFFF : (uint32_t)dur;
+    atomic_store_explicit( &ring->wp, wp + 1, std::memory_order_release );
+}
+int psynth_prof_enable( bool enable, psynth_net* pnet )
+{
+    if( !enable )
+    {
+	pnet->cpu_usage_enable &= ~( 1 << 2 );
+	return 0;
+    }
+    if( !pnet->prof )
+    {
+	psynth_prof* prof = SMEM_ZALLOC2( psynth_prof, 1 );
+	if( !prof ) return -1;
+	prof->rings_num = pnet->th_num;
+	prof->rings = SMEM_ZALLOC2( psynth_prof_ring, prof->rings_num );
+	if( !prof->rings ) { psynth_prof_free( prof ); return -1; }
+	for( int i = 0; i < prof->rings_num; i++ )
+	{
+	    psynth_prof_ring* ring = &prof->rings[ i ];
+	    ring->r = SMEM_ALLOC2( psynth_prof_record, PSYNTH_PROF_RING_SIZE );
+	    if( !ring->r ) { psynth_prof_free( prof ); return -1; }
+	    atomic_init( &ring->wp, 0U );
+	    atomic_init( &ring->rp, 0U );
+	}
+	atomic_init( &prof->lost, 0U );
+	prof->t0 = stime_ns();
+	pnet->prof = prof;
+    }
+    pnet->cpu_usage_enable |= 1 << 2;
+    return 0;
+}
+static int psynth_prof_hist_index( uint32_t v )
+{
+    if( v < 8 ) return v;
+    int b = 0;
+    while( ( v >> b ) >= 16 ) b++;
+    int i = ( b + 1 ) * 8 + ( ( v >> b ) & 7 );
+    if( i >= PSYNTH_PROF_HIST_SIZE ) i = PSYNTH_PROF_HIST_SIZE - 1;
+    return i;
+}
+static uint32_t psynth_prof_hist_value( int i ) //upper bound
+{
+    if( i < 8 ) return i;
+    int b = i / 8 - 1;
+    return (uint32_t)( ( ( 8 + ( i & 7 ) + 1 ) << b ) - 1 );
+}
+int psynth_prof_read( psynth_prof_record* records, int max_records, psynth_net* pnet )
+{
+    psynth_prof* prof = pnet->prof;
+    if( !prof ) return 0;
+    int rv = 0;
+    for( int i = 0; i < prof->rings_num; i++ )
+    {
+	psynth_prof_ring* ring = &prof->rings[ i ];
+	uint rp = atomic_load_explicit( &ring->rp, std::memory_order_relaxed );
+	uint wp = atomic_load_explicit( &ring->wp, std::memory_order_acquire );
+	for( ; rp != wp && ( !records || rv < max_records ); rp++ )
+	{
+	    psynth_prof_record* r = &ring->r[ rp & ( PSYNTH_PROF_RING_SIZE - 1 ) ];
+	    if( (uint)r->mod_num >= prof->stats_num )
+	    {
+		uint new_num = pnet->mods_num;
+		if( new_num <= (uint)r->mod_num ) new_num = r->mod_num + 1;
+		psynth_prof_stat* stats = SMEM_ZRESIZE2( prof->stats, psynth_prof_stat, new_num );
+		if( !stats ) continue;
+		prof->stats = stats;
+		prof->stats_num = new_num;
+	    }
+	    psynth_prof_stat* st = &prof->stats[ r->mod_num ];
+	    if( st->cnt == 0 || r->dur < st->min ) st->min = r->dur;
+	    if( r->dur > st->max ) st->max = r->dur;
+	    st->cnt++;
+	    st->sum += r->dur;
+	    st->hist[ psynth_prof_hist_index( r->dur ) ]++;
+	    if( records ) records[ rv ] = *r;
+	    rv++;
+	}
+	atomic_store_explicit( &ring->rp, rp, std::memory_order_release );
+    }
+    return rv;
+}
+int psynth_prof_get_stat( uint mod_num, uint32_t* min, uint32_t* avg, uint32_t* max, uint32_t* p99, psynth_net* pnet )
+{
+    psynth_prof* prof = pnet->prof;
+    if( !prof || mod_num >= prof->stats_num ) return 0;
+    psynth_prof_stat* st = &prof->stats[ mod_num ];
+    if( st->cnt == 0 ) return 0;
+    if( min ) *min = st->min;
+    if( avg ) *avg = (uint32_t)( st->sum / st->cnt );
+    if( max ) *max = st->max;
+    if( p99 )
+    {
+	uint32_t n = st->cnt - st->cnt / 100;
+	uint32_t c = 0;
+	int i = 0;
+	for( ; i < PSYNTH_PROF_HIST_SIZE - 1; i++ )
+	{
+	    c += st->hist[ i ];
+	    if( c >= n ) break;
+	}
+	uint32_t v = psynth_prof_hist_value( i );
+	if( v > st->max ) v = st->max;
+	if( v < st->min ) v = st->min;
+	*p99 = v;
+    }
+    return st->cnt;
+}
+int psynth_prof_save_trace( const char* filename, psynth_net* pnet )
+{
+    psynth_prof* prof = pnet->prof;
+    if( !prof ) return -1;
+    sfs_file f = sfs_open( filename, "wb" );
+    if( !f ) return -1;
+    const int buf_size = 4096;
+    psynth_prof_record* records = SMEM_ALLOC2( psynth_prof_record, buf_size );
+    char* ts = SMEM_ALLOC2( char, 512 );
+    if( !records || !ts ) { smem_free( records ); smem_free( ts ); sfs_close( f ); return -1; }
+    const char* hdr = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    sfs_write( hdr, 1, smem_strlen( hdr ), f );
+    bool first = true;
+    for( int i = 0; i < prof->rings_num; i++ )
+    {
+	sprintf( ts, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"render thread %d\"}}", first ? "" : ",\n", i, i );
+	sfs_write( ts, 1, smem_strlen( ts ), f );
+	first = false;
+    }
+    while( 1 )
+    {
+	int num = psynth_prof_read( records, buf_size, pnet );
+	if( num <= 0 ) break;
+	for( int i = 0; i < num; i++ )
+	{
+	    psynth_prof_record* r = &records[ i ];
+	    char name[ 64 ];
+	    int n = sprintf( name, "%02X", r->mod_num );
+	    psynth_module* mod = psynth_get_module( r->mod_num, pnet );
+	    if( mod )
+	    {
+		name[ n++ ] = ' ';
+		for( const char* p = mod->name; *p && n < (int)sizeof( name ) - 2; p++ )
+		{
+		    if( *p == '"' || *p == '\\' ) name[ n++ ] = '\\';
+		    name[ n++ ] = ( (uint8_t)*p < 32 ) ? ' ' : *p;
+		}
+	    }
+	    name[ n ] = 0;
+	    sprintf( ts, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"module\":%d,\"block\":%u}}",
+		name, r->th, (double)( r->t - prof->t0 ) / 1000, (double)r->dur / 1000, r->mod_num, r->block );
+	    sfs_write( ts, 1, smem_strlen( ts ), f );
+	}
+    }
+    sprintf( ts, "\n],\"otherData\":{\"lost\":%u}}\n", atomic_load( &prof->lost ) );
+    sfs_write( ts, 1, smem_strlen( ts ), f );
+    sfs_close( f );
+    smem_free( records );
+    smem_free( ts );
+    return 0;
+}
+void psynth_prof_reset( psynth_net* pnet )
+{
+    psynth_prof* prof = pnet->prof;
+    if( !prof ) return;
+    psynth_prof_read( NULL, 0, pnet );
+    if( prof->stats ) smem_clear( prof->stats, prof->stats_num * sizeof( psynth_prof_stat ) );
+    atomic_store( &prof->lost, 0U );
+    prof->t0 = stime_ns();
+}
 PS_STYPE* psynth_get_scope_buffer( int ch, int* offset, int* size, uint mod_num, stime_ticks_t t, psynth_net* pnet )
 {
     psynth_module* mod = &pnet->mods[ mod_num ];
@@ -1056,6 +1426,7 @@ PS_STYPE* psynth_get_scope_buffer( int ch, int* offset, int* size, uint mod_num,
     }
     if( (unsigned)ch >= (unsigned)channels ) return NULL;
     if( !data ) return NULL;
+    if( !( mod->scope_flags & PSYNTH_SCOPE_FLAG_RAW ) ) return NULL;
     PS_STYPE* buf = mod->scope_buf[ ch ];
     if( buf )
     {
@@ -1088,6 +1459,93 @@ PS_STYPE* psynth_get_scope_buffer( int ch, int* offset, int* size, uint mod_num,
     }
     return 0;
 }
+int psynth_set_scope( uint mod_num, uint flags, int peak_frames, psynth_net* pnet )
+{
+    psynth_module* mod = psynth_get_module( mod_num, pnet );
+    if( !mod ) return -1;
+    if( flags & PSYNTH_SCOPE_FLAG_RAW )
+    {
+	if( ( pnet->flags & PSYNTH_NET_FLAG_NO_SCOPE ) || ( mod->flags & PSYNTH_FLAG_NO_SCOPE_BUF ) ) 
+	    flags &= ~PSYNTH_SCOPE_FLAG_RAW;
+	for( int ch = 0; ch < PSYNTH_MAX_CHANNELS && ( flags & PSYNTH_SCOPE_FLAG_RAW ); ch++ )
+	{
+	    if( mod->scope_buf[ ch ] ) continue;
+	    mod->scope_buf[ ch ] = SMEM_ZALLOC2( PS_STYPE, PSYNTH_SCOPE_SIZE );
+	    if( !mod->scope_buf[ ch ] ) flags &= ~PSYNTH_SCOPE_FLAG_RAW;
+	}
+    }
+    if( flags & PSYNTH_SCOPE_FLAG_PEAKS )
+    {
+	if( peak_frames <= 0 ) peak_frames = PSYNTH_PEAKS_DEF_RESOLUTION;
+	if( !mod->peaks || mod->peaks->resolution != peak_frames )
+	{
+	    smem_free( mod->peaks );
+	    mod->peaks = SMEM_ZALLOC2( psynth_peaks, 1 );
+	    if( mod->peaks )
+	    {
+		mod->peaks->resolution = peak_frames;
+		for( int ch = 0; ch < PSYNTH_MAX_CHANNELS; ch++ )
+		{
+		    mod->peaks->min[ ch ] = 1e30F;
+		    mod->peaks->max[ ch ] = -1e30F;
+		}
+		atomic_init( &mod->peaks->wp, 0 );
+	    }
+	    else flags &= ~PSYNTH_SCOPE_FLAG_PEAKS;
+	}
+    }
+    else
+    {
+	if( mod->peaks )
+	{
+	    mod->scope_flags &= ~PSYNTH_SCOPE_FLAG_PEAKS;
+	    smem_free( mod->peaks );
+	    mod->peaks = NULL;
+	}
+    }
+    COMPILER_MEMORY_BARRIER();
+    mod->scope_flags = flags;
+    return 0;
+}
+uint psynth_get_peaks( uint mod_num, int ch, float* dest, uint count, uint* pos, psynth_net* pnet )
+{
+    psynth_module* mod = psynth_get_module( mod_num, pnet );
+    if( !mod ) return 0;
+    psynth_peaks* p = mod->peaks;
+    if( !p || !( mod->scope_flags & PSYNTH_SCOPE_FLAG_PEAKS ) ) return 0;
+    int channels = mod->output_channels;
+    if( mod->flags & PSYNTH_FLAG_OUTPUT ) channels = mod->input_channels;
+    if( (unsigned)ch >= (unsigned)channels || ch >= PSYNTH_MAX_CHANNELS ) return 0;
+    uint wp = atomic_load( &p->wp );
+    uint avail = wp;
+    if( avail > PSYNTH_PEAKS_SIZE - 16 ) avail = PSYNTH_PEAKS_SIZE - 16; //don't read the entries that may be overwritten right now
+    uint start = wp - avail;
+    if( pos )
+    {
+	if( (int)( *pos - start ) > 0 ) start = *pos;
+	if( (int)( wp - start ) < 0 ) start = wp;
+    }
+    uint n = wp - start;
+    if( n > count )
+    {
+	if( pos )
+	    n = count;
+	else
+	{
+	    start = wp - count;
+	    n = count;
+	}
+    }
+    for( uint i = 0; i < n; i++ )
+    {
+	float* src = &p->buf[ ch ][ ( ( start + i ) & ( PSYNTH_PEAKS_SIZE - 1 ) ) * 3 ];
+	dest[ i * 3 + 0 ] = src[ 0 ];
+	dest[ i * 3 + 1 ] = src[ 1 ];
+	dest[ i * 3 + 2 ] = src[ 2 ];
+    }
+    if( pos ) *pos = start + n;
+    return n;
+}
 static void psynth_change_scope_buffers( stime_ticks_t t, psynth_net* pnet )
 {
 #ifdef PSYNTH_SCOPE_MODE_SLOW_HQ
@@ -1097,12 +1555,80 @@ static void psynth_change_scope_buffers( stime_ticks_t t, psynth_net* pnet )
     pnet->scope_buf_start_time[ pnet->scope_buf_current ] = t;
 #endif
 }
+static void psynth_fill_peaks( psynth_peaks* p, PS_STYPE** channels_arr, int* empty_arr, int num_channels, int buf_size )
+{
+    if( num_channels > PSYNTH_MAX_CHANNELS ) num_channels = PSYNTH_MAX_CHANNELS;
+    int i = 0;
+    while( i < buf_size )
+    {
+	int size = p->resolution - p->frames;
+	if( size > buf_size - i ) size = buf_size - i;
+	for( int ch = 0; ch < num_channels; ch++ )
+	{
+	    PS_STYPE* data = channels_arr[ ch ];
+	    float vmin = p->min[ ch ];
+	    float vmax = p->max[ ch ];
+	    int zeros = size; //the first empty_arr[ ch ] frames of the buffer are silent
+	    if( data && empty_arr[ ch ] < i + size )
+	    {
+		zeros = empty_arr[ ch ] - i;
+		if( zeros < 0 ) zeros = 0;
+		float sum2 = 0;
+		for( int j = i + zeros; j < i + size; j++ )
+		{
+		    float v; PS_STYPE_TO_FLOAT( v, data[ j ] );
+		    if( v < vmin ) vmin = v;
+		    if( v > vmax ) vmax = v;
+		    sum2 += v * v;
+		}
+		p->sum2[ ch ] += sum2;
+	    }
+	    if( zeros > 0 )
+	    {
+		if( vmin > 0 ) vmin = 0;
+		if( vmax < 0 ) vmax = 0;
+	    }
+	    p->min[ ch ] = vmin;
+	    p->max[ ch ] = vmax;
+	}
+	i += size;
+	p->frames += size;
+	if( p->frames >= p->resolution )
+	{
+	    uint wp = atomic_load( &p->wp );
+	    int n = ( wp & ( PSYNTH_PEAKS_SIZE - 1 ) ) * 3;
+	    for( int ch = 0; ch < PSYNTH_MAX_CHANNELS; ch++ )
+	    {
+		float* dest = &p->buf[ ch ][ n ];
+		if( p->min[ ch ] <= p->max[ ch ] )
+		{
+		    dest[ 0 ] = p->min[ ch ];
+		    dest[ 1 ] = p->max[ ch ];
+		    dest[ 2 ] = sqrtf( p->sum2[ ch ] / p->resolution );
+		}
+		else
+		{
+		    dest[ 0 ] = 0;
+		    dest[ 1 ] = 0;
+		    dest[ 2 ] = 0;
+		}
+		p->min[ ch ] = 1e30F;
+		p->max[ ch ] = -1e30F;
+		p->sum2[ ch ] = 0;
+	    }
+	    p->frames = 0;
+	    atomic_store( &p->wp, wp + 1 );
+	}
+    }
+}
 static void psynth_fill_scope_buffers( int buf_size, psynth_net* pnet )
 {
     int scope_ptr_start = pnet->scope_buf_cur_ptr;
     for( uint i = 0; i < pnet->mods_num; i++ )
     {
 	psynth_module* mod = &pnet->mods[ i ];
+	uint scope_flags = mod->scope_flags;
+	if( scope_flags == 0 ) continue;
 	int num_channels = mod->output_channels;
 	PS_STYPE** channels_arr = mod->channels_out;
 	int* empty_arr = mod->out_empty;
@@ -1112,6 +1638,9 @@ static void psynth_fill_scope_buffers( int buf_size, psynth_net* pnet )
 	    channels_arr = mod->channels_in;
 	    empty_arr = mod->in_empty;
 	}
+	if( ( scope_flags & PSYNTH_SCOPE_FLAG_PEAKS ) && mod->peaks )
+	    psynth_fill_peaks( mod->peaks, channels_arr, empty_arr, num_channels, buf_size );
+	if( !( scope_flags & PSYNTH_SCOPE_FLAG_RAW ) ) continue;
 	for( int ch = 0; ch < num_channels; ch++ )
 	{
 	    PS_STYPE* data = channels_arr[ ch ];
@@ -1206,6 +1735,83 @@ static void psynth_fill_scope_buffers( int buf_size, psynth_net* pnet )
     if( (END) > (BEGIN) ) smem_clear( (BUF) + (BEGIN), ( (END) - (BEGIN) ) * sizeof( PS_STYPE ) );
 #define PS_STYPE_BUF_COPY( DEST, SRC, BEGIN, END ) \
     if( (END) > (BEGIN) ) smem_copy( (DEST) + (BEGIN), (SRC) + (BEGIN), ( (END) - (BEGIN) ) * sizeof( PS_STYPE ) );
+//DEST[ BEGIN...END-1 ] += SRC[ BEGIN...END-1 ]:
+static void psynth_buf_add( PS_STYPE* RESTRICT dest, const PS_STYPE* RESTRICT src, int begin, int end )
+{
+    int i = begin;
+#if defined(__SSE2__)
+#if defined(PS_STYPE_FLOAT32)
+    for( ; i + 8 <= end; i += 8 )
+    {
+	__m128 a0 = _mm_add_ps( _mm_loadu_ps( dest + i ), _mm_loadu_ps( src + i ) );
+	__m128 a1 = _mm_add_ps( _mm_loadu_ps( dest + i + 4 ), _mm_loadu_ps( src + i + 4 ) );
+	_mm_storeu_ps( dest + i, a0 );
+	_mm_storeu_ps( dest + i + 4, a1 );
+    }
+#elif defined(PS_STYPE_INT16)
+    for( ; i + 8 <= end; i += 8 )
+	_mm_storeu_si128( (__m128i*)( dest + i ), _mm_add_epi16( _mm_loadu_si128( (const __m128i*)( dest + i ) ), _mm_loadu_si128( (const __m128i*)( src + i ) ) ) );
+#endif
+#elif ( defined(__ARM_NEON) || defined(__ARM_NEON__) ) && defined(__aarch64__)
+#if defined(PS_STYPE_FLOAT32)
+    for( ; i + 8 <= end; i += 8 )
+    {
+	vst1q_f32( dest + i, vaddq_f32( vld1q_f32( dest + i ), vld1q_f32( src + i ) ) );
+	vst1q_f32( dest + i + 4, vaddq_f32( vld1q_f32( dest + i + 4 ), vld1q_f32( src + i + 4 ) ) );
+    }
+#elif defined(PS_STYPE_INT16)
+    for( ; i + 8 <= end; i += 8 )
+	vst1q_s16( dest + i, vaddq_s16( vld1q_s16( dest + i ), vld1q_s16( src + i ) ) );
+#endif
+#endif
+    for( ; i < end; i++ ) dest[ i ] += src[ i ];
+}
+//Zero-copy input: channels_in[ ch ] = output buffer of the single input module:
+static inline void psynth_share_input( int ch, PS_STYPE* src, int src_empty, psynth_module* mod )
+{
+    if( !( mod->in_shared & ( 1 << ch ) ) )
+    {
+	mod->channels_in_own[ ch ] = mod->channels_in[ ch ];
+	mod->in_own_empty[ ch ] = mod->in_empty[ ch ];
+	mod->in_shared |= 1 << ch;
+    }
+    mod->channels_in[ ch ] = src;
+    mod->in_empty[ ch ] = src_empty;
+}
+//Copy-on-write: return the own input buffers with the same content (before any write to channels_in[]):
+static void psynth_unshare_input( int buf_size, psynth_module* mod )
+{
+    for( int ch = 0; ch < PSYNTH_MAX_CHANNELS && mod->in_shared; ch++ )
+    {
+	if( !( mod->in_shared & ( 1 << ch ) ) ) continue;
+	mod->in_shared &= ~( 1 << ch );
+	PS_STYPE* own = mod->channels_in_own[ ch ];
+	PS_STYPE* src = mod->channels_in[ ch ];
+	int empty = mod->in_empty[ ch ];
+	if( empty < buf_size )
+	{
+	    PS_STYPE_BUF_CLEAN( own, mod->in_own_empty[ ch ], empty );
+	    PS_STYPE_BUF_COPY( own, src, empty, buf_size );
+	}
+	else
+	{
+	    PS_STYPE_BUF_CLEAN( own, mod->in_own_empty[ ch ], buf_size );
+	    mod->in_empty[ ch ] = buf_size;
+	}
+	mod->channels_in[ ch ] = own;
+    }
+}
+//Return the own input buffers without copying (after the rendering):
+static inline void psynth_release_input( psynth_module* mod )
+{
+    for( int ch = 0; ch < PSYNTH_MAX_CHANNELS && mod->in_shared; ch++ )
+    {
+	if( !( mod->in_shared & ( 1 << ch ) ) ) continue;
+	mod->in_shared &= ~( 1 << ch );
+	mod->channels_in[ ch ] = mod->channels_in_own[ ch ];
+	mod->in_empty[ ch ] = mod->in_own_empty[ ch ];
+    }
+}
 static void psynth_set_output_content( int offset, int size, int channels_filled, psynth_module* mod )
 {
     int end = offset + size;
@@ -1397,15 +2003,41 @@ void psynth_render_end( int frames, psynth_net* pnet )
 	psynth_cpu_usage_recalc( frames, pnet );
     }
 }
-void psynth_render_setup( int buf_size, stime_ticks_t out_time, void* in_buf, sound_buffer_type in_buf_type, int in_buf_channels, psynth_net* pnet )
+void psynth_render_setup( int buf_size, stime_ticks_t out_time, void* in_buf, sound_buffer_type in_buf_type, int in_buf_channels, bool in_buf_planar, psynth_net* pnet )
 {
     pnet->buf_size = buf_size;
     pnet->out_time = out_time;
     pnet->in_buf = in_buf;
     pnet->in_buf_type = in_buf_type;
     pnet->in_buf_channels = in_buf_channels;
+    pnet->in_buf_planar = in_buf_planar;
     pnet->render_counter++;
 }
+#ifdef PSYNTH_MULTITHREADED
+//Restore the single-threaded order of the events sent by the other modules:
+//(events from the host first, then the events from each sender in the order of the render schedule)
+static inline int64_t psynth_event_order( int evt_num, psynth_net* pnet )
+{
+    int64_t rank = -1;
+    if( evt_num >= pnet->th_events_start ) rank = pnet->th_events_rank[ evt_num - pnet->th_events_start ];
+    return ( ( rank + 1 ) << 32 ) | evt_num;
+}
+static void psynth_sort_events_by_sender( psynth_module* mod, psynth_net* pnet )
+{
+    for( uint i = 1; i < mod->events_num; i++ )
+    {
+	int key_evt_num = mod->events[ i ];
+	int64_t key = psynth_event_order( key_evt_num, pnet );
+	uint j = i;
+	while( j > 0 && psynth_event_order( mod->events[ j - 1 ], pnet ) > key )
+	{
+	    mod->events[ j ] = mod->events[ j - 1 ];
+	    j--;
+	}
+	if( j != i ) mod->events[ j ] = key_evt_num;
+    }
+}
+#endif
 static int psynth_render( int start_mod, psynth_net* pnet )
 {
     int retval = 0;
@@ -1426,6 +2058,7 @@ static int psynth_render( int start_mod, psynth_net* pnet )
     }
     if( mod->flags & PSYNTH_FLAG_DONT_FILL_INPUT ) dont_fill_input = 1; else dont_fill_input = 0;
     if( mod->realtime_flags & PSYNTH_RT_FLAG_BYPASS ) dont_fill_input = 0;
+    bool share_input = ( mod->flags2 & PSYNTH_FLAG2_READONLY_INPUT ) && !dont_fill_input && !( mod->flags & PSYNTH_FLAG_FEEDBACK );
     bool input_rendered = false;
     for( int inp = 0; inp < mod->input_links_num; inp++ )
     {
@@ -1443,6 +2076,9 @@ static int psynth_render( int start_mod, psynth_net* pnet )
 	    }
 	    if( !( in->realtime_flags & PSYNTH_RT_FLAG_RENDERED ) )
 	    {
+#ifdef PSYNTH_MULTITHREADED
+		if( pnet->th_parallel ) continue; //locked by the cyclic link (see psynth_build_schedule())
+#endif
 		if( psynth_render( input_mod_num, pnet ) != 0 )
 		{
 		    continue;
@@ -1474,7 +2110,11 @@ static int psynth_render( int start_mod, psynth_net* pnet )
 			prev_ch = in_ch;
 			if( in_data && out_data )
 			{
-			    if( in->out_empty[ in_ch ] < buf_size )
+			    if( share_input )
+			    {
+				psynth_share_input( ch, in_data, in->out_empty[ in_ch ], mod );
+			    }
+			    else if( in->out_empty[ in_ch ] < buf_size )
 			    {
 				if( !dont_fill_input )
 				{
@@ -1498,6 +2138,7 @@ static int psynth_render( int start_mod, psynth_net* pnet )
 		}
 		else
 		{
+		    psynth_unshare_input( buf_size, mod ); //more than one input: mix them in the own buffers
 		    for( int ch = 0; ch < mod->input_channels; ch++ )
 		    {
 			PS_STYPE* in_data = in->channels_out[ ch ]; if( ch >= in->output_channels ) in_data = 0;
@@ -1510,10 +2151,7 @@ static int psynth_render( int start_mod, psynth_net* pnet )
 			{
 			    if( !dont_fill_input )
 			    {
-				for( int i = in->out_empty[ in_ch ]; i < buf_size; i++ )
-				{
-				    out_data[ i ] += in_data[ i ];
-				}
+				psynth_buf_add( out_data, in_data, in->out_empty[ in_ch ], buf_size );
 			    }
 			    if( in->out_empty[ in_ch ] < mod->in_empty[ ch ] )
 				mod->in_empty[ ch ] = in->out_empty[ in_ch ];
@@ -1531,6 +2169,7 @@ static int psynth_render( int start_mod, psynth_net* pnet )
     	    goto ignore_module;
     	}
     }
+    if( !input_rendered ) psynth_release_input( mod ); //silence: nothing to share
     if( !input_rendered && ( mod->flags & PSYNTH_FLAG_EFFECT ) && !( mod->realtime_flags & PSYNTH_RT_FLAG_DONT_CLEAN_INPUT ) )
     {
         for( int c = 0; c < mod->input_channels; c++ )
@@ -1549,9 +2188,11 @@ static int psynth_render( int start_mod, psynth_net* pnet )
     if( mod->flags & PSYNTH_FLAG_INITIALIZED )
     {
         stime_ticks_t synth_start_time = 0;
-        if( pnet->cpu_usage_enable & 1 )
+        stime_ns_t prof_start_time = 0;
+        if( pnet->cpu_usage_enable )
         {
-            synth_start_time = stime_ticks();
+            if( pnet->cpu_usage_enable & 1 ) synth_start_time = stime_ticks();
+            if( pnet->cpu_usage_enable & 4 ) prof_start_time = stime_ns();
         }
 	if( !( mod->flags & PSYNTH_FLAG_IGNORE_MUTE ) )
 	{
@@ -1590,6 +2231,9 @@ static int psynth_render( int start_mod, psynth_net* pnet )
 	}
 	else
 	{
+#ifdef PSYNTH_MULTITHREADED
+	    if( pnet->th_parallel ) psynth_sort_events_by_sender( mod, pnet );
+#endif
 	    for( uint i = 1; i < mod->events_num; i++ )
 	    {
 		int key_evt_num = mod->events[ i ];
@@ -1811,6 +2455,7 @@ static int psynth_render( int start_mod, psynth_net* pnet )
 			    }
 			    if( empty_input )
 			    {
+				psynth_unshare_input( buf_size, mod );
 				psynth_set_input_content( 0, buf_size, 0, mod );
 			    }
 			}
@@ -1856,15 +2501,20 @@ static int psynth_render( int start_mod, psynth_net* pnet )
 		RENDER_SET_OUTPUT_CONTENT( mod->offset, mod->frames ); 
 	    }
 	}
-        if( pnet->cpu_usage_enable & 1 )
+        if( pnet->cpu_usage_enable )
         {
-            stime_ticks_t synth_end_time = stime_ticks();
-	    mod->cpu_usage_ticks += synth_end_time - synth_start_time;
+            if( pnet->cpu_usage_enable & 1 )
+            {
+        	stime_ticks_t synth_end_time = stime_ticks();
+		mod->cpu_usage_ticks += synth_end_time - synth_start_time;
+	    }
+	    if( pnet->cpu_usage_enable & 4 ) psynth_prof_add( start_mod, prof_start_time, pnet );
 	}
     }
     if( mod->flags & PSYNTH_FLAG_USE_MUTEX )
 	smutex_unlock( &mod->mutex );
 ignore_module:
+    psynth_release_input( mod );
     volatile uint new_ui_flags = mod->ui_flags;
     if( mod->realtime_flags & PSYNTH_RT_FLAG_MUTE ) new_ui_flags |= PSYNTH_UI_FLAG_MUTE; else new_ui_flags &= ~PSYNTH_UI_FLAG_MUTE;
     if( mod->realtime_flags & PSYNTH_RT_FLAG_SOLO ) new_ui_flags |= PSYNTH_UI_FLAG_SOLO; else new_ui_flags &= ~PSYNTH_UI_FLAG_SOLO;
@@ -1896,6 +2546,9 @@ static int psynth_render_module0( psynth_net* pnet )
 	    in = &pnet->mods[ mod->input_links[ inp ] ];
 	    if( !( in->realtime_flags & PSYNTH_RT_FLAG_RENDERED ) )
 	    {
+#ifdef PSYNTH_MULTITHREADED
+		if( !pnet->th_parallel )
+#endif
 		psynth_render( mod->input_links[ inp ], pnet );
 	    }
 	    if( in->realtime_flags & PSYNTH_RT_FLAG_RENDERED )
@@ -1923,10 +2576,7 @@ static int psynth_render_module0( psynth_net* pnet )
 		    {
 			if( main_input_rendered[ ch ] )
 	    		{
-			    for( int i = in->out_empty[ in_ch ]; i < buf_size; i++ )
-			    {
-				out_data[ i ] += in_data[ i ];
-			    }
+			    psynth_buf_add( out_data, in_data, in->out_empty[ in_ch ], buf_size );
 			    if( in->out_empty[ in_ch ] < mod->in_empty[ ch ] )
 				mod->in_empty[ ch ] = in->out_empty[ in_ch ];
 			}
@@ -1984,6 +2634,123 @@ static int psynth_render_module0( psynth_net* pnet )
     mod->realtime_flags |= PSYNTH_RT_FLAG_RENDERED;
     return retval;
 }
+#ifdef PSYNTH_MULTITHREADED
+//Same walk as the single-threaded psynth_render_module0() + psynth_render( 1...mods_num-1 ):
+static int psynth_schedule_visit( int mod_num, bool module0, int* next, psynth_net* pnet )
+{
+    psynth_module* mod = &pnet->mods[ mod_num ];
+    int* rank = pnet->th_sched_rank;
+    if( !module0 && !( mod->flags & PSYNTH_FLAG_EXISTS ) ) return -1;
+    if( rank[ mod_num ] >= 0 ) return 0;
+    if( rank[ mod_num ] == -2 ) return -1; //locked
+    rank[ mod_num ] = -2;
+    for( int inp = 0; inp < mod->input_links_num; inp++ )
+    {
+	int in = mod->input_links[ inp ];
+	if( (unsigned)in >= pnet->mods_num ) continue;
+	if( !module0 && ( mod->flags & PSYNTH_FLAG_FEEDBACK ) && ( pnet->mods[ in ].flags & PSYNTH_FLAG_FEEDBACK ) ) continue;
+	if( rank[ in ] < 0 ) psynth_schedule_visit( in, false, next, pnet );
+    }
+    rank[ mod_num ] = *next;
+    pnet->th_sched_mods[ *next ] = mod_num;
+    (*next)++;
+    return 0;
+}
+static int psynth_schedule_edges( bool fill, psynth_net* pnet )
+{
+    //Every link (including the feedback and cyclic ones) orders its two modules as in the single-threaded mode:
+    //the data, the SOLO flags and the events (sent to the output links) are exchanged in the same order.
+    int edges = 0;
+    int* rank = pnet->th_sched_rank;
+    for( int r = 0; r < pnet->th_sched_num; r++ )
+    {
+	psynth_module* mod = &pnet->mods[ pnet->th_sched_mods[ r ] ];
+	for( int dir = 0; dir < 2; dir++ )
+	{
+	    int* links = dir ? mod->output_links : mod->input_links;
+	    int links_num = dir ? mod->output_links_num : mod->input_links_num;
+	    for( int i = 0; i < links_num; i++ )
+	    {
+		int l = links[ i ];
+		if( (unsigned)l >= pnet->mods_num ) continue;
+		int r2 = rank[ l ];
+		if( r2 < 0 || r2 == r ) continue;
+		int from = r; int to = r2;
+		if( r2 < r ) { from = r2; to = r; }
+		if( fill )
+		{
+		    pnet->th_sched_deps[ pnet->th_sched_deps_ptr[ from + 1 ]++ ] = to;
+		    pnet->th_sched_pending0[ to ]++;
+		}
+		else
+		{
+		    pnet->th_sched_deps_ptr[ from + 1 ]++;
+		}
+		edges++;
+	    }
+	}
+    }
+    return edges;
+}
+static void psynth_build_schedule( psynth_net* pnet )
+{
+    pnet->th_sched_cc2 = pnet->change_counter2;
+    int mods_num = pnet->mods_num;
+    if( pnet->th_sched_mods_num != (uint)mods_num )
+    {
+	pnet->th_sched_mods_num = mods_num;
+	pnet->th_sched_mods = SMEM_RESIZE2( pnet->th_sched_mods, int, mods_num );
+	pnet->th_sched_rank = SMEM_RESIZE2( pnet->th_sched_rank, int, mods_num );
+	pnet->th_sched_deps_ptr = SMEM_RESIZE2( pnet->th_sched_deps_ptr, int, mods_num + 1 );
+	pnet->th_sched_pending0 = SMEM_RESIZE2( pnet->th_sched_pending0, int, mods_num );
+	pnet->th_sched_pending = SMEM_RESIZE2( pnet->th_sched_pending, std::atomic_int, mods_num );
+	pnet->th_queue = SMEM_RESIZE2( pnet->th_queue, std::atomic_int, mods_num );
+    }
+    int next = 0;
+    for( int i = 0; i < mods_num; i++ ) pnet->th_sched_rank[ i ] = -1;
+    psynth_schedule_visit( 0, true, &next, pnet );
+    for( int i = 1; i < mods_num; i++ ) psynth_schedule_visit( i, false, &next, pnet );
+    pnet->th_sched_num = next;
+    for( int r = 0; r <= next; r++ ) pnet->th_sched_deps_ptr[ r ] = 0;
+    int edges = psynth_schedule_edges( false, pnet );
+    for( int r = 0; r < next; r++ ) pnet->th_sched_deps_ptr[ r + 1 ] += pnet->th_sched_deps_ptr[ r ];
+    if( (int)SMEM_GET_SIZE2( pnet->th_sched_deps ) < edges )
+	pnet->th_sched_deps = SMEM_RESIZE2( pnet->th_sched_deps, int, edges );
+    for( int r = next; r > 0; r-- ) pnet->th_sched_deps_ptr[ r ] = pnet->th_sched_deps_ptr[ r - 1 ];
+    pnet->th_sched_deps_ptr[ 0 ] = 0;
+    for( int r = 0; r < next; r++ ) pnet->th_sched_pending0[ r ] = 0;
+    psynth_schedule_edges( true, pnet );
+}
+static bool psynth_parallel_begin( psynth_net* pnet )
+{
+    if( pnet->th_sched_cc2 != pnet->change_counter2 || pnet->th_sched_mods_num != pnet->mods_num )
+	psynth_build_schedule( pnet );
+    int num = pnet->th_sched_num;
+    if( num < 2 ) return false;
+#ifndef NOMIDI
+    if( !( pnet->flags & PSYNTH_NET_FLAG_NO_MIDI ) )
+    {
+	//MIDI OUT must be sent from one thread:
+	for( int r = 0; r < num; r++ )
+	    if( pnet->mods[ pnet->th_sched_mods[ r ] ].midi_out >= 0 ) return false;
+    }
+#endif
+    if( !pnet->th_events_rank ) return false;
+    pnet->th_events_start = atomic_load( &pnet->events_num );
+    int tail = 0;
+    for( int r = 0; r < num; r++ )
+    {
+	atomic_store( &pnet->th_sched_pending[ r ], pnet->th_sched_pending0[ r ] );
+	atomic_store( &pnet->th_queue[ r ], 0 );
+    }
+    for( int r = 0; r < num; r++ )
+	if( pnet->th_sched_pending0[ r ] == 0 ) atomic_store( &pnet->th_queue[ tail++ ], r + 1 );
+    atomic_store( &pnet->th_queue_head, 0 );
+    atomic_store( &pnet->th_queue_tail, tail );
+    atomic_store( &pnet->th_done, 0 );
+    return true;
+}
+#endif
 void psynth_render_all( psynth_net* pnet )
 {
     pnet->all_modules_muted = 0;
@@ -2012,21 +2779,27 @@ void psynth_render_all( psynth_net* pnet )
 	}
     }
 #ifdef PSYNTH_MULTITHREADED
-    pnet->th_work_t = stime_ticks();
-    pnet->th_work = true;
+    if( pnet->th_num > 1 && psynth_parallel_begin( pnet ) )
+    {
+	pnet->th_work_t = stime_ticks();
+	pnet->th_parallel = true;
+	atomic_store( &pnet->th_work, 1 );
+	for( int i = 1; i < pnet->th_num; i++ ) ssemaphore_release( &pnet->th_sem );
+	psynth_render_scheduled( 0, pnet );
+	atomic_store( &pnet->th_work, 0 );
+	while( 1 )
+	{
+	    if( atomic_load( &pnet->th_work_cnt ) == 0 ) break;
+	    sthread_yield();
+	}
+	pnet->th_parallel = false;
+    }
+    else
 #endif
-    psynth_render_module0( pnet );
-    for( uint i = 1; i < pnet->mods_num; i++ ) psynth_render( i, pnet );
-#ifdef PSYNTH_MULTITHREADED
-    pnet->th_work = false;
-    COMPILER_MEMORY_BARRIER();
-    stime_ticks_t t1 = stime_ticks();
-    while( 1 )
     {
-	if( atomic_load( &pnet->th_work_cnt ) == 0 ) break;
+	psynth_render_module0( pnet );
+	for( uint i = 1; i < pnet->mods_num; i++ ) psynth_render( i, pnet );
     }
-    stime_ticks_t t2 = stime_ticks();
-#endif
     if( ( pnet->flags & PSYNTH_NET_FLAG_NO_SCOPE ) == 0 )
 	psynth_fill_scope_buffers( pnet->buf_size, pnet );
 }
@@ -2659,6 +3432,44 @@ int psynth_resampler_end(
     }
     return retval;
 }
+static psynth_chunk* psynth_get_chunk( uint mod_num, uint num, psynth_net* pnet )
+{
+    if( pnet->mods_num && mod_num < pnet->mods_num )
+    {
+	psynth_module* mod = &pnet->mods[ mod_num ];
+	if( mod->chunks )
+	{
+	    uint count = smem_get_size( mod->chunks ) / sizeof( psynth_chunk* );
+	    if( num < count )
+		return mod->chunks[ num ];
+	}
+    }
+    return NULL;
+}
+static void psynth_free_chunk_data( psynth_chunk* c )
+{
+    psynth_shared_chunk* sc = c->shared;
+    if( sc )
+    {
+	smutex_lock( &g_shared_chunks_mutex );
+	sc->refs--;
+	if( sc->refs == 0 )
+	{
+	    psynth_shared_chunk** prev = &g_shared_chunks[ sc->hash & ( SHARED_CHUNKS_HASH_SIZE - 1 ) ];
+	    while( *prev != sc ) prev = &(*prev)->next;
+	    *prev = sc->next;
+	    smem_free( sc->data );
+	    smem_free( sc );
+	}
+	smutex_unlock( &g_shared_chunks_mutex );
+	c->shared = NULL;
+    }
+    else
+    {
+	smem_free( c->data );
+    }
+    c->data = NULL;
+}
 void psynth_new_chunk( uint mod_num, uint num, size_t size, uint flags, int freq, psynth_net* pnet )
 {
     psynth_chunk c;
@@ -2667,6 +3478,7 @@ void psynth_new_chunk( uint mod_num, uint num, size_t size, uint flags, int freq
     {
 	c.flags = flags;
 	c.freq = freq;
+	c.shared = NULL;
 	psynth_new_chunk( mod_num, num, &c, pnet );
     }
 }
@@ -2704,7 +3516,7 @@ void psynth_replace_chunk_data( uint mod_num, uint num, void* data, psynth_net*
 		psynth_chunk* c = mod->chunks[ num ];
 		if( c )
 		{
-		    smem_free( c->data );
+		    psynth_free_chunk_data( c );
 		    c->data = data;
 		}
 	    }
@@ -2826,6 +3638,7 @@ void* psynth_resize_chunk( uint mod_num, uint num, size_t new_size, psynth_net*
 		psynth_chunk* c = mod->chunks[ num ];
 		if( c )
 		{
+		    if( c->shared && !psynth_unshare_chunk( mod_num, num, pnet ) ) return NULL;
 		    if( c->data )
 			c->data = SMEM_ZRESIZE( c->data, new_size );
 		    retval = c->data;
@@ -2848,7 +3661,7 @@ void psynth_remove_chunk( uint mod_num, uint num, psynth_net* pnet )
 		psynth_chunk* c = mod->chunks[ num ];
 		if( c )
 		{
-		    smem_free( c->data );
+		    psynth_free_chunk_data( c );
 		    smem_free( c );
 		    mod->chunks[ num ] = 0;
 		}
@@ -2868,7 +3681,7 @@ void psynth_remove_chunks( uint mod_num, psynth_net* pnet )
     		psynth_chunk* c = mod->chunks[ cn ];
 		if( c )
 		{
-		    smem_free( c->data );
+		    psynth_free_chunk_data( c );
 		    smem_free( c );
 		}
 	    }
@@ -2877,6 +3690,90 @@ void psynth_remove_chunks( uint mod_num, psynth_net* pnet )
 	}
     }
 }
+static uint64_t psynth_chunk_hash( const void* data, size_t size )
+{
+    const uint8_t* p = (const uint8_t*)data;
+    uint64_t h = 0x9E3779B97F4A7C15ULL ^ size;
+    size_t i = 0;
+    for( ; i + 8 <= size; i += 8 )
+    {
+	uint64_t v;
+	smem_copy( &v, p + i, 8 );
+	h = ( h ^ v ) * 0xFF51AFD7ED558CCDULL;
+	h ^= h >> 32;
+    }
+    for( ; i < size; i++ )
+	h = ( h ^ p[ i ] ) * 0x100000001B3ULL;
+    return h;
+}
+void psynth_share_chunk( uint mod_num, uint num, psynth_net* pnet )
+{
+#ifndef SUNVOX_GUI //the editors write to the chunks directly
+    psynth_chunk* c = psynth_get_chunk( mod_num, num, pnet );
+    if( !c || !c->data || c->shared ) return;
+    size_t size = smem_get_size( c->data );
+    if( size < SHARED_CHUNK_MIN_SIZE ) return;
+    uint64_t hash = psynth_chunk_hash( c->data, size );
+    psynth_shared_chunk** list = &g_shared_chunks[ hash & ( SHARED_CHUNKS_HASH_SIZE - 1 ) ];
+    smutex_lock( &g_shared_chunks_mutex );
+    psynth_shared_chunk* sc = *list;
+    while( sc )
+    {
+	if( sc->hash == hash && smem_get_size( sc->data ) == size && smem_cmp( sc->data, c->data, size ) == 0 )
+	    break;
+	sc = sc->next;
+    }
+    if( sc )
+    {
+	sc->refs++;
+	smem_free( c->data );
+	c->data = sc->data;
+	c->shared = sc;
+    }
+    else
+    {
+	sc = SMEM_ALLOC2( psynth_shared_chunk, 1 );
+	if( sc )
+	{
+	    sc->data = c->data;
+	    sc->hash = hash;
+	    sc->refs = 1;
+	    sc->next = *list;
+	    *list = sc;
+	    c->shared = sc;
+	}
+    }
+    smutex_unlock( &g_shared_chunks_mutex );
+#endif
+}
+void* psynth_unshare_chunk( uint mod_num, uint num, psynth_net* pnet )
+{
+    psynth_chunk* c = psynth_get_chunk( mod_num, num, pnet );
+    if( !c ) return NULL;
+    psynth_shared_chunk* sc = c->shared;
+    if( !sc ) return c->data;
+    void* data = NULL;
+    smutex_lock( &g_shared_chunks_mutex );
+    if( sc->refs == 1 )
+    {
+	//Last user: take the data back from the store
+	psynth_shared_chunk** prev = &g_shared_chunks[ sc->hash & ( SHARED_CHUNKS_HASH_SIZE - 1 ) ];
+	while( *prev != sc ) prev = &(*prev)->next;
+	*prev = sc->next;
+	data = sc->data;
+	smem_free( sc );
+    }
+    else
+    {
+	data = SMEM_CLONE( sc->data );
+	if( data ) sc->refs--;
+    }
+    smutex_unlock( &g_shared_chunks_mutex );
+    if( !data ) return NULL;
+    c->data = data;
+    c->shared = NULL;
+    return data;
+}
 int psynth_get_number_of_outputs( uint mod_num, psynth_net* pnet )
 {
     int retval = 0;
@@ -2925,6 +3822,7 @@ void psynth_set_number_of_inputs( int num, uint mod_num, psynth_net* pnet )
 	psynth_module* ss = &pnet->mods[ mod_num ];
 	if( ss->input_channels != num )
 	{
+	    psynth_unshare_input( pnet->buf_size, ss );
 	    ss->input_channels = num;
 	    if( !( pnet->flags & PSYNTH_NET_FLAG_NO_MODULE_CHANNELS ) )
 		for( int c = num; c < PSYNTH_MAX_CHANNELS; c++ )
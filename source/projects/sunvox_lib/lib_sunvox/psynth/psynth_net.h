@@ -55,17 +55,33 @@ int psynth_check_link( int out, int in, psynth_net* pnet ); //Check connection b
 int psynth_open_midi_out( uint mod_num, char* dev_name, int channel, psynth_net* pnet );
 int psynth_set_midi_prog( uint mod_num, int bank, int prog, psynth_net* pnet );
 void psynth_all_midi_notes_off( uint mod_num, stime_ticks_t t, psynth_net* pnet );
+void psynth_plan_events( psynth_net* pnet ); //Resize the event arena for the current project; don't call it from the audio thread (without the lock)
+bool psynth_plan_events_needed( psynth_net* pnet ); //Lock-free check: true if some events were dropped since the last psynth_plan_events()
 void psynth_reset_events( psynth_net* pnet );
-void psynth_add_event( uint mod_num, psynth_event* evt, psynth_net* pnet ); //Can change events_heap and break your links to the events! (RISK OF EVENT DAMAGE)
+void psynth_add_event( uint mod_num, psynth_event* evt, psynth_net* pnet ); //Never allocates: if the arena is full, the event is dropped and counted in pnet->events_overflow
 void psynth_multisend( psynth_module* mod, psynth_event* evt, psynth_net* pnet );
 void psynth_multisend_pitch( psynth_module* mod, psynth_event* evt, psynth_net* pnet, int pitch );
 PS_STYPE* psynth_get_scope_buffer( int ch, int* offset, int* size, uint mod_num, stime_ticks_t t, psynth_net* pnet );
+//Subscribe to the module output capture: flags = PSYNTH_SCOPE_FLAG_* (0 - unsubscribe); peak_frames - frames per peak entry (0 - default);
+//lock the audio stream before changing the PSYNTH_SCOPE_FLAG_PEAKS subscription;
+//the RAW subscription alone may be enabled without lock (the scope buffers are never freed before the module removal);
+int psynth_set_scope( uint mod_num, uint flags, int peak_frames, psynth_net* pnet );
+//Get the last peak entries (min, max, RMS: 3 floats per entry) of the channel;
+//pos (optional): in - number of the first entry to read; out - number of the next entry; retval = number of entries received;
+uint psynth_get_peaks( uint mod_num, int ch, float* dest, uint count, uint* pos, psynth_net* pnet );
 void psynth_set_ctl2( psynth_module* mod, psynth_event* evt );
 void psynth_render_begin( stime_ticks_t out_time, psynth_net* pnet );
 void psynth_render_end( int frames, psynth_net* pnet );
-void psynth_render_setup( int buf_size, stime_ticks_t out_time, void* in_buf, sound_buffer_type in_buf_type, int in_buf_channels, psynth_net* pnet );
+void psynth_render_setup( int buf_size, stime_ticks_t out_time, void* in_buf, sound_buffer_type in_buf_type, int in_buf_channels, bool in_buf_planar, psynth_net* pnet );
 void psynth_render_all( psynth_net* pnet );
 
+//Module render profiler (call these functions from the non-audio thread):
+int psynth_prof_enable( bool enable, psynth_net* pnet );
+int psynth_prof_read( psynth_prof_record* records, int max_records, psynth_net* pnet ); //get the new records and update the stats; retval: number of records
+int psynth_prof_get_stat( uint mod_num, uint32_t* min, uint32_t* avg, uint32_t* max, uint32_t* p99, psynth_net* pnet ); //ns; p99 is approximate (~10%); retval: number of measurements
+int psynth_prof_save_trace( const char* filename, psynth_net* pnet ); //read all new records and save them in Chrome Trace Event format (JSON)
+void psynth_prof_reset( psynth_net* pnet );
+
 //Event handling:
 PS_RETTYPE psynth_handle_event( uint mod_num, psynth_event* evt, psynth_net* pnet ); //Manual event handling (without psynth_render()); for psynth_sunvox_apply_module(), etc.
 PS_RETTYPE psynth_handle_ctl_event( uint mod_num, int ctl_num, int ctl_val, psynth_net* pnet );
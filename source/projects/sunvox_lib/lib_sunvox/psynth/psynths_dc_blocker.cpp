@@ -167,6 +167,7 @@ PS_RETTYPE MODULE_HANDLER(
 	case PS_CMD_GET_INPUTS_NUM: retval = MODULE_INPUTS; break;
 	case PS_CMD_GET_OUTPUTS_NUM: retval = MODULE_OUTPUTS; break;
 	case PS_CMD_GET_FLAGS: retval = PSYNTH_FLAG_EFFECT; break;
+	case PS_CMD_GET_FLAGS2: retval = PSYNTH_FLAG2_READONLY_INPUT; break;
 	case PS_CMD_INIT:
 	    psynth_resize_ctls_storage( mod_num, 1, pnet );
 	    psynth_register_ctl( mod_num, ps_get_string( STR_PS_CHANNELS ), ps_get_string( STR_PS_STEREO_MONO ), 0, 1, 0, 1, &data->ctl_mono, -1, 0, pnet );
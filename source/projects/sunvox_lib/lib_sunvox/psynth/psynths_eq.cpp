@@ -115,6 +115,7 @@ PS_RETTYPE MODULE_HANDLER(
 	case PS_CMD_GET_INPUTS_NUM: retval = MODULE_INPUTS; break;
 	case PS_CMD_GET_OUTPUTS_NUM: retval = MODULE_OUTPUTS; break;
 	case PS_CMD_GET_FLAGS: retval = PSYNTH_FLAG_EFFECT; break;
+	case PS_CMD_GET_FLAGS2: retval = PSYNTH_FLAG2_READONLY_INPUT; break;
 	case PS_CMD_INIT:
 	    psynth_resize_ctls_storage( mod_num, 4, pnet );
 	    psynth_register_ctl( mod_num, ps_get_string( STR_PS_LOW ), "", 0, 512, 256, 0, &data->ctl_lgain, 256, 0, pnet );
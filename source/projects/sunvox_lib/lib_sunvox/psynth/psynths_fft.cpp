@@ -67,6 +67,7 @@ struct MODULE_DATA
     float*              fft_i; 
     float*              fft_r; 
     float*		fft_win;
+    fft_plan*		fft_p;
     float		fft_phase_rotate[ MODULE_OUTPUTS ]; 
     bool		bufs_clean;
     bool		feedback_bufs_clean;
@@ -140,6 +141,8 @@ static void fft_reinit_bufs( psynth_module* mod, int mod_num )
         data->buf_size = buf_size;
         data->buf_ptr = 0;
         dsp_window_function( data->fft_win, buf_size, dsp_win_fn_hann );
+        fft_plan_remove( data->fft_p );
+        data->fft_p = fft_plan_new( buf_size );
     }
 }
 static void fft_handle_changes( psynth_module* mod, int mod_num )
@@ -383,7 +386,10 @@ PS_RETTYPE MODULE_HANDLER(
                     		data->fft_r[ t ] += PS_NORM_STYPE_MUL( fbuf[ t ], fb, 32768 );
             		}
             		memset( data->fft_i, 0, buf_size * sizeof( float ) );
-                    	fft( 0, data->fft_i, data->fft_r, buf_size );
+                    	if( data->fft_p )
+                    	    fft_plan_run( data->fft_p, 0, data->fft_i, data->fft_r );
+                    	else
+                    	    fft( 0, data->fft_i, data->fft_r, buf_size );
                     	bool mirror = false; 
                     	if( data->ctl_random_freqs )
                     	{
@@ -631,7 +637,10 @@ PS_RETTYPE MODULE_HANDLER(
                     	    for( int t = 0; t < buf_size / 2 - 1; t++ )
         			data->fft_i[ buf_size - 1 - t ] = -data->fft_i[ t + 1 ];
                     	}
-                    	fft( FFT_FLAG_INVERSE, data->fft_i, data->fft_r, buf_size );
+                    	if( data->fft_p )
+                    	    fft_plan_run( data->fft_p, FFT_FLAG_INVERSE, data->fft_i, data->fft_r );
+                    	else
+                    	    fft( FFT_FLAG_INVERSE, data->fft_i, data->fft_r, buf_size );
             		if( data->ctl_feedback )
             		{
             		    float* fbuf = data->feedback_bufs[ ch ];
@@ -735,6 +744,7 @@ PS_RETTYPE MODULE_HANDLER(
     	    smem_free( data->fft_i );
     	    smem_free( data->fft_r );
     	    smem_free( data->fft_win );
+    	    fft_plan_remove( data->fft_p );
 	    retval = 1;
 	    break;
 	default: break;
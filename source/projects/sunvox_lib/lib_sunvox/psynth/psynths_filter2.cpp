@@ -324,7 +324,7 @@ PS_RETTYPE MODULE_HANDLER(
 	case PS_CMD_GET_INPUTS_NUM: retval = MODULE_INPUTS; break;
 	case PS_CMD_GET_OUTPUTS_NUM: retval = MODULE_OUTPUTS; break;
 	case PS_CMD_GET_FLAGS: retval = PSYNTH_FLAG_EFFECT | PSYNTH_FLAG_GET_SPEED_CHANGES; break;
-	case PS_CMD_GET_FLAGS2: retval = PSYNTH_FLAG2_NOTE_RECEIVER; break;
+	case PS_CMD_GET_FLAGS2: retval = PSYNTH_FLAG2_NOTE_RECEIVER | PSYNTH_FLAG2_READONLY_INPUT; break;
 	case PS_CMD_INIT:
 	    psynth_resize_ctls_storage( mod_num, 17, pnet );
 	    psynth_register_ctl( mod_num, ps_get_string( STR_PS_VOLUME ), "", 0, MAX_VOLUME, MAX_VOLUME, 0, &data->ctl_volume, -1, 0, pnet );
@@ -504,13 +504,20 @@ PS_RETTYPE MODULE_HANDLER(
 		    {
 			int vol = data->floating_vol;
 			int mix = data->floating_mix;
+			bool stereo = ( outputs_num == 2 && data->ctl_oversampling == 0 );
+			if( stereo )
+			{
+			    PS_STYPE* in2[ 2 ] = { inputs[ 0 ] + offset + ptr, inputs[ 1 ] + offset + ptr };
+			    PS_STYPE* out2[ 2 ] = { outputs[ 0 ] + offset + ptr, outputs[ 1 ] + offset + ptr };
+			    biquad_filter_run_stereo( f, in2, out2, size );
+			}
     			for( int ch = 0; ch < outputs_num; ch++ )
 			{
 			    PS_STYPE* in = inputs[ ch ] + offset + ptr;
 			    PS_STYPE* out = outputs[ ch ] + offset + ptr;
 			    if( data->ctl_oversampling == 0 )
 			    {
-				biquad_filter_run( f, ch, in, out, size );
+				if( !stereo ) biquad_filter_run( f, ch, in, out, size );
 			    }
 			    else
 			    {
@@ -127,17 +127,31 @@ PS_RETTYPE MODULE_HANDLER(
 			for( int i = 0; i < frames; i++ ) out[ i ] = prev_out[ i ];
 			continue;
 		    }
+		    void* in_base = pnet->in_buf;
+		    int step = pnet->in_buf_channels;
+		    size_t in_ptr = offset * step + ch;
+		    if( pnet->in_buf_planar )
+		    {
+			in_base = ( (void**)pnet->in_buf )[ ch ];
+			step = 1;
+			in_ptr = offset;
+			if( !in_base )
+			{
+			    smem_clear( out, frames * sizeof( PS_STYPE ) );
+			    continue;
+			}
+		    }
 		    switch( pnet->in_buf_type )
 		    {
 		        case sound_buffer_int16:
 		    	    if( vol == 256 )
 			    {
-			        int16_t* in = (int16_t*)pnet->in_buf;
-			        in += offset * pnet->in_buf_channels + ch;
+			        int16_t* in = (int16_t*)in_base;
+			        in += in_ptr;
 			        for( int i = 0; i < frames; i++ )
 			        {
 			    	    int v = *in;
-				    in += pnet->in_buf_channels;
+				    in += step;
 				    PS_STYPE2 res;
 				    PS_INT16_TO_STYPE( res, v );
 				    out[ i ] = res;
@@ -145,13 +159,13 @@ PS_RETTYPE MODULE_HANDLER(
 			    }
 			    else
 			    {
-			        int16_t* in = (int16_t*)pnet->in_buf;
-			        in += offset * pnet->in_buf_channels + ch;
+			        int16_t* in = (int16_t*)in_base;
+			        in += in_ptr;
 			        for( int i = 0; i < frames; i++ )
 			        {
 			    	    int v = *in;
 				    v = ( v * vol ) / 256;
-				    in += pnet->in_buf_channels;
+				    in += step;
 				    PS_STYPE2 res;
 				    PS_INT16_TO_STYPE( res, v );
 				    out[ i ] = res;
@@ -161,12 +175,12 @@ PS_RETTYPE MODULE_HANDLER(
 			case sound_buffer_float32:
 			    if( vol == 256 )
 			    {
-			        float* in = (float*)pnet->in_buf;
-			        in += offset * pnet->in_buf_channels + ch;
+			        float* in = (float*)in_base;
+			        in += in_ptr;
 			        for( int i = 0; i < frames; i++ )
 			        {
 			    	    float fv = *in;
-				    in += pnet->in_buf_channels;
+				    in += step;
 #ifdef PS_STYPE_FLOATINGPOINT
 				    out[ i ] = fv;
 #else
@@ -176,13 +190,30 @@ PS_RETTYPE MODULE_HANDLER(
 			    }
 			    else
 			    {
-			        float* in = (float*)pnet->in_buf;
-			        in += offset * pnet->in_buf_channels + ch;
+			        float* in = (float*)in_base;
+			        in += in_ptr;
 			        for( int i = 0; i < frames; i++ )
 			        {
 			    	    float fv = *in;
 				    fv = ( fv * vol ) / 256;
-				    in += pnet->in_buf_channels;
+				    in += step;
+#ifdef PS_STYPE_FLOATINGPOINT
+				    out[ i ] = fv;
+#else
+				    out[ i ] = (PS_STYPE)( fv * (float)PS_STYPE_ONE );
+#endif
+				}
+			    }
+			    break;
+			case sound_buffer_float64:
+			    {
+			        double* in = (double*)in_base;
+			        in += in_ptr;
+			        for( int i = 0; i < frames; i++ )
+			        {
+			    	    float fv = (float)*in;
+				    if( vol != 256 ) fv = ( fv * vol ) / 256;
+				    in += step;
 #ifdef PS_STYPE_FLOATINGPOINT
 				    out[ i ] = fv;
 #else
@@ -75,6 +75,25 @@ struct MODULE_DATA
     char*		ctl_names[ MAX_USER_CTLS ]; 
     metamodule_options*	opt;
     metamodule_options	default_opt;
+    bool		pipe; 
+    bool		pipe_active;
+    MODULE_DATA*	pipe_next; //next job in the pool queue
+    ssemaphore		pipe_done;
+    std::atomic_int	pipe_waiters;
+    std::atomic_int	pipe_busy; 
+    std::atomic_int	pipe_hold; 
+    int			pipe_len; 
+    PS_STYPE*		pipe_in[ MODULE_INPUTS ];
+    PS_STYPE*		pipe_out[ MODULE_OUTPUTS ]; 
+    uint64_t		pipe_rp;
+    uint64_t		pipe_wp;
+    uint64_t		pipe_signal_end; 
+    int			job_frames;
+    int			job_channels;
+    int			job_input; 
+    int			job_in_empty[ MODULE_INPUTS ];
+    stime_ticks_t	job_out_time;
+    bool		job_rendered;
 #ifdef SUNVOX_GUI
     window_manager*	wm;
 #endif
@@ -82,6 +101,284 @@ struct MODULE_DATA
 static void metamodule_unpack_user_ctls( int mod_num, psynth_net* pnet );
 static void metamodule_get_flags( psynth_module* mod, psynth_net* pnet );
 static void metamodule_handle_ctl_play( MODULE_DATA* data, int prev_ctl_play );
+//Pipelined mode (metamodule_pipeline=1 in the sconfig):
+//the nested engine renders block N in the pool thread while the parent net goes on;
+//block N is played in the next parent block through the output ring (pipe_len frames of latency);
+//the audio thread waits for the job before touching the nested engine (any module command);
+//metamodule_load() sets pipe_hold to render inline while the nested project is being replaced;
+//only the MetaModules of the main net are pipelined: the nested projects sound as usual;
+//all pipelined MetaModules of the net share one pool of worker threads (pnet->metamodule_pool).
+struct metamodule_pipe_pool
+{
+    sthread		th[ PSYNTH_MAX_THREADS ];
+    int			th_num;
+    ssemaphore		sem; //one release per job
+    smutex		queue_lock; //spinlock: the jobs are queued from the audio thread
+    MODULE_DATA*	queue_head;
+    MODULE_DATA*	queue_tail;
+    volatile bool	exit;
+    int			users;
+};
+static void metamodule_pipe_render( MODULE_DATA* data );
+static void* metamodule_pipe_thread( void* user_data )
+{
+    metamodule_pipe_pool* pool = (metamodule_pipe_pool*)user_data;
+    while( 1 )
+    {
+	ssemaphore_wait( &pool->sem, STHREAD_TIMEOUT_INFINITE );
+	if( pool->exit ) break;
+	smutex_lock( &pool->queue_lock );
+	MODULE_DATA* data = pool->queue_head;
+	if( data )
+	{
+	    pool->queue_head = data->pipe_next;
+	    if( !pool->queue_head ) pool->queue_tail = NULL;
+	}
+	smutex_unlock( &pool->queue_lock );
+	if( !data ) continue;
+	metamodule_pipe_render( data );
+	atomic_store( &data->pipe_busy, 0 );
+	int waiters = atomic_load( &data->pipe_waiters );
+	for( int i = 0; i < waiters; i++ ) ssemaphore_release( &data->pipe_done );
+    }
+    return NULL;
+}
+static void metamodule_pipe_push( MODULE_DATA* data, psynth_net* pnet )
+{
+    metamodule_pipe_pool* pool = (metamodule_pipe_pool*)pnet->metamodule_pool;
+    atomic_store( &data->pipe_busy, 1 );
+    data->pipe_next = NULL;
+    smutex_lock( &pool->queue_lock );
+    if( pool->queue_tail )
+	pool->queue_tail->pipe_next = data;
+    else
+	pool->queue_head = data;
+    pool->queue_tail = data;
+    smutex_unlock( &pool->queue_lock );
+    ssemaphore_release( &pool->sem );
+}
+static int metamodule_pipe_pool_add( psynth_net* pnet ) //called with pnet->mods_mutex locked
+{
+    metamodule_pipe_pool* pool = (metamodule_pipe_pool*)pnet->metamodule_pool;
+    if( !pool )
+    {
+	pool = SMEM_ZALLOC2( metamodule_pipe_pool, 1 );
+	if( !pool ) return -1;
+	ssemaphore_create( &pool->sem, NULL, 0, 0 );
+	smutex_init( &pool->queue_lock, SMUTEX_FLAG_ATOMIC_SPINLOCK );
+	pool->th_num = sthread_get_cpu_count();
+	if( pool->th_num > PSYNTH_MAX_THREADS ) pool->th_num = PSYNTH_MAX_THREADS;
+	sundog_engine* sd = nullptr; GET_SD_FROM_PSYNTH_NET( pnet, sd );
+	for( int i = 0; i < pool->th_num; i++ )
+	    sthread_create( &pool->th[ i ], sd, metamodule_pipe_thread, pool, 0 );
+	pnet->metamodule_pool = pool;
+    }
+    pool->users++;
+    return 0;
+}
+static void metamodule_pipe_pool_remove( psynth_net* pnet ) //called with pnet->mods_mutex locked
+{
+    metamodule_pipe_pool* pool = (metamodule_pipe_pool*)pnet->metamodule_pool;
+    if( !pool ) return;
+    pool->users--;
+    if( pool->users > 0 ) return;
+    pool->exit = 1;
+    for( int i = 0; i < pool->th_num; i++ ) ssemaphore_release( &pool->sem );
+    for( int i = 0; i < pool->th_num; i++ ) sthread_destroy( &pool->th[ i ], STHREAD_TIMEOUT_INFINITE );
+    ssemaphore_destroy( &pool->sem );
+    smutex_destroy( &pool->queue_lock );
+    smem_free( pool );
+    pnet->metamodule_pool = NULL;
+}
+static void metamodule_pipe_wait( MODULE_DATA* data )
+{
+    if( atomic_load( &data->pipe_busy ) == 0 ) return;
+    atomic_fetch_add( &data->pipe_waiters, 1 );
+    while( atomic_load( &data->pipe_busy ) ) ssemaphore_wait( &data->pipe_done, STHREAD_TIMEOUT_INFINITE );
+    atomic_fetch_sub( &data->pipe_waiters, 1 );
+}
+static void metamodule_pipe_reset( MODULE_DATA* data )
+{
+    for( int ch = 0; ch < MODULE_OUTPUTS; ch++ )
+	smem_clear( data->pipe_out[ ch ], data->pipe_len * 2 * sizeof( PS_STYPE ) );
+    data->pipe_rp = 0;
+    data->pipe_wp = data->pipe_len;
+    data->pipe_signal_end = 0;
+}
+static void metamodule_pipe_copy( PS_STYPE* dest, int dest_len, uint64_t dest_pos, PS_STYPE* src, int src_len, uint64_t src_pos, int frames )
+{
+    while( frames > 0 )
+    {
+	int d = (int)( dest_pos % dest_len );
+	int s = (int)( src_pos % src_len );
+	int size = frames;
+	if( size > dest_len - d ) size = dest_len - d;
+	if( size > src_len - s ) size = src_len - s;
+	smem_copy( dest + d, src + s, size * sizeof( PS_STYPE ) );
+	dest_pos += size;
+	src_pos += size;
+	frames -= size;
+    }
+}
+static void metamodule_pipe_render( MODULE_DATA* data ) 
+{
+    sunvox_engine* s = data->ps->s[ 0 ];
+    int frames = data->job_frames;
+    PS_STYPE* temp_channels_in[ PSYNTH_MAX_CHANNELS ] = {};
+    int temp_in_empty[ PSYNTH_MAX_CHANNELS ] = {};
+    psynth_module* input_mod = NULL;
+    if( data->job_input >= 0 )
+    {
+	input_mod = &s->net->mods[ data->job_input ];
+	input_mod->realtime_flags |= PSYNTH_RT_FLAG_DONT_CLEAN_INPUT;
+	smem_copy( &temp_channels_in, &input_mod->channels_in, sizeof( temp_channels_in ) );
+	smem_copy( &temp_in_empty, &input_mod->in_empty, sizeof( temp_in_empty ) );
+	for( int i = 0; i < psynth_get_number_of_inputs( input_mod ); i++ )
+	{
+	    int src_ch = i;
+	    if( src_ch >= data->job_channels ) src_ch = data->job_channels - 1;
+	    input_mod->channels_in[ i ] = data->pipe_in[ src_ch ];
+	    input_mod->in_empty[ i ] = data->job_in_empty[ src_ch ];
+	}
+    }
+    sunvox_render_data rdata;
+    SMEM_CLEAR_STRUCT( rdata );
+    rdata.buffer_type = sound_buffer_int16;
+    rdata.buffer = 0;
+    rdata.frames = frames;
+    rdata.channels = data->job_channels;
+    rdata.out_time = data->job_out_time;
+    data->job_rendered = sunvox_render_piece_of_sound( &rdata, s );
+    int len = data->pipe_len * 2;
+    bool empty = true;
+    psynth_module* output_mod = &s->net->mods[ 0 ];
+    if( data->job_rendered )
+    {
+	for( int ch = 0; ch < MODULE_OUTPUTS; ch++ )
+	{
+	    if( output_mod->in_empty[ ch ] < frames ) { empty = false; break; }
+	}
+    }
+    PS_STYPE* ch_data = 0;
+    for( int ch = 0; ch < MODULE_OUTPUTS; ch++ )
+    {
+	if( !empty && ch < output_mod->output_channels ) ch_data = output_mod->channels_in[ ch ];
+	if( !empty && ch_data )
+	    metamodule_pipe_copy( data->pipe_out[ ch ], len, data->pipe_wp, ch_data, frames, 0, frames );
+	else
+	{
+	    int p = (int)( data->pipe_wp % len );
+	    int size = frames;
+	    if( size > len - p ) size = len - p;
+	    smem_clear( data->pipe_out[ ch ] + p, size * sizeof( PS_STYPE ) );
+	    smem_clear( data->pipe_out[ ch ], ( frames - size ) * sizeof( PS_STYPE ) );
+	}
+    }
+    data->pipe_wp += frames;
+    if( !empty ) data->pipe_signal_end = data->pipe_wp;
+    if( input_mod )
+    {
+	smem_copy( &input_mod->channels_in, &temp_channels_in, sizeof( temp_channels_in ) );
+	smem_copy( &input_mod->in_empty, &temp_in_empty, sizeof( temp_in_empty ) );
+	input_mod->realtime_flags &= ~PSYNTH_RT_FLAG_DONT_CLEAN_INPUT;
+    }
+}
+static void metamodule_pipe_stop( MODULE_DATA* data, psynth_net* pnet )
+{
+    if( !data->pipe_active ) return;
+    metamodule_pipe_wait( data );
+    smutex_lock( &pnet->mods_mutex );
+    metamodule_pipe_pool_remove( pnet );
+    smutex_unlock( &pnet->mods_mutex );
+    ssemaphore_destroy( &data->pipe_done );
+    for( int ch = 0; ch < MODULE_INPUTS; ch++ ) { smem_free( data->pipe_in[ ch ] ); data->pipe_in[ ch ] = NULL; }
+    for( int ch = 0; ch < MODULE_OUTPUTS; ch++ ) { smem_free( data->pipe_out[ ch ] ); data->pipe_out[ ch ] = NULL; }
+    data->pipe_active = 0;
+}
+static void metamodule_pipe_start( MODULE_DATA* data, psynth_net* pnet )
+{
+    if( !data->pipe || !data->ps ) return;
+    data->pipe_len = pnet->max_buf_size;
+    bool err = false;
+    for( int ch = 0; ch < MODULE_INPUTS; ch++ )
+    {
+	data->pipe_in[ ch ] = SMEM_ZALLOC2( PS_STYPE, data->pipe_len );
+	if( !data->pipe_in[ ch ] ) err = true;
+    }
+    for( int ch = 0; ch < MODULE_OUTPUTS; ch++ )
+    {
+	data->pipe_out[ ch ] = SMEM_ZALLOC2( PS_STYPE, data->pipe_len * 2 );
+	if( !data->pipe_out[ ch ] ) err = true;
+    }
+    if( !err )
+    {
+	smutex_lock( &pnet->mods_mutex );
+	if( metamodule_pipe_pool_add( pnet ) ) err = true;
+	smutex_unlock( &pnet->mods_mutex );
+    }
+    if( err )
+    {
+	for( int ch = 0; ch < MODULE_INPUTS; ch++ ) { smem_free( data->pipe_in[ ch ] ); data->pipe_in[ ch ] = NULL; }
+	for( int ch = 0; ch < MODULE_OUTPUTS; ch++ ) { smem_free( data->pipe_out[ ch ] ); data->pipe_out[ ch ] = NULL; }
+	return;
+    }
+    metamodule_pipe_reset( data );
+    atomic_init( &data->pipe_busy, 0 );
+    atomic_init( &data->pipe_hold, 0 );
+    atomic_init( &data->pipe_waiters, 0 );
+    data->pipe_next = NULL;
+    ssemaphore_create( &data->pipe_done, NULL, 0, 0 );
+    data->pipe_active = 1;
+}
+int metamodule_get_latency( psynth_net* pnet )
+{
+    //Worst path to the Output: the pipelined MetaModules connected in series add up their latencies
+    if( !pnet || pnet->mods_num == 0 ) return 0;
+    int n = pnet->mods_num;
+    int* lat = SMEM_ALLOC2( int, n ); //path latency of the module output; -1 - unknown; -2 - visiting
+    int* stack = SMEM_ALLOC2( int, n * 2 ); //module + next link
+    if( !lat || !stack ) { smem_free( lat ); smem_free( stack ); return 0; }
+    for( int i = 0; i < n; i++ ) lat[ i ] = -1;
+    stack[ 0 ] = 0;
+    stack[ 1 ] = 0;
+    lat[ 0 ] = -2;
+    int sp = 1;
+    while( sp > 0 )
+    {
+	int* top = &stack[ ( sp - 1 ) * 2 ];
+	psynth_module* mod = &pnet->mods[ top[ 0 ] ];
+	if( top[ 1 ] < mod->input_links_num )
+	{
+	    int l = mod->input_links[ top[ 1 ] ];
+	    top[ 1 ]++;
+	    if( (unsigned)l < (unsigned)n && lat[ l ] == -1 && ( pnet->mods[ l ].flags & PSYNTH_FLAG_EXISTS ) )
+	    {
+		lat[ l ] = -2;
+		stack[ sp * 2 ] = l;
+		stack[ sp * 2 + 1 ] = 0;
+		sp++;
+	    }
+	    continue;
+	}
+	int in = 0;
+	for( int i = 0; i < mod->input_links_num; i++ )
+	{
+	    int l = mod->input_links[ i ];
+	    if( (unsigned)l < (unsigned)n && lat[ l ] > in ) in = lat[ l ]; //feedback loops (-2) add nothing
+	}
+	if( mod->handler == MODULE_HANDLER && mod->data_ptr )
+	{
+	    MODULE_DATA* data = (MODULE_DATA*)mod->data_ptr;
+	    if( data->pipe_active ) in += data->pipe_len;
+	}
+	lat[ top[ 0 ] ] = in;
+	sp--;
+    }
+    int rv = lat[ 0 ];
+    smem_free( lat );
+    smem_free( stack );
+    return rv;
+}
 int metamodule_load( const char* name, sfs_file f, int mod_num, psynth_net* pnet )
 {
     psynth_module* mod;
@@ -98,11 +395,25 @@ int metamodule_load( const char* name, sfs_file f, int mod_num, psynth_net* pnet
     size_t fsize = 0;
     if( name && name[ 0 ] != 0 )
 	fsize = sfs_get_file_size( name );
+    if( data->pipe_active )
+    {
+	atomic_fetch_add( &data->pipe_hold, 1 );
+	smutex_lock( psynth_get_mutex( mod_num, pnet ) );
+	metamodule_pipe_wait( data );
+	smutex_unlock( psynth_get_mutex( mod_num, pnet ) );
+    }
     int rv = -1;
     if( f == 0 )
         rv = sunvox_load_proj( name, SUNVOX_PROJ_LOAD_MAKE_TIMELINE_STATIC, data->ps->s[ 0 ] );
     else
         rv = sunvox_load_proj_from_fd( f, SUNVOX_PROJ_LOAD_MAKE_TIMELINE_STATIC, data->ps->s[ 0 ] );
+    if( data->pipe_active )
+    {
+	smutex_lock( psynth_get_mutex( mod_num, pnet ) );
+	metamodule_pipe_reset( data );
+	atomic_fetch_sub( &data->pipe_hold, 1 );
+	smutex_unlock( psynth_get_mutex( mod_num, pnet ) );
+    }
     if( rv == 0 )
     {
         data->proj_size = fsize;
@@ -319,6 +630,41 @@ static void metamodule_handle_ctl_play( MODULE_DATA* data, int prev_ctl_play )
 	metamodule_handle_ctl_play_simple( data );
     }
 }
+static void metamodule_send_output_events( int mod_num, psynth_module* mod, sunvox_engine* s, int offset, int frames, psynth_net* pnet )
+{
+    MODULE_DATA* data = (MODULE_DATA*)mod->data_ptr;
+    if( data->opt->no_evt_out || ( mod->realtime_flags & PSYNTH_RT_FLAG_MUTE ) ) return;
+    psynth_module* output_mod = &s->net->mods[ 0 ];
+    for( uint i = 0; i < output_mod->events_num; i++ )
+    {
+        psynth_event e = s->net->events_heap[ output_mod->events[ i ] ];
+        PSYNTH_EVT_ID_INC( e.id, mod_num ); 
+        e.id += ( 331 << 16 );
+        if( e.offset >= frames ) e.offset = frames - 1; 
+        e.offset += offset;
+        int pitch = 0;
+        if( e.command == PS_CMD_NOTE_ON || e.command == PS_CMD_SET_FREQ )
+        {
+    	    pitch = e.note.pitch;
+        }
+        for( int i = 0; i < mod->output_links_num; i++ )
+        {
+    	    int l = mod->output_links[ i ];
+    	    if( (unsigned)l < (unsigned)pnet->mods_num )
+    	    {
+    		psynth_module* m = &pnet->mods[ l ];
+    		if( m->flags & PSYNTH_FLAG_EXISTS )
+    		{
+    		    if( e.command == PS_CMD_NOTE_ON || e.command == PS_CMD_SET_FREQ )
+    		    {
+    			e.note.pitch = pitch - m->finetune - m->relative_note * 256;
+    		    }
+    		    psynth_add_event( l, &e, pnet );
+    		}
+    	    }
+        }
+    }
+}
 PS_RETTYPE MODULE_HANDLER( 
     PSYNTH_MODULE_HANDLER_PARAMETERS
     )
@@ -331,6 +677,7 @@ PS_RETTYPE MODULE_HANDLER(
 	data = (MODULE_DATA*)mod->data_ptr;
     }
     PS_RETTYPE retval = 0;
+    if( mod_num >= 0 && data && data->pipe_active ) metamodule_pipe_wait( data );
     switch( event->command )
     {
 	case PS_CMD_GET_DATA_SIZE:
@@ -360,6 +707,7 @@ PS_RETTYPE MODULE_HANDLER(
 	case PS_CMD_GET_INPUTS_NUM: retval = MODULE_INPUTS; break;
 	case PS_CMD_GET_OUTPUTS_NUM: retval = MODULE_OUTPUTS; break;
 	case PS_CMD_GET_FLAGS: retval = PSYNTH_FLAG_EFFECT | PSYNTH_FLAG_USE_MUTEX; break;
+	case PS_CMD_GET_FLAGS2: retval = PSYNTH_FLAG2_PARALLEL_SETUP; break;
 	case PS_CMD_INIT:
 	    psynth_resize_ctls_storage( mod_num, PSYNTH_MAX_CTLS, pnet );
 	    psynth_register_ctl( mod_num, ps_get_string( STR_PS_VOLUME ), "", 0, 1024, 256, 0, &data->ctl_volume, 256, 0, pnet );
@@ -388,6 +736,14 @@ PS_RETTYPE MODULE_HANDLER(
 	    smem_clear( &data->default_opt, sizeof( metamodule_options ) );
 	    data->default_opt.user_ctls_num = 3;
 	    data->opt = &data->default_opt;
+#ifndef SUNVOX_GUI
+	    data->pipe = ( pnet->flags & PSYNTH_NET_FLAG_MAIN ) && sconfig_get_int_value( "metamodule_pipeline", 0, 0 ) != 0; 
+	    {
+		sunvox_engine* sv = (sunvox_engine*)pnet->host;
+		if( sv && ( sv->flags & SUNVOX_FLAG_EXPORT ) ) data->pipe = 0; 
+	    }
+	    metamodule_pipe_start( data, pnet );
+#endif
 #ifdef SUNVOX_GUI
 	    {
 		data->wm = 0;
@@ -557,6 +913,36 @@ PS_RETTYPE MODULE_HANDLER(
             	    if( input_signal == false ) { input_mod = NULL; break; }
             	    break;
             	}
+            	if( data->pipe_active && atomic_load( &data->pipe_hold ) == 0 && frames <= data->pipe_len )
+            	{
+            	    if( data->job_rendered )
+            	    {
+            		metamodule_send_output_events( mod_num, mod, s, offset, frames, pnet );
+            		data->job_rendered = false;
+            	    }
+            	    int len = data->pipe_len * 2;
+		    for( int ch = 0; ch < outputs_num; ch++ )
+			metamodule_pipe_copy( outputs[ ch ] + offset, frames, 0, data->pipe_out[ ch ], len, data->pipe_rp, frames );
+		    if( data->pipe_rp < data->pipe_signal_end ) retval = 1;
+		    data->pipe_rp += frames;
+		    data->job_frames = frames;
+		    data->job_channels = outputs_num;
+		    data->job_out_time = pnet->out_time;
+		    data->job_input = -1;
+		    if( input_mod )
+		    {
+			data->job_input = input_mod - s->net->mods;
+			for( int ch = 0; ch < outputs_num; ch++ )
+			{
+			    smem_copy( data->pipe_in[ ch ], inputs[ ch ] + offset, frames * sizeof( PS_STYPE ) );
+			    int empty = mod->in_empty[ ch ] - offset;
+			    if( empty < 0 ) empty = 0;
+			    data->job_in_empty[ ch ] = empty;
+			}
+		    }
+		    metamodule_pipe_push( data, pnet );
+		    break;
+            	}
             	if( input_mod )
             	{
             	    input_mod->realtime_flags |= PSYNTH_RT_FLAG_DONT_CLEAN_INPUT;
@@ -607,37 +993,7 @@ PS_RETTYPE MODULE_HANDLER(
 			}
 			retval = 1;
 		    }
-		    if( data->opt->no_evt_out == 0 && !( mod->realtime_flags & PSYNTH_RT_FLAG_MUTE ) )
-		    {
-			for( uint i = 0; i < output_mod->events_num; i++ )
-                        {
-                            psynth_event e = s->net->events_heap[ output_mod->events[ i ] ];
-                            PSYNTH_EVT_ID_INC( e.id, mod_num ); 
-                            e.id += ( 331 << 16 );
-                    	    e.offset += offset;
-                    	    int pitch = 0;
-                            if( e.command == PS_CMD_NOTE_ON || e.command == PS_CMD_SET_FREQ )
-                            {
-                        	pitch = e.note.pitch;
-                            }
-                            for( int i = 0; i < mod->output_links_num; i++ )
-                	    {
-                    		int l = mod->output_links[ i ];
-                    		if( (unsigned)l < (unsigned)pnet->mods_num )
-                    		{
-                        	    psynth_module* m = &pnet->mods[ l ];
-                        	    if( m->flags & PSYNTH_FLAG_EXISTS )
-                        	    {
-                            		if( e.command == PS_CMD_NOTE_ON || e.command == PS_CMD_SET_FREQ )
-                            		{
-                            		    e.note.pitch = pitch - m->finetune - m->relative_note * 256;
-                            		}
-                            		psynth_add_event( l, &e, pnet );
-                        	    }
-                    		}
-                	    }
-                        }
-		    }
+		    metamodule_send_output_events( mod_num, mod, s, offset, frames, pnet );
 		}
             	if( input_mod )
             	{
@@ -869,6 +1225,7 @@ PS_RETTYPE MODULE_HANDLER(
                 data->channels[ c ].playing = 0;
             }
             data->active_channels = 0;
+	    if( data->pipe_active ) metamodule_pipe_reset( data );
 	    retval = 1;
 	    break;
         case PS_CMD_SET_SAMPLE_OFFSET:
@@ -978,6 +1335,7 @@ PS_RETTYPE MODULE_HANDLER(
         	mod->visual = 0;
     	    }
 #endif
+	    metamodule_pipe_stop( data, pnet );
 	    psynth_sunvox_remove( data->ps );
 	    data->ps = NULL;
 	    for( uint i = 0; i < MAX_USER_CTLS; i++ )
@@ -1,3 +1,4 @@
 #pragma once
 
 int metamodule_load( const char* name, sfs_file f, int mod_num, psynth_net* pnet );
+int metamodule_get_latency( psynth_net* pnet ); //additional output latency (in frames) of the pipelined MetaModules (metamodule_pipeline=1 in the sconfig): worst path to the Output
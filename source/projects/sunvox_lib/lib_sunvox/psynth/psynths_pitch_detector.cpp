@@ -75,6 +75,7 @@ struct MODULE_DATA
     float*		fft_r2;
     float*		fft_win;
     int			fft_win_type; 
+    fft_plan*		fft_p;
     estimate		hist[ HIST_SIZE ]; 
     int			hist_ptr;
     PS_STYPE2		lp_state[ FILTER_STATE_VARS * FILTERS ]; 
@@ -333,6 +334,11 @@ static void pitch_detector_reinit_buffers( psynth_module* mod, int mod_num )
     if( data->buf_size != buf_size || data->fft_win_type != fft_win_type )
     {
 	data->buf_ptr = 0;
+	if( data->buf_size != buf_size )
+	{
+	    fft_plan_remove( data->fft_p );
+	    data->fft_p = fft_plan_new( buf_size );
+	}
 	data->buf_size = buf_size;
 	data->fft_win_type = fft_win_type;
 	if( fft_win_type == 1 )
@@ -351,6 +357,13 @@ static void pitch_detector_reinit_buffers( psynth_module* mod, int mod_num )
 	}
     }
 }
+static void pd_fft( MODULE_DATA* data, uint32_t flags, float* fi, float* fr )
+{
+    if( data->fft_p )
+	fft_plan_run( data->fft_p, flags, fi, fr );
+    else
+	fft( flags, fi, fr, data->buf_size );
+}
 static float parabolic_interpolation( float v0, float v1, float v2, int t )
 {
     float correction = ( v2 - v0 ) / ( 2 * ( 2 * v1 - v2 - v0 ) );
@@ -725,18 +738,18 @@ PS_RETTYPE MODULE_HANDLER(
         				    + data->buf[ t + data->buf_size / 2 ] * data->buf[ t + data->buf_size / 2 ];
         			    memset( data->fft_i1, 0, data->buf_size * sizeof( float ) );
         			    for( int t = 0; t < data->buf_size; t++ ) data->fft_r1[ t ] = data->buf[ t ];
-        			    fft( 0, data->fft_i1, data->fft_r1, data->buf_size );
+        			    pd_fft( data, 0, data->fft_i1, data->fft_r1 );
         			    memset( data->fft_i2, 0, data->buf_size * sizeof( float ) );
         			    for( int t = 0; t <= data->buf_size / 2; t++ ) data->fft_r2[ t ] = 0;
         			    data->fft_r2[ 0 ] = data->buf[ 0 ]; for( int t = 1; t < data->buf_size / 2; t++ ) data->fft_r2[ data->buf_size - t ] = data->buf[ t ];
-        			    fft( 0, data->fft_i2, data->fft_r2, data->buf_size );
+        			    pd_fft( data, 0, data->fft_i2, data->fft_r2 );
         			    for( int t = 0; t < data->buf_size; t++ )
         			    {
         				float r1 = data->fft_r1[ t ];
     					data->fft_r1[ t ] = data->fft_r1[ t ] * data->fft_r2[ t ] - data->fft_i1[ t ] * data->fft_i2[ t ];
     					data->fft_i1[ t ] = data->fft_i1[ t ] * data->fft_r2[ t ] + r1                * data->fft_i2[ t ];
         			    }
-        			    fft( FFT_FLAG_INVERSE, data->fft_i1, data->fft_r1, data->buf_size );
+        			    pd_fft( data, FFT_FLAG_INVERSE, data->fft_i1, data->fft_r1 );
         			    for( int t = 0; t < data->buf_size / 2; t++ ) 
         				data->fft_r1[ t ] = data->energy_terms[ 0 ] + data->energy_terms[ t ] - 2 * data->fft_r1[ t ];
         			    float sum = 0;
@@ -760,7 +773,7 @@ PS_RETTYPE MODULE_HANDLER(
         			{
         			    for( int t = 0; t < data->buf_size; t++ ) data->fft_r1[ t ] = data->buf[ t ] * data->fft_win[ t ];
         			    memset( data->fft_i1, 0, data->buf_size * sizeof( float ) );
-        			    fft( 0, data->fft_i1, data->fft_r1, data->buf_size );
+        			    pd_fft( data, 0, data->fft_i1, data->fft_r1 );
         			    for( int t = 0; t <= data->buf_size / 2; t++ )
         			    {
         				float rv = data->fft_r1[ t ];
@@ -770,7 +783,7 @@ PS_RETTYPE MODULE_HANDLER(
         			    for( int t = 0; t < data->buf_size / 2 - 1; t++ )
                             		data->fft_r1[ data->buf_size - 1 - t ] = data->fft_r1[ t + 1 ]; 
         			    memset( data->fft_i1, 0, data->buf_size * sizeof( float ) );
-        			    fft( 1, data->fft_i1, data->fft_r1, data->buf_size );
+        			    pd_fft( data, FFT_FLAG_INVERSE, data->fft_i1, data->fft_r1 );
         			    float max = -10000000;
         			    for( int t = min_T; t < data->buf_size / 2; t++ )
         			    {
@@ -782,7 +795,7 @@ PS_RETTYPE MODULE_HANDLER(
         			{
         			    for( int t = 0; t < data->buf_size; t++ ) data->fft_r1[ t ] = data->buf[ t ] * data->fft_win[ t ];
         			    memset( data->fft_i1, 0, data->buf_size * sizeof( float ) );
-        			    fft( 0, data->fft_i1, data->fft_r1, data->buf_size );
+        			    pd_fft( data, 0, data->fft_i1, data->fft_r1 );
         			    for( int b = 0; b <= data->buf_size / 2; b++ )
         			    {
         				float rv = data->fft_r1[ b ];
@@ -984,6 +997,7 @@ PS_RETTYPE MODULE_HANDLER(
 	    smem_free( data->fft_r1 );
 	    smem_free( data->fft_r2 );
 	    smem_free( data->fft_win );
+	    fft_plan_remove( data->fft_p );
 	    psynth_resampler_remove( data->resamp );
 #ifdef SUNVOX_GUI
 	    if( mod->visual && data->wm )
@@ -28,6 +28,40 @@ IN THE SOFTWARE.
 
 #include "psynth.h"
 #include "psynths_dc_blocker.h"
+#ifdef PS_STYPE_FLOATINGPOINT
+    #if defined(__SSE2__)
+	#include <emmintrin.h>
+	#define COMBS_SIMD
+	typedef __m128 combs_v4;
+	#define CB_V4_SET( V0, V1, V2, V3 ) _mm_set_ps( V3, V2, V1, V0 )
+	#define CB_V4_SET1( V ) _mm_set1_ps( V )
+	#define CB_V4_LOAD( P ) _mm_loadu_ps( P )
+	#define CB_V4_STORE( P, V ) _mm_storeu_ps( P, V )
+	#define CB_V4_ADD( A, B ) _mm_add_ps( A, B )
+	#define CB_V4_MUL( A, B ) _mm_mul_ps( A, B )
+	#define CB_V4_TRANSPOSE( V0, V1, V2, V3 ) _MM_TRANSPOSE4_PS( V0, V1, V2, V3 )
+    #elif ( defined(__ARM_NEON) || defined(__ARM_NEON__) ) && defined(__aarch64__)
+	#include <arm_neon.h>
+	#define COMBS_SIMD
+	typedef float32x4_t combs_v4;
+	static inline float32x4_t cb_v4_set( float v0, float v1, float v2, float v3 ) { float v[ 4 ] = { v0, v1, v2, v3 }; return vld1q_f32( v ); }
+	#define CB_V4_SET( V0, V1, V2, V3 ) cb_v4_set( V0, V1, V2, V3 )
+	#define CB_V4_SET1( V ) vdupq_n_f32( V )
+	#define CB_V4_LOAD( P ) vld1q_f32( P )
+	#define CB_V4_STORE( P, V ) vst1q_f32( P, V )
+	#define CB_V4_ADD( A, B ) vaddq_f32( A, B )
+	#define CB_V4_MUL( A, B ) vmulq_f32( A, B )
+	#define CB_V4_TRANSPOSE( V0, V1, V2, V3 ) \
+	{ \
+	    float32x4x2_t t01_ = vtrnq_f32( V0, V1 ); \
+	    float32x4x2_t t23_ = vtrnq_f32( V2, V3 ); \
+	    V0 = vcombine_f32( vget_low_f32( t01_.val[ 0 ] ), vget_low_f32( t23_.val[ 0 ] ) ); \
+	    V1 = vcombine_f32( vget_low_f32( t01_.val[ 1 ] ), vget_low_f32( t23_.val[ 1 ] ) ); \
+	    V2 = vcombine_f32( vget_high_f32( t01_.val[ 0 ] ), vget_high_f32( t23_.val[ 0 ] ) ); \
+	    V3 = vcombine_f32( vget_high_f32( t01_.val[ 1 ] ), vget_high_f32( t23_.val[ 1 ] ) ); \
+	}
+    #endif
+#endif
 #define MODULE_DATA	psynth_reverb_data
 #define MODULE_HANDLER	psynth_reverb
 #define MODULE_INPUTS	2
@@ -257,6 +291,119 @@ static void clean_filters( MODULE_DATA* data )
     }
     data->filters_clean = true;
 }
+#define COMBS_BLOCK		64
+static void run_combs_scalar( comb_filter** combs, int combs_num, int combs_l, PS_STYPE2* input, PS_STYPE2* outL, PS_STYPE2* outR, int frames )
+{
+    for( int i = 0; i < frames; i++ )
+    {
+	PS_STYPE2 sumL = 0;
+	PS_STYPE2 sumR = 0;
+	PS_STYPE2 in = input[ i ];
+	for( int a = 0; a < combs_num; a++ )
+	{
+	    comb_filter* f = combs[ a ];
+	    PS_STYPE2 f_out = f->buf[ f->buf_ptr ];
+#ifdef PS_STYPE_FLOATINGPOINT
+	    f->filterstore = ( f_out * f->damp1 ) + ( f->filterstore * f->damp2 );
+	    f->buf[ f->buf_ptr ] = in + ( f->filterstore * f->feedback );
+#else
+	    PS_STYPE2 f_v;
+	    f->filterstore = ( f_out * f->damp1 + f->filterstore * f->damp2 ) / 256;
+	    f_v = in + ( f->filterstore * f->feedback ) / 256;
+	    f->buf[ f->buf_ptr ] = f_v;
+#endif
+	    if( a < combs_l ) sumL += f_out; else sumR += f_out;
+	    f->buf_ptr++;
+	    if( f->buf_ptr >= f->buf_size ) f->buf_ptr = 0;
+	}
+	outL[ i ] = sumL;
+	outR[ i ] = sumR;
+    }
+}
+//combs_num: 4, 8 or 16; combs[ 0 ... combs_l - 1 ] -> outL; other combs -> outR;
+//same operation order as run_combs_scalar(), but the result is not guaranteed to be bit-identical: with -ffast-math the compiler
+//may reorder the scalar code differently (about -135 dB difference); check with sunvox_bench -e Reverb -c DIR;
+static void run_combs( comb_filter** combs, int combs_num, int combs_l, PS_STYPE2* input, PS_STYPE2* outL, PS_STYPE2* outR, int frames )
+{
+#ifdef COMBS_SIMD
+    //4 combs in 4 lanes; each block is a contiguous part of all ring buffers, so the lanes are transposed in registers (no gathers):
+    int i = 0;
+    while( i < frames )
+    {
+	int size = frames - i;
+	for( int a = 0; a < combs_num; a++ )
+	{
+	    int rem = combs[ a ]->buf_size - combs[ a ]->buf_ptr;
+	    if( rem < 1 ) rem = 1;
+	    if( rem < size ) size = rem;
+	}
+	size &= ~3;
+	if( size == 0 )
+	{
+	    //End of some ring buffer:
+	    run_combs_scalar( combs, combs_num, combs_l, input + i, outL + i, outR + i, 1 );
+	    i++;
+	    continue;
+	}
+	smem_clear( outL + i, size * sizeof( PS_STYPE2 ) );
+	smem_clear( outR + i, size * sizeof( PS_STYPE2 ) );
+	for( int g = 0; g < combs_num; g += 4 )
+	{
+	    comb_filter** c = combs + g;
+	    PS_STYPE2* b0 = c[ 0 ]->buf + c[ 0 ]->buf_ptr;
+	    PS_STYPE2* b1 = c[ 1 ]->buf + c[ 1 ]->buf_ptr;
+	    PS_STYPE2* b2 = c[ 2 ]->buf + c[ 2 ]->buf_ptr;
+	    PS_STYPE2* b3 = c[ 3 ]->buf + c[ 3 ]->buf_ptr;
+	    PS_STYPE2* RESTRICT in = input + i;
+	    PS_STYPE2* RESTRICT sum;
+	    if( g < combs_l ) sum = outL + i; else sum = outR + i;
+	    combs_v4 damp1 = CB_V4_SET( c[ 0 ]->damp1, c[ 1 ]->damp1, c[ 2 ]->damp1, c[ 3 ]->damp1 );
+	    combs_v4 damp2 = CB_V4_SET( c[ 0 ]->damp2, c[ 1 ]->damp2, c[ 2 ]->damp2, c[ 3 ]->damp2 );
+	    combs_v4 feedback = CB_V4_SET( c[ 0 ]->feedback, c[ 1 ]->feedback, c[ 2 ]->feedback, c[ 3 ]->feedback );
+	    combs_v4 fs = CB_V4_SET( c[ 0 ]->filterstore, c[ 1 ]->filterstore, c[ 2 ]->filterstore, c[ 3 ]->filterstore );
+	    for( int t = 0; t < size; t += 4 )
+	    {
+		combs_v4 v0 = CB_V4_LOAD( b0 + t );
+		combs_v4 v1 = CB_V4_LOAD( b1 + t );
+		combs_v4 v2 = CB_V4_LOAD( b2 + t );
+		combs_v4 v3 = CB_V4_LOAD( b3 + t );
+		combs_v4 acc = CB_V4_LOAD( sum + t );
+		acc = CB_V4_ADD( acc, v0 );
+		acc = CB_V4_ADD( acc, v1 );
+		acc = CB_V4_ADD( acc, v2 );
+		acc = CB_V4_ADD( acc, v3 );
+		CB_V4_STORE( sum + t, acc );
+		CB_V4_TRANSPOSE( v0, v1, v2, v3 ); //v0 = frame t of all 4 combs ...
+		fs = CB_V4_ADD( CB_V4_MUL( v0, damp1 ), CB_V4_MUL( fs, damp2 ) );
+		v0 = CB_V4_ADD( CB_V4_SET1( in[ t ] ), CB_V4_MUL( fs, feedback ) );
+		fs = CB_V4_ADD( CB_V4_MUL( v1, damp1 ), CB_V4_MUL( fs, damp2 ) );
+		v1 = CB_V4_ADD( CB_V4_SET1( in[ t + 1 ] ), CB_V4_MUL( fs, feedback ) );
+		fs = CB_V4_ADD( CB_V4_MUL( v2, damp1 ), CB_V4_MUL( fs, damp2 ) );
+		v2 = CB_V4_ADD( CB_V4_SET1( in[ t + 2 ] ), CB_V4_MUL( fs, feedback ) );
+		fs = CB_V4_ADD( CB_V4_MUL( v3, damp1 ), CB_V4_MUL( fs, damp2 ) );
+		v3 = CB_V4_ADD( CB_V4_SET1( in[ t + 3 ] ), CB_V4_MUL( fs, feedback ) );
+		CB_V4_TRANSPOSE( v0, v1, v2, v3 ); //v0 = 4 frames of comb 0 ...
+		CB_V4_STORE( b0 + t, v0 );
+		CB_V4_STORE( b1 + t, v1 );
+		CB_V4_STORE( b2 + t, v2 );
+		CB_V4_STORE( b3 + t, v3 );
+	    }
+	    PS_STYPE2 fs_v[ 4 ];
+	    CB_V4_STORE( fs_v, fs );
+	    for( int a = 0; a < 4; a++ )
+	    {
+		comb_filter* f = c[ a ];
+		f->filterstore = fs_v[ a ];
+		f->buf_ptr += size;
+		if( f->buf_ptr >= f->buf_size ) f->buf_ptr = 0;
+	    }
+	}
+	i += size;
+    }
+#else
+    run_combs_scalar( combs, combs_num, combs_l, input, outL, outR, frames );
+#endif
+}
 PS_RETTYPE MODULE_HANDLER( 
     PSYNTH_MODULE_HANDLER_PARAMETERS
     )
@@ -298,6 +445,7 @@ PS_RETTYPE MODULE_HANDLER(
 	case PS_CMD_GET_INPUTS_NUM: retval = MODULE_INPUTS; break;
 	case PS_CMD_GET_OUTPUTS_NUM: retval = MODULE_OUTPUTS; break;
 	case PS_CMD_GET_FLAGS: retval = PSYNTH_FLAG_EFFECT; break;
+	case PS_CMD_GET_FLAGS2: retval = PSYNTH_FLAG2_READONLY_INPUT; break;
 	case PS_CMD_INIT:
 	    {
 		psynth_resize_ctls_storage( mod_num, 10, pnet );
@@ -464,138 +612,94 @@ PS_RETTYPE MODULE_HANDLER(
 		    }
 		}
 		data->filters_clean = false;
-		switch( data->ctl_allpass )
+		comb_filter* combs[ MAX_COMBS * 2 ];
+		int combs_num = 0;
+		int combs_l = 0;
+		for( int a = 0; a < MAX_COMBS * outputs_num; a += filters_add )
 		{
-		    default:
+		    if( a < MAX_COMBS ) combs_l++;
+		    combs[ combs_num++ ] = &data->combs[ a ];
+		}
+		for( int i = 0; i < frames; i += COMBS_BLOCK )
+		{
+		    PS_STYPE2 input[ COMBS_BLOCK ];
+		    PS_STYPE2 bufL[ COMBS_BLOCK ];
+		    PS_STYPE2 bufR[ COMBS_BLOCK ];
+		    int size = frames - i;
+		    if( size > COMBS_BLOCK ) size = COMBS_BLOCK;
+		    for( int t = 0; t < size; t++ )
 		    {
-			for( int i = 0; i < frames; i++ )
-			{
-			    PS_STYPE2 outL = 0;
-			    PS_STYPE2 outR = 0;
-			    PS_STYPE2 input = outL_ch[ i ];
-			    if( inR_ch ) input = ( input + outR_ch[ i ] ) / (PS_STYPE2)2;
-			    input *= INPUT_MUL; 
-			    for( int a = 0; a < MAX_COMBS * outputs_num; a += filters_add )
-			    {
-				comb_filter* f = &data->combs[ a ];
-				PS_STYPE2 f_out = f->buf[ f->buf_ptr ];
-#ifdef PS_STYPE_FLOATINGPOINT
-				f->filterstore = ( f_out * f->damp1 ) + ( f->filterstore * f->damp2 );
-				f->buf[ f->buf_ptr ] = input + ( f->filterstore * f->feedback );
-#else
-				PS_STYPE2 f_v;
-				f->filterstore = ( f_out * f->damp1 + f->filterstore * f->damp2 ) / 256;
-				f_v = input + ( f->filterstore * f->feedback ) / 256;
-				f->buf[ f->buf_ptr ] = f_v;
-#endif
-				if( a < MAX_COMBS ) outL += f_out; else outR += f_out;
-				f->buf_ptr++;
-				if( f->buf_ptr >= f->buf_size ) f->buf_ptr = 0;
-			    }
-			    outL_ch[ i ] = PS_NORM_STYPE_MUL( outL / (PS_STYPE2)(16*INPUT_MUL), ctl_wet, 256 );
-			    if( inR_ch ) outR_ch[ i ] = PS_NORM_STYPE_MUL( outR / (PS_STYPE2)(16*INPUT_MUL), ctl_wet, 256 );
-			}
+			PS_STYPE2 v = outL_ch[ i + t ];
+			if( inR_ch ) v = ( v + outR_ch[ i + t ] ) / (PS_STYPE2)2;
+			v *= INPUT_MUL;
+			input[ t ] = v;
 		    }
-		    break;
-		    case 1:
+		    run_combs( combs, combs_num, combs_l, input, bufL, bufR, size );
+		    switch( data->ctl_allpass )
 		    {
-			for( int i = 0; i < frames; i++ )
-			{
-			    PS_STYPE2 outL = 0;
-			    PS_STYPE2 outR = 0;
-			    PS_STYPE2 input = outL_ch[ i ];
-			    if( inR_ch ) input = ( input + outR_ch[ i ] ) / (PS_STYPE2)2;
-			    input *= INPUT_MUL; 
-			    for( int a = 0; a < MAX_COMBS * outputs_num; a += filters_add )
+			default:
+			    break;
+			case 1:
+			    for( int t = 0; t < size; t++ )
 			    {
-				comb_filter* f = &data->combs[ a ];
-				PS_STYPE2 f_out = f->buf[ f->buf_ptr ];
+				PS_STYPE2 outL = bufL[ t ];
+				PS_STYPE2 outR = bufR[ t ];
+				for( int a = 0; a < MAX_ALLPASSES * outputs_num; a += filters_add )
+				{
+				    allpass_filter* f = &data->allpasses[ a ];
+				    PS_STYPE2 f_bufout = f->buf[ f->buf_ptr ];
+				    PS_STYPE2 f_out;
+				    PS_STYPE2 f_in;
+				    if( a < MAX_ALLPASSES ) f_in = outL; else f_in = outR;
+				    f_out = -f_in + f_bufout;
 #ifdef PS_STYPE_FLOATINGPOINT
-				f->filterstore = ( f_out * f->damp1 ) + ( f->filterstore * f->damp2 );
-				f->buf[ f->buf_ptr ] = input + ( f->filterstore * f->feedback );
+				    f->buf[ f->buf_ptr ] = f_in + ( f_bufout * ALLPASS_FEEDBACK );
 #else
-				PS_STYPE2 f_v;
-				f->filterstore = ( f_out * f->damp1 + f->filterstore * f->damp2 ) / 256;
-				f_v = input + ( f->filterstore * f->feedback ) / 256;
-				f->buf[ f->buf_ptr ] = f_v;
+				    f->buf[ f->buf_ptr ] = f_in + ( f_bufout * ALLPASS_FEEDBACK ) / 256;
 #endif
-				if( a < MAX_COMBS ) outL += f_out; else outR += f_out;
-				f->buf_ptr++;
-				if( f->buf_ptr >= f->buf_size ) f->buf_ptr = 0;
+				    if( a < MAX_ALLPASSES ) outL = f_out; else outR = f_out;
+				    f->buf_ptr++;
+				    if( f->buf_ptr >= f->buf_size ) f->buf_ptr = 0;
+				}
+				bufL[ t ] = outL;
+				bufR[ t ] = outR;
 			    }
-			    for( int a = 0; a < MAX_ALLPASSES * outputs_num; a += filters_add )
+			    break;
+			case 2:
+			    for( int t = 0; t < size; t++ )
 			    {
-				allpass_filter* f = &data->allpasses[ a ];
-				PS_STYPE2 f_bufout = f->buf[ f->buf_ptr ];
-				PS_STYPE2 f_out;
-				PS_STYPE2 f_in;
-				if( a < MAX_ALLPASSES ) f_in = outL; else f_in = outR;
-				f_out = -f_in + f_bufout;
+				PS_STYPE2 outL = bufL[ t ];
+				PS_STYPE2 outR = bufR[ t ];
+				for( int a = 0; a < MAX_ALLPASSES * outputs_num; a += filters_add )
+				{
+				    allpass_filter* f = &data->allpasses[ a ];
+				    PS_STYPE2 f_bufout = f->buf[ f->buf_ptr ];
+				    PS_STYPE2 f_out;
+				    PS_STYPE2 f_in;
+				    if( a < MAX_ALLPASSES ) f_in = outL; else f_in = outR;
 #ifdef PS_STYPE_FLOATINGPOINT
-				f->buf[ f->buf_ptr ] = f_in + ( f_bufout * ALLPASS_FEEDBACK );
+				    PS_STYPE2 buf_write = f_in + ( f_bufout * ALLPASS_FEEDBACK );
+				    f->buf[ f->buf_ptr ] = buf_write;
+				    f_out = -buf_write * ALLPASS_FEEDBACK + f_bufout;
 #else
-				f->buf[ f->buf_ptr ] = f_in + ( f_bufout * ALLPASS_FEEDBACK ) / 256;
+				    PS_STYPE2 buf_write = f_in + ( f_bufout * ALLPASS_FEEDBACK ) / 256;
+				    f->buf[ f->buf_ptr ] = buf_write;
+				    f_out = ( -buf_write * ALLPASS_FEEDBACK ) / 256 + f_bufout;
 #endif
-				if( a < MAX_ALLPASSES ) outL = f_out; else outR = f_out;
-				f->buf_ptr++;
-				if( f->buf_ptr >= f->buf_size ) f->buf_ptr = 0;
+				    if( a < MAX_ALLPASSES ) outL = f_out; else outR = f_out;
+				    f->buf_ptr++;
+				    if( f->buf_ptr >= f->buf_size ) f->buf_ptr = 0;
+				}
+				bufL[ t ] = outL;
+				bufR[ t ] = outR;
 			    }
-			    outL_ch[ i ] = PS_NORM_STYPE_MUL( outL / (PS_STYPE2)(16*INPUT_MUL), ctl_wet, 256 );
-			    if( inR_ch ) outR_ch[ i ] = PS_NORM_STYPE_MUL( outR / (PS_STYPE2)(16*INPUT_MUL), ctl_wet, 256 );
-			}
+			    break;
 		    }
-		    break;
-		    case 2:
+		    for( int t = 0; t < size; t++ )
 		    {
-			for( int i = 0; i < frames; i++ )
-			{
-			    PS_STYPE2 outL = 0;
-			    PS_STYPE2 outR = 0;
-			    PS_STYPE2 input = outL_ch[ i ];
-			    if( inR_ch ) input = ( input + outR_ch[ i ] ) / (PS_STYPE2)2;
-			    input *= INPUT_MUL; 
-			    for( int a = 0; a < MAX_COMBS * outputs_num; a += filters_add )
-			    {
-				comb_filter* f = &data->combs[ a ];
-				PS_STYPE2 f_out = f->buf[ f->buf_ptr ];
-#ifdef PS_STYPE_FLOATINGPOINT
-				f->filterstore = ( f_out * f->damp1 ) + ( f->filterstore * f->damp2 );
-				f->buf[ f->buf_ptr ] = input + ( f->filterstore * f->feedback );
-#else
-				PS_STYPE2 f_v;
-				f->filterstore = ( f_out * f->damp1 + f->filterstore * f->damp2 ) / 256;
-				f_v = input + ( f->filterstore * f->feedback ) / 256;
-				f->buf[ f->buf_ptr ] = f_v;
-#endif
-				if( a < MAX_COMBS ) outL += f_out; else outR += f_out;
-				f->buf_ptr++;
-				if( f->buf_ptr >= f->buf_size ) f->buf_ptr = 0;
-			    }
-			    for( int a = 0; a < MAX_ALLPASSES * outputs_num; a += filters_add )
-			    {
-				allpass_filter* f = &data->allpasses[ a ];
-				PS_STYPE2 f_bufout = f->buf[ f->buf_ptr ];
-				PS_STYPE2 f_out;
-				PS_STYPE2 f_in;
-				if( a < MAX_ALLPASSES ) f_in = outL; else f_in = outR;
-#ifdef PS_STYPE_FLOATINGPOINT
-				PS_STYPE2 buf_write = f_in + ( f_bufout * ALLPASS_FEEDBACK );
-				f->buf[ f->buf_ptr ] = buf_write;
-				f_out = -buf_write * ALLPASS_FEEDBACK + f_bufout;
-#else
-				PS_STYPE2 buf_write = f_in + ( f_bufout * ALLPASS_FEEDBACK ) / 256;
-				f->buf[ f->buf_ptr ] = buf_write;
-				f_out = ( -buf_write * ALLPASS_FEEDBACK ) / 256 + f_bufout;
-#endif
-				if( a < MAX_ALLPASSES ) outL = f_out; else outR = f_out;
-				f->buf_ptr++;
-				if( f->buf_ptr >= f->buf_size ) f->buf_ptr = 0;
-			    }
-			    outL_ch[ i ] = PS_NORM_STYPE_MUL( outL / (PS_STYPE2)(16*INPUT_MUL), ctl_wet, 256 );
-			    if( inR_ch ) outR_ch[ i ] = PS_NORM_STYPE_MUL( outR / (PS_STYPE2)(16*INPUT_MUL), ctl_wet, 256 );
-			}
+			outL_ch[ i + t ] = PS_NORM_STYPE_MUL( bufL[ t ] / (PS_STYPE2)(16*INPUT_MUL), ctl_wet, 256 );
+			if( inR_ch ) outR_ch[ i + t ] = PS_NORM_STYPE_MUL( bufR[ t ] / (PS_STYPE2)(16*INPUT_MUL), ctl_wet, 256 );
 		    }
-		    break;
 		}
 		if( data->ctl_dry > 0 )
 		{
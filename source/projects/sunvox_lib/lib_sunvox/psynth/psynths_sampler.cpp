@@ -29,6 +29,35 @@ IN THE SOFTWARE.
 #include "psynth_net.h"
 #include "psynths_sampler.h"
 #include "sunvox_engine.h"
+#ifdef PS_STYPE_FLOATINGPOINT
+    #if defined(__SSE2__)
+	#include <emmintrin.h>
+	#define SAMPLER_SIMD
+	typedef __m128 sampler_v4;
+	#define SMP_V4_SET( V0, V1, V2, V3 ) _mm_set_ps( V3, V2, V1, V0 )
+	#define SMP_V4_SETI( V0, V1, V2, V3 ) _mm_cvtepi32_ps( _mm_set_epi32( V3, V2, V1, V0 ) )
+	#define SMP_V4_SET1( V ) _mm_set1_ps( V )
+	#define SMP_V4_LOAD( P ) _mm_loadu_ps( P )
+	#define SMP_V4_STORE( P, V ) _mm_storeu_ps( P, V )
+	#define SMP_V4_ADD( A, B ) _mm_add_ps( A, B )
+	#define SMP_V4_SUB( A, B ) _mm_sub_ps( A, B )
+	#define SMP_V4_MUL( A, B ) _mm_mul_ps( A, B )
+    #elif ( defined(__ARM_NEON) || defined(__ARM_NEON__) ) && defined(__aarch64__)
+	#include <arm_neon.h>
+	#define SAMPLER_SIMD
+	typedef float32x4_t sampler_v4;
+	static inline float32x4_t smp_v4_set( float v0, float v1, float v2, float v3 ) { float v[ 4 ] = { v0, v1, v2, v3 }; return vld1q_f32( v ); }
+	static inline float32x4_t smp_v4_seti( int v0, int v1, int v2, int v3 ) { int32_t v[ 4 ] = { v0, v1, v2, v3 }; return vcvtq_f32_s32( vld1q_s32( v ) ); }
+	#define SMP_V4_SET( V0, V1, V2, V3 ) smp_v4_set( V0, V1, V2, V3 )
+	#define SMP_V4_SETI( V0, V1, V2, V3 ) smp_v4_seti( V0, V1, V2, V3 )
+	#define SMP_V4_SET1( V ) vdupq_n_f32( V )
+	#define SMP_V4_LOAD( P ) vld1q_f32( P )
+	#define SMP_V4_STORE( P, V ) vst1q_f32( P, V )
+	#define SMP_V4_ADD( A, B ) vaddq_f32( A, B )
+	#define SMP_V4_SUB( A, B ) vsubq_f32( A, B )
+	#define SMP_V4_MUL( A, B ) vmulq_f32( A, B )
+    #endif
+#endif
 #define MODULE_DATA	psynth_sampler_data
 #define MODULE_HANDLER	psynth_sampler
 #define MODULE_INPUTS	2
@@ -1498,6 +1527,187 @@ int sampler_par( psynth_net* net, int mod_num, int smp_num, int par_num, int par
     net->change_counter++;
     return prev_val;
 }
+#define SAMPLER_STEP( PH, PL ) \
+{ \
+    if( reverse ) \
+	PSYNTH_FP64_SUB( PH, PL, delta_h, delta_l ) \
+    else \
+	PSYNTH_FP64_ADD( PH, PL, delta_h, delta_l ) \
+}
+template < typename T > static inline int sampler_smp_i16( T v ) { return sizeof( T ) == 1 ? (int)v << 8 : (int)v; }
+template < typename T, bool STEREO, int INTERP >
+static int sampler_render_run( 
+    gen_channel* chan, 
+    const T* RESTRICT smp, 
+    SMPPTR lo, 
+    SMPPTR hi, 
+    PS_STYPE* RESTRICT out0, 
+    PS_STYPE* RESTRICT out1, 
+    int frames )
+{
+    const int step = STEREO ? 2 : 1;
+    const bool smp_float = sizeof( T ) == 4;
+    SMPPTR ptr_h = chan->ptr_h;
+    int ptr_l = chan->ptr_l;
+    uint delta_h = chan->delta_h;
+    uint delta_l = chan->delta_l;
+    bool reverse = ( chan->flags & GEN_CHANNEL_FLAG_REVERSE ) != 0;
+    uint range = (uint)hi - (uint)lo;
+    int i = 0;
+#ifdef SAMPLER_SIMD
+    if( INTERP == 2 ) //spline: 4 frames at once; the simpler modes are faster as scalar loops
+    {
+	for( ; i + 4 <= frames; i += 4 )
+	{
+	    SMPPTR h[ 4 ];
+	    int l[ 4 ];
+	    SMPPTR ph = ptr_h;
+	    int pl = ptr_l;
+	    int j = 0;
+	    for( ; j < 4; j++ )
+	    {
+		if( (uint)ph - (uint)lo >= range ) break;
+		h[ j ] = ph * step;
+		l[ j ] = pl;
+		SAMPLER_STEP( ph, pl );
+	    }
+	    if( j < 4 ) break;
+	    ptr_h = ph;
+	    ptr_l = pl;
+	    for( int c = 0; c < step; c++ )
+	    {
+		PS_STYPE* RESTRICT out = c ? out1 : out0;
+		if( !out ) break;
+		const T* RESTRICT s = smp + c;
+		sampler_v4 y0 = SMP_V4_SET( s[ h[ 0 ] - step ], s[ h[ 1 ] - step ], s[ h[ 2 ] - step ], s[ h[ 3 ] - step ] );
+		sampler_v4 y1 = SMP_V4_SET( s[ h[ 0 ] ], s[ h[ 1 ] ], s[ h[ 2 ] ], s[ h[ 3 ] ] );
+		sampler_v4 y2 = SMP_V4_SET( s[ h[ 0 ] + step ], s[ h[ 1 ] + step ], s[ h[ 2 ] + step ], s[ h[ 3 ] + step ] );
+		sampler_v4 y3 = SMP_V4_SET( s[ h[ 0 ] + step * 2 ], s[ h[ 1 ] + step * 2 ], s[ h[ 2 ] + step * 2 ], s[ h[ 3 ] + step * 2 ] );
+		sampler_v4 mu = SMP_V4_MUL( SMP_V4_SETI( l[ 0 ], l[ 1 ], l[ 2 ], l[ 3 ] ), SMP_V4_SET1( 1.0F / (float)( 1 << PSYNTH_FP64_PREC ) ) );
+		sampler_v4 half = SMP_V4_SET1( 0.5F );
+		sampler_v4 a = SMP_V4_MUL( SMP_V4_ADD( SMP_V4_SUB( SMP_V4_MUL( SMP_V4_SET1( 3 ), SMP_V4_SUB( y1, y2 ) ), y0 ), y3 ), half );
+		sampler_v4 b = SMP_V4_SUB( SMP_V4_ADD( SMP_V4_MUL( SMP_V4_SET1( 2 ), y2 ), y0 ), SMP_V4_MUL( SMP_V4_ADD( SMP_V4_MUL( SMP_V4_SET1( 5 ), y1 ), y3 ), half ) );
+		sampler_v4 c2 = SMP_V4_MUL( SMP_V4_SUB( y2, y0 ), half );
+		sampler_v4 v = SMP_V4_ADD( SMP_V4_MUL( SMP_V4_ADD( SMP_V4_MUL( SMP_V4_ADD( SMP_V4_MUL( a, mu ), b ), mu ), c2 ), mu ), y1 );
+		if( sizeof( T ) == 1 ) v = SMP_V4_MUL( v, SMP_V4_SET1( 1.0F / 128.0F ) );
+		if( sizeof( T ) == 2 ) v = SMP_V4_MUL( v, SMP_V4_SET1( 1.0F / 32768.0F ) );
+		SMP_V4_STORE( out + i, v );
+	    }
+	}
+    }
+#endif
+    for( ; i < frames; i++ )
+    {
+	if( (uint)ptr_h - (uint)lo >= range ) break;
+	for( int c = 0; c < step; c++ )
+	{
+	    PS_STYPE* RESTRICT out = c ? out1 : out0;
+	    if( !out ) break;
+	    const T* RESTRICT s = smp + ptr_h * step + c;
+	    PS_STYPE2 v;
+	    if( INTERP == 0 )
+	    {
+		if( smp_float )
+		    v = s[ 0 ] * PS_STYPE_ONE;
+		else
+		    PS_INT16_TO_STYPE( v, sampler_smp_i16( s[ 0 ] ) );
+	    }
+	    else if( INTERP == 1 )
+	    {
+		uint intr = ptr_l >> ( PSYNTH_FP64_PREC - INTERP_PREC );
+		uint intr2 = ( 1 << INTERP_PREC ) - 1 - intr;
+		if( smp_float )
+		{
+		    float iv = s[ 0 ] * ( (float)intr2 / 32768.0F ) + s[ step ] * ( (float)intr / 32768.0F );
+		    v = iv * PS_STYPE_ONE;
+		}
+		else
+		{
+		    int iv = sampler_smp_i16( s[ 0 ] ) * intr2 + sampler_smp_i16( s[ step ] ) * intr;
+		    iv >>= INTERP_PREC;
+		    PS_INT16_TO_STYPE( v, iv );
+		}
+	    }
+#ifdef PS_STYPE_FLOATINGPOINT
+	    else
+	    {
+		PS_STYPE2 y0 = s[ -step ];
+		PS_STYPE2 y1 = s[ 0 ];
+		PS_STYPE2 y2 = s[ step ];
+		PS_STYPE2 y3 = s[ step * 2 ];
+		PS_STYPE2 mu = (PS_STYPE2)ptr_l / (PS_STYPE2)( 1 << PSYNTH_FP64_PREC );
+		PS_STYPE2 a = ( 3 * ( y1-y2 ) - y0 + y3 ) / 2;
+		PS_STYPE2 b = 2 * y2 + y0 - ( 5 * y1 + y3 ) / 2;
+		PS_STYPE2 c2 = ( y2 - y0 ) / 2;
+		v = ( ( ( a * mu ) + b ) * mu + c2 ) * mu + y1;
+		if( sizeof( T ) == 1 ) v /= 128.0F;
+		if( sizeof( T ) == 2 ) v /= 32768.0F;
+	    }
+#endif
+	    out[ i ] = v;
+	}
+	SAMPLER_STEP( ptr_h, ptr_l );
+    }
+    chan->ptr_h = ptr_h;
+    chan->ptr_l = ptr_l;
+    return i;
+}
+//Render the frames that need no loop or boundary handling (most of them);
+//returns the number of frames rendered:
+static int sampler_render_plain( 
+    gen_channel* chan, 
+    void* smp_data,
+    uint8_t smp_bits,
+    bool smp_stereo,
+    int ctl_smp_int, 
+    SMPPTR reppnt,
+    SMPPTR replen,
+    SMPPTR smp_len,
+    PS_STYPE* out0, 
+    PS_STYPE* out1, 
+    int frames )
+{
+    SMPPTR lo = 0;
+    SMPPTR hi = smp_len;
+    if( replen )
+    {
+	if( reppnt + replen < hi ) hi = reppnt + replen;
+	if( chan->flags & GEN_CHANNEL_FLAG_REVERSE ) lo = reppnt;
+    }
+    hi -= ctl_smp_int;
+    if( ctl_smp_int == 2 )
+    {
+	if( lo < 1 ) lo = 1;
+	if( replen && ( chan->flags & GEN_CHANNEL_FLAG_INLOOP ) && lo < reppnt + 1 ) lo = reppnt + 1;
+    }
+    if( lo >= hi ) return 0;
+    if( (uint)chan->ptr_h - (uint)lo >= (uint)hi - (uint)lo ) return 0;
+#ifdef PS_STYPE_FLOATINGPOINT
+    #define SAMPLER_RUN_SPLINE( T, STEREO ) case 2: return sampler_render_run< T, STEREO, 2 >( chan, (const T*)smp_data, lo, hi, out0, out1, frames );
+#else
+    #define SAMPLER_RUN_SPLINE( T, STEREO )
+#endif
+    #define SAMPLER_RUN( T, STEREO ) \
+	switch( ctl_smp_int ) \
+	{ \
+	    case 0: return sampler_render_run< T, STEREO, 0 >( chan, (const T*)smp_data, lo, hi, out0, out1, frames ); \
+	    case 1: return sampler_render_run< T, STEREO, 1 >( chan, (const T*)smp_data, lo, hi, out0, out1, frames ); \
+	    SAMPLER_RUN_SPLINE( T, STEREO ) \
+	} \
+	break;
+    switch( smp_bits * 2 + smp_stereo )
+    {
+	case 0: SAMPLER_RUN( int8_t, false );
+	case 1: SAMPLER_RUN( int8_t, true );
+	case 2: SAMPLER_RUN( int16_t, false );
+	case 3: SAMPLER_RUN( int16_t, true );
+	case 4: SAMPLER_RUN( float, false );
+	case 5: SAMPLER_RUN( float, true );
+    }
+    #undef SAMPLER_RUN
+    #undef SAMPLER_RUN_SPLINE
+    return 0;
+}
 static inline uint sampler_render( 
     gen_channel* chan, 
     instrument* ins, 
@@ -1544,6 +1754,8 @@ static inline uint sampler_render(
     int i = 0;
     for( ; i < frames; i++ )
     {
+	i += sampler_render_plain( chan, smp_data, smp_bits, smp_stereo, ctl_smp_int, reppnt, replen, smp_len, out0 + i, out1 ? out1 + i : NULL, frames - i );
+	if( i >= frames ) break;
 	if( replen )
 	{
 	    if( chan->ptr_h >= repend )
@@ -2003,7 +2215,16 @@ static inline void sampler_apply_volume_envelope(
 		vol = chan->r_cur;
 		delta = chan->r_delta;
 	    }
-	    for( int i = 0; i < frames2; i++ )
+	    int i = 0;
+#ifdef SAMPLER_SIMD
+	    for( ; i + 4 <= frames2; i += 4 )
+	    {
+		sampler_v4 v = SMP_V4_SETI( ( vol + delta ) >> 12, ( vol + delta * 2 ) >> 12, ( vol + delta * 3 ) >> 12, ( vol + delta * 4 ) >> 12 );
+		vol += delta * 4;
+		SMP_V4_STORE( buf + i, SMP_V4_MUL( SMP_V4_MUL( SMP_V4_LOAD( buf + i ), v ), SMP_V4_SET1( (PS_STYPE)( 1.0 / 32768.0 ) ) ) );
+	    }
+#endif
+	    for( ; i < frames2; i++ )
 	    {
 		vol += delta;
 #ifdef PS_STYPE_FLOATINGPOINT
@@ -2012,7 +2233,15 @@ static inline void sampler_apply_volume_envelope(
 		buf[ i ] = ( (PS_STYPE2)buf[ i ] * ( vol >> 12 ) ) >> 15;
 #endif
 	    }
-	    for( int i = frames2; i < frames; i++ )
+#ifdef SAMPLER_SIMD
+	    if( frames2 < frames )
+	    {
+		sampler_v4 v = SMP_V4_SET1( (PS_STYPE)( vol >> 12 ) );
+		for( ; i + 4 <= frames; i += 4 )
+		    SMP_V4_STORE( buf + i, SMP_V4_MUL( SMP_V4_MUL( SMP_V4_LOAD( buf + i ), v ), SMP_V4_SET1( (PS_STYPE)( 1.0 / 32768.0 ) ) ) );
+	    }
+#endif
+	    for( ; i < frames; i++ )
 	    {
 #ifdef PS_STYPE_FLOATINGPOINT
 		buf[ i ] = buf[ i ] * (PS_STYPE)( vol >> 12 ) * (PS_STYPE)( 1.0 / 32768.0 );
@@ -2590,6 +2819,7 @@ PS_RETTYPE MODULE_HANDLER(
 	case PS_CMD_GET_INPUTS_NUM: retval = MODULE_INPUTS; break;
 	case PS_CMD_GET_OUTPUTS_NUM: retval = MODULE_OUTPUTS; break;
 	case PS_CMD_GET_FLAGS: retval = PSYNTH_FLAG_GENERATOR | PSYNTH_FLAG_GET_SPEED_CHANGES | PSYNTH_FLAG_EFFECT | PSYNTH_FLAG_USE_MUTEX; break;
+	case PS_CMD_GET_FLAGS2: retval = PSYNTH_FLAG2_PARALLEL_SETUP; break;
 	case PS_CMD_INIT:
 	    {
 		psynth_resize_ctls_storage( mod_num, 9, pnet );
@@ -2767,6 +2997,7 @@ PS_RETTYPE MODULE_HANDLER(
 			    if( bits == 8 ) flags |= PS_CHUNK_SMP_INT8;
 			    flags |= ( channels - 1 ) << PS_CHUNK_SMP_CH_OFFSET;
 			    psynth_set_chunk_info( mod_num, CHUNK_SMP_DATA( s ), pnet, flags, freq );
+			    psynth_share_chunk( mod_num, CHUNK_SMP_DATA( s ), pnet );
 			    recalc_base_pitch( s, mod_num, data, pnet );
 			}
 		    }
@@ -85,6 +85,7 @@ struct MODULE_DATA
     uint8_t*  		freq_type;
     int16_t*  		samples[ MAX_SAMPLES ];
     int	    		sample_size;
+    fft_plan*		fft_p;
     int	    		note_offset;
     int     		base_pitch;
     smutex 		render_sound_mutex;
@@ -186,10 +187,13 @@ static void set_number_of_outputs( int mod_num, psynth_net* pnet )
 	}
     }
 }
-static void fft_with_normalization( int16_t* result, float* fi, float* fr, int fft_size )
+static void fft_with_normalization( int16_t* result, fft_plan* p, float* fi, float* fr, int fft_size )
 {
     int i;
-    fft( 0, fi, fr, fft_size );
+    if( p )
+	fft_plan_run( p, 0, fi, fr );
+    else
+	fft( 0, fi, fr, fft_size );
     float max = 0;
     for( i = 0; i < fft_size; i++ )
     {
@@ -236,6 +240,8 @@ static void recalc_samples( bool lock_sound_stream, MODULE_DATA* data, int mod_n
     {
 	smem_free( data->samples[ 0 ] );
 	data->samples[ 0 ] = SMEM_ZALLOC2( int16_t, data->sample_size );
+	fft_plan_remove( data->fft_p );
+	data->fft_p = fft_plan_new( data->sample_size );
     }
     if( lock_sound_stream ) 
     {
@@ -491,7 +497,7 @@ static void recalc_samples( bool lock_sound_stream, MODULE_DATA* data, int mod_n
     }
     hi[ 0 ] = 0; 
     hr[ 0 ] = 0;
-    fft_with_normalization( smp, hi, hr, data->sample_size );
+    fft_with_normalization( smp, data->fft_p, hi, hr, data->sample_size );
     smem_free( hr );
     smem_free( hi );
     smem_free( distribution );
@@ -662,6 +668,7 @@ PS_RETTYPE MODULE_HANDLER(
 	case PS_CMD_GET_INPUTS_NUM: retval = MODULE_INPUTS; break;
 	case PS_CMD_GET_OUTPUTS_NUM: retval = MODULE_OUTPUTS; break;
 	case PS_CMD_GET_FLAGS: retval = PSYNTH_FLAG_GENERATOR; break;
+	case PS_CMD_GET_FLAGS2: retval = PSYNTH_FLAG2_PARALLEL_SETUP; break;
 	case PS_CMD_INIT:
 	    data->module_data = data;
 	    data->mod_num = mod_num;
@@ -1133,6 +1140,7 @@ PS_RETTYPE MODULE_HANDLER(
 		if( data->samples[ s ] ) smem_free( data->samples[ s ] );
 		data->samples[ s ] = 0;
 	    }
+	    fft_plan_remove( data->fft_p );
 #ifdef SUNVOX_GUI
 	    if( mod->visual && data->wm )
 	    {
@@ -38,6 +38,32 @@ IN THE SOFTWARE.
 #define MAX_CHANNELS	4
 #define PCMBUF_SAMPLES 	256
 #define PCMBUF_BYTES 	( PCMBUF_SAMPLES * sizeof( int16_t ) )
+#define PF_RING_FRAMES	16384
+#define PF_HEAD_FRAMES	32768
+#define PF_SEEK_FRAMES	8192
+#define PF_SLOTS	( MAX_CHANNELS + 4 )
+#define PF_CHUNK_FRAMES	1024
+struct MODULE_DATA;
+struct vplayer_stream
+{
+    MODULE_DATA*	data;
+    OggVorbis_File  	vf;
+    bool	    	vf_open;
+    size_t    		src_offset;
+    sfs_file 		f;
+    uint64_t		pos;
+};
+struct vplayer_pf_slot
+{
+    std::atomic_int	ready;
+    std::atomic_int	pins;
+    uint64_t		pos;
+    int			len;
+    int16_t*		pcm;
+    vplayer_stream*	spare;
+    bool		rec;
+    uint		used;
+};
 struct gen_channel
 {
     bool    		playing;
@@ -47,13 +73,30 @@ struct gen_channel
     int	    		ptr_l;
     uint    		delta_h;
     uint    		delta_l;
-    OggVorbis_File  	vf;
-    bool	    	vf_open;
+    vplayer_stream	s;
     tremor_vorbis_info*    	vi;
-    size_t    		src_offset;
-    sfs_file 		f;
     int	    		loaded;
-    int16_t    		pcmbuf[ PCMBUF_SAMPLES ]; 
+    int16_t    		pcmbuf[ PCMBUF_SAMPLES ];
+    bool		pf;
+    uint		pf_req;
+    uint64_t		pf_start;
+    uint		pf_pos;
+    int16_t*		pf_head;
+    int			pf_head_len;
+    int			pf_slot;
+    std::atomic_uint	pf_req_a;
+    uint64_t		pf_req_start;
+    int			pf_req_slot;
+    int16_t*		ring;
+    std::atomic_uint	ring_req;
+    std::atomic_uint	ring_wr;
+    std::atomic_uint	ring_rd;
+    std::atomic_uint	ring_end;
+    uint		w_req;
+    vplayer_stream*	w_s;
+    uint		w_wr;
+    int			w_rec_slot;
+    bool		w_end;
 };
 struct MODULE_DATA
 {
@@ -76,13 +119,507 @@ struct MODULE_DATA
     void* 		src;
     char*	    	src_file;
     size_t 		src_size;
-    uint64_t 		src_pcm_total; 
-    int 		cur_chan;
+    uint64_t 		src_pcm_total;
     int	    		pause;
+    bool		pf;
+    bool		pf_active;
+    sthread		pf_th;
+    ssemaphore		pf_sem;
+    volatile bool	pf_exit;
+    tremor_vorbis_info	pf_vi;
+    int			pf_nch;
+    vplayer_pf_slot	pf_slots[ PF_SLOTS ];
+    uint		pf_used;
+    int16_t*		pf_tmp;
+    std::atomic_uint	pf_underruns;
 #ifdef SUNVOX_GUI
     window_manager* 	wm;
 #endif
 };
+size_t vplayer_read( void* ptr, size_t s, size_t nmemb, void* datasource )
+{
+    vplayer_stream* st = (vplayer_stream*)datasource;
+    MODULE_DATA* data = st->data;
+    if( data->src )
+    {
+	if( st->src_offset >= data->src_size ) return 0;
+	size_t size = s * nmemb;
+	size_t can_read = data->src_size - st->src_offset;
+	if( can_read < size ) size = can_read;
+	smem_copy( ptr, (char*)data->src + st->src_offset, size );
+	st->src_offset += size;
+	return size;
+    }
+    if( data->src_file )
+    {
+	if( st->f == 0 )
+	{
+	    st->f = sfs_open( data->src_file, "rb" );
+	    if( st->f == 0 ) return 0;
+	}
+	return sfs_read( ptr, 1, s * nmemb, st->f );
+    }
+    return 0;
+}
+int vplayer_seek( void* datasource, ogg_int64_t offset, int whence )
+{
+    vplayer_stream* st = (vplayer_stream*)datasource;
+    MODULE_DATA* data = st->data;
+    if( data->src )
+    {
+	switch( whence )
+	{
+	    case 0: st->src_offset = offset; break;
+	    case 1: st->src_offset += offset; break;
+	    case 2: st->src_offset = data->src_size + offset; break;
+	}
+	if( st->src_offset >= data->src_size ) return -1;
+	return 0;
+    }
+    if( data->src_file )
+    {
+	if( st->f )
+	{
+	    return sfs_seek( st->f, offset, whence );
+	}
+    }
+    return 0;
+}
+int vplayer_close( void* datasource )
+{
+    vplayer_stream* st = (vplayer_stream*)datasource;
+    MODULE_DATA* data = st->data;
+    if( data->src )
+    {
+	st->src_offset = 0;
+	return 0;
+    }
+    if( data->src_file )
+    {
+	if( st->f )
+	{
+	    sfs_close( st->f );
+	    st->f = 0;
+	}
+    }
+    return 0;
+}
+long vplayer_tell( void* datasource )
+{
+    vplayer_stream* st = (vplayer_stream*)datasource;
+    MODULE_DATA* data = st->data;
+    if( data->src )
+    {
+	return st->src_offset;
+    }
+    if( data->src_file )
+    {
+	if( st->f )
+	{
+	    return sfs_tell( st->f );
+	}
+    }
+    return 0;
+}
+static int vplayer_stream_open( MODULE_DATA* data, vplayer_stream* s )
+{
+    s->data = data;
+    s->src_offset = 0;
+    s->pos = 0;
+    int rv = tremor_ov_open_callbacks( (void*)s, &s->vf, 0, 0, data->vc );
+    s->vf_open = ( rv == 0 );
+    return rv;
+}
+//Prefetch (vplayer_prefetch=1 in the sconfig):
+//the streams are decoded by the worker thread into the lock-free rings (one per channel);
+//slot 0 = first PF_HEAD_FRAMES of the stream; other slots = recent seek points (sample offset);
+//each slot has a spare decoder, already positioned at the end of the slot;
+//so the note-on (or sample offset) in the audio thread only switches to the slot and sends a request to the worker;
+//if the ring is empty, the audio thread plays silence (underrun) instead of waiting.
+static int vplayer_pf_decode( MODULE_DATA* data, vplayer_stream* s, int16_t* dest, int frames )
+{
+    int frame_size = data->pf_nch * sizeof( int16_t );
+    int bytes = frames * frame_size;
+    int rv = 0;
+    while( rv < bytes )
+    {
+	int current_section;
+	int r = tremor_ov_read( &s->vf, (char*)dest + rv, bytes - rv, &current_section );
+	if( r <= 0 ) break;
+	rv += r;
+    }
+    rv /= frame_size;
+    s->pos += rv;
+    return rv;
+}
+static void vplayer_pf_free_stream( vplayer_stream* s )
+{
+    if( !s ) return;
+    if( s->vf_open ) tremor_ov_clear( &s->vf );
+    if( s->f ) sfs_close( s->f );
+    smem_free( s );
+}
+static vplayer_stream* vplayer_pf_new_stream( MODULE_DATA* data, uint64_t pos, int skip ) 
+{
+    vplayer_stream* s = SMEM_ZALLOC2( vplayer_stream, 1 );
+    if( !s ) return NULL;
+    if( vplayer_stream_open( data, s ) )
+    {
+	vplayer_pf_free_stream( s );
+	return NULL;
+    }
+    if( pos )
+    {
+	tremor_ov_pcm_seek( &s->vf, pos );
+	s->pos = pos;
+    }
+    while( skip > 0 )
+    {
+	int n = vplayer_pf_decode( data, s, data->pf_tmp, skip < PF_CHUNK_FRAMES ? skip : PF_CHUNK_FRAMES );
+	if( n <= 0 ) break;
+	skip -= n;
+    }
+    return s;
+}
+static int vplayer_pf_new_slot( MODULE_DATA* data, uint64_t pos ) //worker
+{
+    uint tried = 0;
+    while( 1 )
+    {
+	int best = -1;
+	for( int i = 1; i < PF_SLOTS; i++ )
+	{
+	    vplayer_pf_slot* slot = &data->pf_slots[ i ];
+	    if( slot->rec || ( tried & ( 1 << i ) ) ) continue;
+	    if( best < 0 || slot->used < data->pf_slots[ best ].used ) best = i;
+	}
+	if( best < 0 ) return -1;
+	vplayer_pf_slot* slot = &data->pf_slots[ best ];
+	int was_ready = atomic_exchange( &slot->ready, 0 );
+	if( atomic_load( &slot->pins ) )
+	{
+	    if( was_ready ) atomic_store( &slot->ready, 1 );
+	    tried |= 1 << best;
+	    continue;
+	}
+	vplayer_pf_free_stream( slot->spare );
+	slot->spare = NULL;
+	slot->pos = pos;
+	slot->len = 0;
+	slot->rec = 1;
+	slot->used = ++data->pf_used;
+	return best;
+    }
+}
+static void vplayer_pf_finish_slot( MODULE_DATA* data, gen_channel* chan ) //worker
+{
+    vplayer_pf_slot* slot = &data->pf_slots[ chan->w_rec_slot ];
+    slot->rec = 0;
+    if( slot->len > 0 ) atomic_store( &slot->ready, 1 );
+    chan->w_rec_slot = -1;
+}
+static bool vplayer_pf_fill( MODULE_DATA* data, gen_channel* chan ) //worker
+{
+    int nch = data->pf_nch;
+    uint req = atomic_load( &chan->pf_req_a );
+    if( req != chan->w_req )
+    {
+	chan->w_req = req;
+	uint64_t start = chan->pf_req_start;
+	int k = chan->pf_req_slot;
+	if( chan->w_rec_slot >= 0 )
+	{
+	    data->pf_slots[ chan->w_rec_slot ].rec = 0;
+	    chan->w_rec_slot = -1;
+	}
+	vplayer_pf_free_stream( chan->w_s );
+	chan->w_s = NULL;
+	if( k >= 0 && k < PF_SLOTS )
+	{
+	    vplayer_pf_slot* slot = &data->pf_slots[ k ];
+	    slot->used = ++data->pf_used;
+	    if( slot->spare && slot->spare->pos == start + slot->len )
+	    {
+		chan->w_s = slot->spare;
+		slot->spare = NULL;
+	    }
+	    else
+	    {
+		chan->w_s = vplayer_pf_new_stream( data, start, slot->len );
+	    }
+	}
+	else
+	{
+	    chan->w_s = vplayer_pf_new_stream( data, start, 0 );
+	    if( chan->w_s && start > 0 ) chan->w_rec_slot = vplayer_pf_new_slot( data, start );
+	}
+	chan->w_wr = 0;
+	chan->w_end = ( chan->w_s == NULL );
+	atomic_store( &chan->ring_wr, 0 );
+	atomic_store( &chan->ring_end, chan->w_end ? 1 : 0 );
+	atomic_store( &chan->ring_req, req );
+	return true;
+    }
+    if( chan->w_end ) return false;
+    uint rd = atomic_load( &chan->ring_rd );
+    uint wr = chan->w_wr;
+    if( (int)( wr - rd ) > PF_RING_FRAMES - PF_CHUNK_FRAMES ) return false;
+    int16_t* src = data->pf_tmp;
+    int n = vplayer_pf_decode( data, chan->w_s, src, PF_CHUNK_FRAMES );
+    if( n <= 0 )
+    {
+	if( chan->w_rec_slot >= 0 ) vplayer_pf_finish_slot( data, chan );
+	if( data->ctl_loop && chan->w_s->pos )
+	{
+	    tremor_ov_time_seek( &chan->w_s->vf, 0 );
+	    chan->w_s->pos = 0;
+	    return true;
+	}
+	chan->w_end = 1;
+	atomic_store( &chan->ring_end, wr + 1 );
+	return true;
+    }
+    if( chan->w_rec_slot >= 0 )
+    {
+	vplayer_pf_slot* slot = &data->pf_slots[ chan->w_rec_slot ];
+	int n2 = PF_SEEK_FRAMES - slot->len;
+	if( n2 > n ) n2 = n;
+	smem_copy( slot->pcm + slot->len * nch, src, n2 * nch * sizeof( int16_t ) );
+	slot->len += n2;
+	if( slot->len == PF_SEEK_FRAMES ) vplayer_pf_finish_slot( data, chan );
+    }
+    if( (int)( rd - wr ) > 0 )
+    {
+	//skipped by the audio thread (underrun):
+	int skip = rd - wr;
+	if( skip > n ) skip = n;
+	src += skip * nch;
+	wr += skip;
+	n -= skip;
+    }
+    while( n > 0 )
+    {
+	int i = wr & ( PF_RING_FRAMES - 1 );
+	int n2 = PF_RING_FRAMES - i;
+	if( n2 > n ) n2 = n;
+	smem_copy( chan->ring + i * nch, src, n2 * nch * sizeof( int16_t ) );
+	src += n2 * nch;
+	wr += n2;
+	n -= n2;
+    }
+    chan->w_wr = wr;
+    atomic_store( &chan->ring_wr, wr );
+    return true;
+}
+static bool vplayer_pf_prepare_spare( MODULE_DATA* data ) //worker
+{
+    for( int i = 0; i < PF_SLOTS; i++ )
+    {
+	vplayer_pf_slot* slot = &data->pf_slots[ i ];
+	if( slot->spare || slot->rec || !atomic_load( &slot->ready ) ) continue;
+	slot->spare = vplayer_pf_new_stream( data, slot->pos, slot->len );
+	if( slot->spare ) return true;
+    }
+    return false;
+}
+static void* vplayer_pf_thread( void* user_data )
+{
+    MODULE_DATA* data = (MODULE_DATA*)user_data;
+    while( !data->pf_exit )
+    {
+	bool busy = false;
+	for( int c = 0; c < MAX_CHANNELS; c++ )
+	{
+	    if( vplayer_pf_fill( data, &data->channels[ c ] ) ) busy = true;
+	}
+	if( busy ) continue;
+	if( vplayer_pf_prepare_spare( data ) ) continue;
+	ssemaphore_wait( &data->pf_sem, 10 );
+    }
+    return NULL;
+}
+static void vplayer_pf_free( MODULE_DATA* data )
+{
+    for( int c = 0; c < MAX_CHANNELS; c++ )
+    {
+	gen_channel* chan = &data->channels[ c ];
+	if( chan->pf )
+	{
+	    chan->playing = 0;
+	    chan->id = ~0;
+	    chan->pf = 0;
+	}
+	vplayer_pf_free_stream( chan->w_s );
+	chan->w_s = NULL;
+	smem_free( chan->ring );
+	chan->ring = NULL;
+    }
+    for( int i = 0; i < PF_SLOTS; i++ )
+    {
+	vplayer_pf_slot* slot = &data->pf_slots[ i ];
+	vplayer_pf_free_stream( slot->spare );
+	slot->spare = NULL;
+	smem_free( slot->pcm );
+	slot->pcm = NULL;
+    }
+    smem_free( data->pf_tmp );
+    data->pf_tmp = NULL;
+}
+static void vplayer_pf_stop( MODULE_DATA* data )
+{
+    if( !data->pf_active ) return;
+    data->pf_exit = 1;
+    ssemaphore_release( &data->pf_sem );
+    sthread_destroy( &data->pf_th, STHREAD_TIMEOUT_INFINITE );
+    ssemaphore_destroy( &data->pf_sem );
+    data->pf_active = 0;
+    vplayer_pf_free( data );
+}
+static void vplayer_pf_start( MODULE_DATA* data, psynth_net* pnet )
+{
+    vplayer_pf_stop( data );
+    if( !data->pf ) return;
+    if( !data->src && !data->src_file ) return;
+    data->pf_tmp = SMEM_ALLOC2( int16_t, PF_CHUNK_FRAMES * 2 );
+    if( !data->pf_tmp ) return;
+    vplayer_stream* s = vplayer_pf_new_stream( data, 0, 0 );
+    if( s )
+    {
+	data->pf_vi = *tremor_ov_info( &s->vf, -1 );
+	data->pf_nch = data->pf_vi.channels;
+    }
+    bool err = ( !s || data->pf_nch < 1 || data->pf_nch > 2 );
+    for( int i = 0; i < PF_SLOTS && !err; i++ )
+    {
+	vplayer_pf_slot* slot = &data->pf_slots[ i ];
+	int len = i == 0 ? PF_HEAD_FRAMES : PF_SEEK_FRAMES;
+	slot->pcm = SMEM_ALLOC2( int16_t, len * data->pf_nch );
+	if( !slot->pcm ) { err = 1; break; }
+	slot->pos = 0;
+	slot->len = 0;
+	slot->rec = 0;
+	slot->used = 0;
+	atomic_init( &slot->pins, 0 );
+	atomic_init( &slot->ready, 0 );
+	if( i == 0 )
+	{
+	    slot->len = vplayer_pf_decode( data, s, slot->pcm, PF_HEAD_FRAMES );
+	    slot->spare = s;
+	    s = NULL;
+	    atomic_init( &slot->pins, 1 ); //always in use
+	    atomic_init( &slot->ready, 1 );
+	}
+    }
+    for( int c = 0; c < MAX_CHANNELS && !err; c++ )
+    {
+	gen_channel* chan = &data->channels[ c ];
+	chan->ring = SMEM_ALLOC2( int16_t, PF_RING_FRAMES * data->pf_nch );
+	if( !chan->ring ) { err = 1; break; }
+	chan->pf = 0;
+	chan->pf_req = 0;
+	chan->pf_slot = -1;
+	atomic_init( &chan->pf_req_a, 0 );
+	atomic_init( &chan->ring_req, 0 );
+	atomic_init( &chan->ring_wr, 0 );
+	atomic_init( &chan->ring_rd, 0 );
+	atomic_init( &chan->ring_end, 1 );
+	chan->w_req = 0;
+	chan->w_s = NULL;
+	chan->w_rec_slot = -1;
+	chan->w_end = 1;
+    }
+    if( err )
+    {
+	vplayer_pf_free_stream( s );
+	vplayer_pf_free( data );
+	return;
+    }
+    data->pf_used = 0;
+    data->pf_exit = 0;
+    ssemaphore_create( &data->pf_sem, NULL, 0, 0 );
+    sundog_engine* sd = nullptr; GET_SD_FROM_PSYNTH_NET( pnet, sd );
+    sthread_create( &data->pf_th, sd, vplayer_pf_thread, data, 0 );
+    data->pf_active = 1;
+}
+static void vplayer_pf_request( MODULE_DATA* data, gen_channel* chan, uint64_t pos ) //audio thread
+{
+    if( chan->pf_slot >= 0 )
+    {
+	atomic_fetch_sub( &data->pf_slots[ chan->pf_slot ].pins, 1 );
+	chan->pf_slot = -1;
+    }
+    chan->pf_head = NULL;
+    chan->pf_head_len = 0;
+    for( int i = 0; i < PF_SLOTS; i++ )
+    {
+	vplayer_pf_slot* slot = &data->pf_slots[ i ];
+	atomic_fetch_add( &slot->pins, 1 );
+	if( atomic_load( &slot->ready ) && slot->pos == pos )
+	{
+	    chan->pf_slot = i;
+	    chan->pf_head = slot->pcm;
+	    chan->pf_head_len = slot->len;
+	    break;
+	}
+	atomic_fetch_sub( &slot->pins, 1 );
+    }
+    chan->pf = 1;
+    chan->pf_start = pos;
+    chan->pf_pos = 0;
+    chan->pf_req_start = pos;
+    chan->pf_req_slot = chan->pf_slot;
+    atomic_store( &chan->ring_rd, 0 );
+    chan->pf_req++;
+    atomic_store( &chan->pf_req_a, chan->pf_req );
+    ssemaphore_release( &data->pf_sem );
+}
+static int vplayer_pf_read( MODULE_DATA* data, gen_channel* chan, int16_t* dest, int bytes ) //audio thread; retval = ov_read()
+{
+    int nch = data->pf_nch;
+    int frames = bytes / ( nch * sizeof( int16_t ) );
+    int i = 0;
+    if( chan->pf_pos < (uint)chan->pf_head_len )
+    {
+	i = chan->pf_head_len - chan->pf_pos;
+	if( i > frames ) i = frames;
+	smem_copy( dest, chan->pf_head + chan->pf_pos * nch, i * nch * sizeof( int16_t ) );
+	chan->pf_pos += i;
+	if( i == frames ) return i * nch * sizeof( int16_t );
+    }
+    if( chan->pf_slot >= 0 )
+    {
+	atomic_fetch_sub( &data->pf_slots[ chan->pf_slot ].pins, 1 );
+	chan->pf_slot = -1;
+    }
+    uint rd = chan->pf_pos - chan->pf_head_len;
+    bool eof = 0;
+    if( atomic_load( &chan->ring_req ) == chan->pf_req )
+    {
+	uint end = atomic_load( &chan->ring_end );
+	uint wr = atomic_load( &chan->ring_wr );
+	while( i < frames && (int)( wr - rd ) > 0 )
+	{
+	    int r = rd & ( PF_RING_FRAMES - 1 );
+	    int n = PF_RING_FRAMES - r;
+	    if( n > (int)( wr - rd ) ) n = wr - rd;
+	    if( n > frames - i ) n = frames - i;
+	    smem_copy( dest + i * nch, chan->ring + r * nch, n * nch * sizeof( int16_t ) );
+	    i += n;
+	    rd += n;
+	}
+	if( end && rd + 1 >= end ) eof = 1;
+    }
+    if( i < frames && !eof )
+    {
+	smem_clear( dest + i * nch, ( frames - i ) * nch * sizeof( int16_t ) );
+	rd += frames - i;
+	i = frames;
+	atomic_fetch_add( &data->pf_underruns, 1 );
+    }
+    chan->pf_pos = chan->pf_head_len + rd;
+    atomic_store( &chan->ring_rd, rd );
+    return i * nch * sizeof( int16_t );
+}
 int vplayer_get_base_note( int mod_num, psynth_net* pnet )
 {
     if( !pnet ) return 0;
@@ -102,15 +639,13 @@ void vplayer_get_base_pitch( int mod_num, psynth_net* pnet )
     MODULE_DATA* data = (MODULE_DATA*)mod->data_ptr;
     if( !data->src && !data->src_file ) return;
     int base_freq = 1;
-    OggVorbis_File vf;
-    data->cur_chan = MAX_CHANNELS;
-    data->channels[ MAX_CHANNELS ].src_offset = 0;
-    int rv = tremor_ov_open_callbacks( (void*)data, &vf, 0, 0, data->vc );
-    if( rv == 0 )
+    vplayer_stream s;
+    SMEM_CLEAR_STRUCT( s );
+    if( vplayer_stream_open( data, &s ) == 0 )
     {
-	tremor_vorbis_info* vi = tremor_ov_info( &vf, -1 );
+	tremor_vorbis_info* vi = tremor_ov_info( &s.vf, -1 );
 	base_freq = vi->rate;
-	tremor_ov_clear( &vf );
+	tremor_ov_clear( &s.vf );
     }
     int dist = 10000000;
     int pitch = 0;
@@ -170,9 +705,16 @@ uint64_t vplayer_get_pcm_time( int mod_num, psynth_net* pnet )
     if( !data->src && !data->src_file ) return -1;
     for( int c = 0; c < data->ctl_channels; c++ ) 
     {
-	if( data->channels[ c ].playing )
+	gen_channel* chan = &data->channels[ c ];
+	if( chan->playing )
 	{
-	    return tremor_ov_pcm_tell( &data->channels[ c ].vf );
+	    if( chan->pf )
+	    {
+		uint64_t t = chan->pf_start + chan->pf_pos;
+		if( data->src_pcm_total ) t %= data->src_pcm_total;
+		return t;
+	    }
+	    return tremor_ov_pcm_tell( &chan->s.vf );
 	}
     }
     return -1;
@@ -185,14 +727,12 @@ uint64_t vplayer_get_total_pcm_time( int mod_num, psynth_net* pnet )
     if( ( mod->flags & PSYNTH_FLAG_EXISTS ) == 0 ) return 0;
     MODULE_DATA* data = (MODULE_DATA*)mod->data_ptr;
     if( !data->src && !data->src_file ) return 0;
-    OggVorbis_File vf;
-    data->cur_chan = MAX_CHANNELS;
-    data->channels[ MAX_CHANNELS ].src_offset = 0;
-    int rv = tremor_ov_open_callbacks( (void*)data, &vf, 0, 0, data->vc );
-    if( rv == 0 )
-    {
-	uint64_t t = tremor_ov_pcm_total( &vf, -1 );
-	tremor_ov_clear( &vf );
+    vplayer_stream s;
+    SMEM_CLEAR_STRUCT( s );
+    if( vplayer_stream_open( data, &s ) == 0 )
+    {
+	uint64_t t = tremor_ov_pcm_total( &s.vf, -1 );
+	tremor_ov_clear( &s.vf );
 	return t;
     }
     return 0;
@@ -207,13 +747,26 @@ void vplayer_set_pcm_time( int mod_num, uint64_t t, psynth_net* pnet )
     if( !data->src && !data->src_file ) return;
     for( int c = 0; c < data->ctl_channels; c++ ) 
     {
-	if( data->channels[ c ].playing )
+	gen_channel* chan = &data->channels[ c ];
+	if( chan->playing )
 	{
-	    tremor_ov_pcm_seek( &data->channels[ c ].vf, t );
+	    if( chan->pf )
+		vplayer_pf_request( data, chan, t );
+	    else
+		tremor_ov_pcm_seek( &chan->s.vf, t );
 	    break;
 	}
     }
 }
+uint vplayer_get_underruns( int mod_num, psynth_net* pnet )
+{
+    if( !pnet ) return 0;
+    if( (unsigned)mod_num >= pnet->mods_num ) return 0;
+    psynth_module* mod = &pnet->mods[ mod_num ];
+    if( ( mod->flags & PSYNTH_FLAG_EXISTS ) == 0 ) return 0;
+    MODULE_DATA* data = (MODULE_DATA*)mod->data_ptr;
+    return atomic_load( &data->pf_underruns );
+}
 int vplayer_load_file( int mod_num, const char* filename, sfs_file f, psynth_net* pnet )
 {
     if( !pnet ) return -1;
@@ -250,13 +803,13 @@ int vplayer_load_file( int mod_num, const char* filename, sfs_file f, psynth_net
     	    break;
 	}
 	locked = 1;
+	vplayer_pf_stop( data );
         for( int c = 0; c <= MAX_CHANNELS; c++ ) 
 	{
-	    if( data->channels[ c ].vf_open )
+	    if( data->channels[ c ].s.vf_open )
     	    {
-		data->cur_chan = c;
-		tremor_ov_clear( &data->channels[ c ].vf );
-		data->channels[ c ].vf_open = 0;
+		tremor_ov_clear( &data->channels[ c ].s.vf );
+		data->channels[ c ].s.vf_open = 0;
 		data->channels[ c ].playing = 0;
 		data->channels[ c ].id = ~0;
 	    }
@@ -270,6 +823,7 @@ int vplayer_load_file( int mod_num, const char* filename, sfs_file f, psynth_net
         sfs_read( src, 1, fsize, f );
         data->src_pcm_total = vplayer_get_total_pcm_time( mod_num, pnet );
 	vplayer_set_base_note( 5 * 12, mod_num, pnet );
+	vplayer_pf_start( data, pnet );
         mod->draw_request++;
 	pnet->change_counter++;
 	rv = 0;
@@ -365,91 +919,6 @@ int vplayer_visual_handler( sundog_event* evt, window_manager* wm )
     return retval;
 }
 #endif
-size_t vplayer_read( void* ptr, size_t s, size_t nmemb, void* datasource )
-{
-    MODULE_DATA* data = (MODULE_DATA*)datasource;
-    gen_channel* chan = &data->channels[ data->cur_chan ];
-    if( data->src )
-    {
-	if( chan->src_offset >= data->src_size ) return 0;
-	size_t size = s * nmemb;
-	size_t can_read = data->src_size - chan->src_offset;
-	if( can_read < size ) size = can_read;
-	smem_copy( ptr, (char*)data->src + chan->src_offset, size );
-	chan->src_offset += size;
-	return size;
-    }
-    if( data->src_file )
-    {
-	if( chan->f == 0 )
-	{
-	    chan->f = sfs_open( data->src_file, "rb" );
-	    if( chan->f == 0 ) return 0;
-	}
-	return sfs_read( ptr, 1, s * nmemb, chan->f );
-    }
-    return 0;
-}
-int vplayer_seek( void* datasource, ogg_int64_t offset, int whence )
-{
-    MODULE_DATA* data = (MODULE_DATA*)datasource;
-    gen_channel* chan = &data->channels[ data->cur_chan ];
-    if( data->src )
-    {
-	switch( whence )
-	{
-	    case 0: chan->src_offset = offset; break;
-	    case 1: chan->src_offset += offset; break;
-	    case 2: chan->src_offset = data->src_size + offset; break;
-	}
-	if( chan->src_offset >= data->src_size ) return -1;
-	return 0;
-    }
-    if( data->src_file )
-    {
-	if( chan->f )
-	{
-	    return sfs_seek( chan->f, offset, whence );
-	}
-    }
-    return 0;
-}
-int vplayer_close( void* datasource )
-{
-    MODULE_DATA* data = (MODULE_DATA*)datasource;
-    gen_channel* chan = &data->channels[ data->cur_chan ];
-    if( data->src )
-    {
-	chan->src_offset = 0;
-	return 0;
-    }
-    if( data->src_file )
-    {
-	if( chan->f )
-	{
-	    sfs_close( chan->f );
-	    chan->f = 0;
-	}
-    }
-    return 0;
-}
-long vplayer_tell( void* datasource )
-{
-    MODULE_DATA* data = (MODULE_DATA*)datasource;
-    gen_channel* chan = &data->channels[ data->cur_chan ];
-    if( data->src )
-    {
-	return chan->src_offset;
-    }
-    if( data->src_file )
-    {
-	if( chan->f )
-	{
-	    return sfs_tell( chan->f );
-	}
-    }
-    return 0;
-}
 PS_RETTYPE MODULE_HANDLER( 
     PSYNTH_MODULE_HANDLER_PARAMETERS
     )
@@ -504,12 +973,14 @@ PS_RETTYPE MODULE_HANDLER(
 	    psynth_register_ctl( mod_num, ps_get_string( STR_PS_IGNORE_NOTEOFF ), ps_get_string( STR_PS_OFF_ON ), 0, 1, 0, 1, &data->ctl_ignore_noteoff, -1, 1, pnet );
 	    for( int c = 0; c <= MAX_CHANNELS; c++ )
 	    {
-		data->channels[ c ].vf_open = 0;
+		data->channels[ c ].s.vf_open = 0;
 		data->channels[ c ].playing = 0;
 		data->channels[ c ].id = ~0;
-		data->channels[ c ].src_offset = 0;
+		data->channels[ c ].s.src_offset = 0;
 		data->channels[ c ].loaded = 0;
-		data->channels[ c ].f = 0;
+		data->channels[ c ].s.f = 0;
+		data->channels[ c ].pf = 0;
+		data->channels[ c ].pf_slot = -1;
 	    }
 	    data->no_active_channels = 1;
 	    data->search_ptr = 0;
@@ -522,6 +993,13 @@ PS_RETTYPE MODULE_HANDLER(
 	    data->src_file = 0;
 	    data->src_pcm_total = 0;
 	    data->pause = 0;
+	    data->pf = sconfig_get_int_value( "vplayer_prefetch", 0, 0 ) != 0;
+	    {
+		sunvox_engine* sv = (sunvox_engine*)pnet->host;
+		if( sv && ( sv->flags & SUNVOX_FLAG_EXPORT ) ) data->pf = 0; 
+	    }
+	    data->pf_active = 0;
+	    atomic_init( &data->pf_underruns, 0 );
 #ifdef SUNVOX_GUI
 	    {
 		data->wm = 0;
@@ -543,12 +1021,14 @@ PS_RETTYPE MODULE_HANDLER(
 	    break;
 	case PS_CMD_SETUP_FINISHED:
 	    {
+		psynth_share_chunk( mod_num, 0, pnet );
 		data->src = psynth_get_chunk_data( mod_num, 0, pnet );
 		size_t size = 0;
 		psynth_get_chunk_info( mod_num, 0, pnet, &size, 0, 0 );
 		data->src_size = size;
 		data->src_pcm_total = vplayer_get_total_pcm_time( mod_num, pnet );
 		vplayer_get_base_pitch( mod_num, pnet );
+		vplayer_pf_start( data, pnet );
 	    }
 	    retval = 1;
 	    break;
@@ -562,7 +1042,6 @@ PS_RETTYPE MODULE_HANDLER(
 		{
 		    gen_channel* chan = &data->channels[ c ];
 		    if( !chan->playing ) continue;
-		    data->cur_chan = c;
 		    data->no_active_channels = 0;
 		    int offset = mod->offset;
 		    int frames = mod->frames;
@@ -596,12 +1075,15 @@ PS_RETTYPE MODULE_HANDLER(
 			    uint bytes_to_read = PCMBUF_BYTES - 8; 
 			    int pcm_offset = ( chan->loaded * chan->vi->channels * sizeof( int16_t ) ) & ( PCMBUF_BYTES - 1 );
 			    int current_section;
-			    read_rv = tremor_ov_read( &chan->vf, main_pcmbuf, bytes_to_read, &current_section );
+			    if( chan->pf )
+				read_rv = vplayer_pf_read( data, chan, main_pcmbuf, bytes_to_read );
+			    else
+				read_rv = tremor_ov_read( &chan->s.vf, main_pcmbuf, bytes_to_read, &current_section );
 			    if( read_rv <= 0 )
 			    {
-				if( read_rv == 0 && data->ctl_loop )
+				if( read_rv == 0 && data->ctl_loop && !chan->pf )
 				{
-				    tremor_ov_time_seek( &chan->vf, 0 );
+				    tremor_ov_time_seek( &chan->s.vf, 0 );
 				}
 				else
 				{
@@ -824,17 +1306,26 @@ PS_RETTYPE MODULE_HANDLER(
 		    data->search_ptr = 0;
 		}
 		c = data->search_ptr;
-		data->cur_chan = c;
 		gen_channel* chan = &data->channels[ c ];
-		chan->src_offset = 0;
 		int rv = 0;
-		if( chan->vf_open == 0 )
+		if( data->pf_active )
 		{
-		    rv = tremor_ov_open_callbacks( (void*)data, &chan->vf, 0, 0, data->vc );
+		    vplayer_pf_request( data, chan, 0 );
+		    chan->vi = &data->pf_vi;
 		}
-		else 
+		else
 		{
-		    tremor_ov_time_seek( &chan->vf, 0 );
+		    chan->pf = 0;
+		    chan->s.src_offset = 0;
+		    if( chan->s.vf_open == 0 )
+		    {
+			rv = vplayer_stream_open( data, &chan->s );
+			if( rv == 0 ) chan->vi = tremor_ov_info( &chan->s.vf, -1 );
+		    }
+		    else 
+		    {
+			tremor_ov_time_seek( &chan->s.vf, 0 );
+		    }
 		}
 		if( rv == 0 )
 		{
@@ -850,12 +1341,7 @@ PS_RETTYPE MODULE_HANDLER(
 		    chan->delta_l = delta_l;
 		    chan->ptr_h = 0;
 		    chan->ptr_l = 0;
-		    if( chan->vf_open == 0 )
-		    {
-			chan->vi = tremor_ov_info( &chan->vf, -1 );
-		    }
 		    chan->loaded = 0;
-		    chan->vf_open = 1;
 		    data->no_active_channels = 0;
 		}
 		retval = 1;
@@ -900,7 +1386,7 @@ PS_RETTYPE MODULE_HANDLER(
                 if( data->channels[ c ].id == event->id )
                 {
             	    gen_channel* chan = &data->channels[ c ];
-            	    if( chan->vf_open == 0 ) break;
+            	    if( chan->s.vf_open == 0 && !chan->pf ) break;
                     uint64_t new_offset;
                     if( event->command == PS_CMD_SET_SAMPLE_OFFSET )
                     {
@@ -914,7 +1400,10 @@ PS_RETTYPE MODULE_HANDLER(
                     }
                     if( new_offset >= data->src_pcm_total )
                         new_offset = data->src_pcm_total - 1;
-            	    tremor_ov_pcm_seek( &chan->vf, new_offset );
+            	    if( chan->pf )
+            		vplayer_pf_request( data, chan, new_offset );
+            	    else
+            		tremor_ov_pcm_seek( &chan->s.vf, new_offset );
                     retval = 1;
                     break;
                 }
@@ -960,13 +1449,13 @@ PS_RETTYPE MODULE_HANDLER(
 	    retval = 1;
 	    break;
 	case PS_CMD_CLOSE:
+	    vplayer_pf_stop( data );
 	    for( int c = 0; c <= MAX_CHANNELS; c++ )
 	    {
-		if( data->channels[ c ].vf_open )
+		if( data->channels[ c ].s.vf_open )
 		{
-		    data->cur_chan = c;
-		    tremor_ov_clear( &data->channels[ c ].vf );
-		    data->channels[ c ].vf_open = 0;
+		    tremor_ov_clear( &data->channels[ c ].s.vf );
+		    data->channels[ c ].s.vf_open = 0;
 		}
 	    }
 #ifdef SUNVOX_GUI
@@ -223,6 +223,8 @@ void sunvox_engine_init(
     s->tgrid = 4;
     s->tgrid2 = 4;
     s->pat_id_counter = stime_ms() + ( pseudo_random() << 16 );
+    smutex_init( &s->time_map_mutex, 0 );
+    s->time_map_changed = true;
     char proj_name[ 128 ];
     sprintf( proj_name, "%d-%02d-%02d %02d-%02d", stime_year(), stime_month(), stime_day(), stime_hours(), stime_minutes() );
     s->proj_name = SMEM_ALLOC2( char, smem_strlen( proj_name ) + 1 );
@@ -270,9 +272,19 @@ void sunvox_engine_init(
     s->xoffset = 0;
     s->yoffset = 0;
     if( flags & SUNVOX_FLAG_MAIN )
+    {
 	s->user_commands = sring_buf_new( sizeof( sunvox_user_cmd ) * MAX_USER_COMMANDS, 0 ); 
+	s->timed_events = SMEM_ZALLOC2( sunvox_timed_cell, MAX_TIMED_EVENTS );
+	s->timed_pending = SMEM_ALLOC2( sunvox_timed_event, MAX_TIMED_EVENTS );
+    }
     else
+    {
 	s->user_commands = sring_buf_new( sizeof( sunvox_user_cmd ) * MAX_USER_COMMANDS_FOR_METAMODULE, 0 );
+	s->psynth_events = SMEM_ALLOC2( sunvox_psynth_event, MAX_PSYNTH_EVENTS );
+    }
+    ssemaphore_create( &s->user_commands_sem, NULL, 0, 0 );
+    atomic_init( &s->user_commands_sent, 1 ); //see SUNVOX_USER_CMD_ID_MASK
+    atomic_init( &s->user_commands_done, 1 );
     if( ( s->flags & SUNVOX_FLAG_NO_KBD_EVENTS ) == 0 )
     {
 	s->kbd = SMEM_ZALLOC2( sunvox_kbd_events, 1 );
@@ -370,6 +382,10 @@ void sunvox_engine_close( sunvox_engine* s )
     }
     smem_free( s->pats_info ); s->pats_info = NULL;
     smem_free( s->sorted_pats ); s->sorted_pats = NULL;
+    smem_free( s->sorted_pats_end ); s->sorted_pats_end = NULL;
+    smem_free( s->time_map_points ); s->time_map_points = NULL;
+    smem_free( s->time_map_segs ); s->time_map_segs = NULL;
+    smutex_destroy( &s->time_map_mutex );
     smem_free( s->pat_state ); s->pat_state = NULL;
     if( !( s->flags & SUNVOX_FLAG_NO_GUI ) )
     {
@@ -395,8 +411,12 @@ void sunvox_engine_close( sunvox_engine* s )
     if( !( s->flags & SUNVOX_FLAG_PLAYER_ONLY ) )
     {
     }
+    if( s->psynth_events_overflow ) slog( "%d MetaModule events dropped\n", s->psynth_events_overflow );
     smem_free( s->psynth_events );
     sring_buf_delete( s->user_commands );
+    smem_free( s->timed_events );
+    smem_free( s->timed_pending );
+    ssemaphore_destroy( &s->user_commands_sem );
     sring_buf_delete( s->out_ui_events );
     smem_free( s->kbd );
 #ifndef NOMIDI
@@ -770,8 +790,17 @@ void sunvox_play_stop( sunvox_engine* s )
 	}
     }
 }
-void sunvox_play( int pos, bool jump_to_pos, int pat_num, sunvox_engine* s )
+void sunvox_plan_events( sunvox_engine* s )
 {
+    if( !s->net || !psynth_plan_events_needed( s->net ) ) return;
+    SUNVOX_SOUND_STREAM_CONTROL( s, SUNVOX_STREAM_LOCK );
+    psynth_plan_events( s->net );
+    SUNVOX_SOUND_STREAM_CONTROL( s, SUNVOX_STREAM_UNLOCK );
+}
+static uint sunvox_play2( int pos, bool jump_to_pos, int pat_num, bool wait, sunvox_engine* s )
+{
+    sunvox_plan_events( s );
+    uint id = atomic_load( &s->user_commands_sent );
     if( !( s->flags & SUNVOX_FLAG_NO_GUI ) )
     {
 #ifdef SUNVOX_GUI
@@ -815,7 +844,7 @@ void sunvox_play( int pos, bool jump_to_pos, int pat_num, sunvox_engine* s )
 		cmd.n.ctl_val = pat_num + 1;
 	    }
 	    cmd.n.note = NOTECMD_PLAY;
-	    sunvox_send_user_command( &cmd, s );
+	    id = sunvox_send_user_command( &cmd, s );
 	}
 	if( ( s->flags & SUNVOX_FLAG_ONE_THREAD ) || SUNVOX_SOUND_STREAM_CONTROL( s, SUNVOX_STREAM_IS_SUSPENDED ) )
 	{
@@ -823,13 +852,7 @@ void sunvox_play( int pos, bool jump_to_pos, int pat_num, sunvox_engine* s )
 	}
 	else
 	{
-	    stime_ticks_t timeout = stime_ticks_per_second() / 5;
-	    stime_ticks_t t = stime_ticks();
-	    while( s->playing == 0 ) 
-	    {
-		if( stime_ticks() - t >= timeout ) break;
-		stime_sleep( 5 );   
-	    }
+	    if( wait ) sunvox_wait_user_command( id, 200, s );
 	}
     }
     else
@@ -846,12 +869,21 @@ void sunvox_play( int pos, bool jump_to_pos, int pat_num, sunvox_engine* s )
 		SMEM_CLEAR_STRUCT( cmd );
 	        cmd.t = stime_ticks();
     		cmd.n.note = NOTECMD_PATPLAY_OFF;
-		sunvox_send_user_command( &cmd, s );
+		id = sunvox_send_user_command( &cmd, s );
 	    }
 	}
     }
     s->start_time = stime_ms();
     s->cur_time = s->start_time;
+    return id;
+}
+void sunvox_play( int pos, bool jump_to_pos, int pat_num, sunvox_engine* s )
+{
+    sunvox_play2( pos, jump_to_pos, pat_num, true, s );
+}
+uint sunvox_play_async( int pos, bool jump_to_pos, int pat_num, sunvox_engine* s )
+{
+    return sunvox_play2( pos, jump_to_pos, pat_num, false, s );
 }
 void sunvox_rewind( int pos, int pat_num, sunvox_engine* s )
 {
@@ -861,8 +893,9 @@ void sunvox_rewind( int pos, int pat_num, sunvox_engine* s )
     sunvox_set_position( pos, s );
     if( playing ) sunvox_play( 0, false, pat_num, s );
 }
-static int sunvox_just_stop( sunvox_engine* s )
+static int sunvox_just_stop( sunvox_engine* s, uint* cmd_id = NULL )
 {
+    sunvox_plan_events( s );
     int rv;
     sunvox_user_cmd cmd;
     SMEM_CLEAR_STRUCT( cmd );
@@ -870,20 +903,17 @@ static int sunvox_just_stop( sunvox_engine* s )
     {
 	cmd.t = stime_ticks();
 	cmd.n.note = NOTECMD_STOP;
-	sunvox_send_user_command( &cmd, s );
+	uint id = sunvox_send_user_command( &cmd, s );
 	if( ( s->flags & SUNVOX_FLAG_ONE_THREAD ) || SUNVOX_SOUND_STREAM_CONTROL( s, SUNVOX_STREAM_IS_SUSPENDED ) )
 	{
 	    sunvox_handle_all_commands_UNSAFE( s );
 	}
 	else
         {
-    	    stime_ticks_t timeout = stime_ticks_per_second() / 5;
-    	    stime_ticks_t t = stime_ticks();
-    	    while( s->playing ) 
-    	    {
-        	if( stime_ticks() - t >= timeout ) break;
-		stime_sleep( 5 );  
-	    }
+    	    if( cmd_id ) 
+    		*cmd_id = id; 
+    	    else
+    		sunvox_wait_user_command( id, 200, s );
 	}
 	rv = 0;
     }
@@ -918,6 +948,12 @@ int sunvox_stop( sunvox_engine* s )
     int rv = sunvox_just_stop( s );
     return rv;
 }
+uint sunvox_stop_async( sunvox_engine* s )
+{
+    uint id = atomic_load( &s->user_commands_sent );
+    sunvox_just_stop( s, &id );
+    return id;
+}
 int sunvox_stop_and_cancel_record( sunvox_engine* s )
 {
     int rv = sunvox_just_stop( s );
@@ -16,13 +16,16 @@
     #define MAX_USER_COMMANDS_FOR_METAMODULE	256
     #define MAX_UI_COMMANDS	256
     #define MAX_KBD_EVENTS	256
+    #define MAX_TIMED_EVENTS	512
 #else
     #define MAX_USER_COMMANDS	512
     #define MAX_USER_COMMANDS_FOR_METAMODULE	256
     #define MAX_UI_COMMANDS	512
     #define MAX_KBD_EVENTS	512
+    #define MAX_TIMED_EVENTS	2048
 #endif
 #define MAX_KBD_SLOTS		64
+#define MAX_PSYNTH_EVENTS	256 //events from the parent sound network (MetaModule) per block
 #define REC_BUF_BYTES		(16*1024)
 #define MAX_PATTERN_TRACKS_BITS	5
 #define MAX_PATTERN_TRACKS	32
@@ -370,6 +373,18 @@ struct sunvox_user_cmd
     stime_ticks_t t; //0 = now
 };
 
+struct sunvox_timed_event
+{
+    uint		offset; //frame offset from the beginning of the next sunvox_render_piece_of_sound()
+    sunvox_user_cmd	cmd; //cmd.t is ignored
+};
+
+struct sunvox_timed_cell //cell of the lock-free multi-producer queue
+{
+    std::atomic_uint	seq; //queue position + 1, when the event is ready for reading
+    sunvox_timed_event	evt;
+};
+
 enum sunvox_ui_evt_type //some event from SunVox to UI
 {
     SUNVOX_UI_EVT_KBD, //keyboard event
@@ -488,6 +503,20 @@ typedef int (*tsunvox_sound_stream_control)( sunvox_stream_command cmd, void* us
 
 #define SUPERTRACK_BITARRAY_SIZE	( ( MAX_PLAYING_PATS + 31 ) / 32 )
 
+struct sunvox_time_map_point //BPM/TPL change (pattern effects 0F and 1F)
+{
+    int			line;
+    uint16_t		bpm; //0 - no change
+    uint8_t		tpl; //0 - no change
+};
+
+struct sunvox_time_map_seg //timeline segment (from line 0) with constant speed
+{
+    int			line; //first line
+    uint		frame_add; //frames per line (24.8 fixed point)
+    uint64_t		frame; //first frame (56.8 fixed point)
+};
+
 struct sunvox_engine
 {
     WINDOWPTR		win; //base window (optional);
@@ -549,6 +578,9 @@ struct sunvox_engine
     //For sunvox_sort_patterns() and sunvox_select_current_playing_patterns():
     int*                sorted_pats;
     int	    		sorted_pats_num;
+    int*		sorted_pats_end; //Interval index: binary tree (in array) of the max end lines (X + lines) for sorted_pats[]; leaves: sorted_pats_end[ sorted_pats_end_leaves + i ]
+    int			sorted_pats_end_leaves;
+    bool		sorted_pats_end_changed; //pattern length changed: the index must be rebuilt
     int		    	cur_playing_pats[ MAX_PLAYING_PATS ]; //Current active patterns; pat_num = sorted_pats[ cur_playing_pats[ p ] ]
     int		    	temp_pats[ MAX_PLAYING_PATS ];
     int		    	last_sort_pat; //Number of the last pattern (in sorted table) with X less then the cursor position
@@ -556,6 +588,17 @@ struct sunvox_engine
     int		    	proj_lines; //Project length (number of lines). Calculated in sunvox_sort_patterns()
     uint	    	proj_len; //Project length (in frames). Calculated in play(), play_from_beginning()
 
+    //Time map cache (see sunvox_engine_export.cpp):
+    smutex			time_map_mutex;
+    sunvox_time_map_point*	time_map_points; //sorted by line
+    int				time_map_points_num;
+    bool			time_map_changed; //speed effects, pattern positions or mute/solo flags may have been changed: the points must be rebuilt
+    sunvox_time_map_seg*	time_map_segs; //built from the points for the current BPM/TPL/sample rate
+    int				time_map_segs_num;
+    uint16_t			time_map_segs_bpm;
+    uint8_t			time_map_segs_tpl;
+    int				time_map_segs_freq;
+
     //Handling events from the patterns:
     sunvox_pattern_state*	pat_state; //[ MAX_PLAYING_PATS ];
     int				pat_state_size; //pat_state[] capacity (maximum number of simultaneously playing patterns)
@@ -596,6 +639,18 @@ struct sunvox_engine
     // -> out_ui_events buffer for futher handling by UI:
     //(some events may be recorded)
     sring_buf*			user_commands; //sunvox_user_cmd 
+    std::atomic_uint		user_commands_sent; //ID of the last command sent; ( ID & SUNVOX_USER_CMD_ID_MASK ) is never 0
+    std::atomic_uint		user_commands_done; //ID of the last command handled by the engine
+    std::atomic_int		user_commands_waiters;
+    ssemaphore			user_commands_sem; //released (for each waiter) when the engine handles the commands
+
+    //Timed events (sunvox_send_timed_events()); SUNVOX_FLAG_MAIN only:
+    sunvox_timed_cell*		timed_events; //MAX_TIMED_EVENTS; written by any thread, read by the audio thread
+    std::atomic_uint		timed_events_wp;
+    std::atomic_uint		timed_events_rp;
+    sunvox_timed_event*		timed_pending; //MAX_TIMED_EVENTS; audio thread only: events taken from the queue, sorted by offset
+    uint			timed_pending_num;
+    uint			timed_pending_rp;
 
     //    Notes from the external keyboards (UI THREAD: PC, ribbon/theremin, ...) ->
     // -> sunvox_send_kbd_event() ->
@@ -619,8 +674,9 @@ struct sunvox_engine
 
     sring_buf*			out_ui_events; //(sunvox_ui_evt) output for UI
 
-    sunvox_psynth_event*	psynth_events; //Pack of events from another sound network. Used by MetaModule
+    sunvox_psynth_event*	psynth_events; //Pack of events from another sound network. Used by MetaModule. Preallocated in sunvox_engine_init()
     uint			psynth_events_count;
+    uint			psynth_events_overflow; //number of dropped events
     int				pitch_offset; //Global pitch offset
     int				velocity; //Global velocity (0..256)
 
@@ -670,15 +726,17 @@ struct sunvox_render_data
 {
     sound_buffer_type	in_type;
     void*		in_buffer;
+    void**		in_planar; //per-channel input buffers (float32 or float64) instead of in_buffer
     int			in_channels;
     sound_buffer_type	buffer_type;
     void*		buffer;
+    void**		planar; //per-channel output buffers (float32 or float64) instead of buffer
     int			frames;
     int			channels;
     int			out_latency; //desired output latency (frames); see description in sundog_sound (sound.h)
     int			out_latency2; //actual output latency (frames); see description in sundog_sound (sound.h)
     stime_ticks_t		out_time; //output time; see description in sundog_sound (sound.h)
-    sfs_sound_encoder_data**	out_file_encoders;
+    sfs_sound_encoder_data**	out_file_encoders; //per-module encoders (fed from buffer); not supported with planar output
     bool		silence;
 };
 
@@ -944,11 +1002,14 @@ struct sunvox_time_map_item
     uint8_t     tpl;
 };
 
-uint sunvox_get_time_map( sunvox_time_map_item* map, uint32_t* frame_map, int start_line, int len, sunvox_engine* s );
+uint sunvox_get_time_map( sunvox_time_map_item* map, uint32_t* frame_map, int start_line, int len, sunvox_engine* s ); //map can be NULL
 int sunvox_get_proj_lines( sunvox_engine* s );
 //start_line, line_cnt - timeline segment specified in lines;
 //zero line_cnt = whole project;
 uint32_t sunvox_get_proj_frames( int start_line, int line_cnt, sunvox_engine* s ); //get project length in frames
+//Line <-> frame conversion (from line 0); O(log n), where n = number of BPM/TPL changes:
+uint32_t sunvox_get_frame_by_line( int line, sunvox_engine* s );
+int sunvox_get_line_by_frame( uint32_t frame, sunvox_engine* s ); //line number in the 27.5 fixed point format
 int sunvox_export_to_wav(
     const char* name,
     sound_buffer_type buf_type,
@@ -969,6 +1030,8 @@ void sunvox_export_to_midi( const char* name, sunvox_engine* s );
 void sunvox_sort_patterns( sunvox_engine* s );
 int sunvox_get_mpp( sunvox_engine* s ); //Get the maximum number of simultaneously playing patterns
 void sunvox_select_current_playing_patterns( int first_sorted_pat, sunvox_engine* s );
+int sunvox_get_first_sorted_pat( int line, sunvox_engine* s ); //Get the first pattern (number in sorted_pats[]) with X >= line; O(log n)
+int sunvox_get_sorted_pats_at( int line, int first_sorted_pat, int* rv, int rv_size, sunvox_engine* s ); //Get the patterns (numbers in sorted_pats[], in ascending order) playing at the specified line; O(k log n)
 
 int sunvox_get_free_pattern_num( sunvox_engine* s );
 void sunvox_icon_generator( uint16_t* icon, uint icon_seed );
@@ -1020,7 +1083,12 @@ void sunvox_play_stop( sunvox_engine* s );
 void sunvox_play( int pos, bool jump_to_pos, int pat_num, sunvox_engine* s );
 void sunvox_rewind( int pos, int pat_num, sunvox_engine* s );
 int sunvox_stop( sunvox_engine* s );
+//Same as sunvox_play() and sunvox_stop(), but without waiting for the audio thread; retval = command ID for sunvox_wait_user_command() or 0 if the command buffer is full:
+uint sunvox_play_async( int pos, bool jump_to_pos, int pat_num, sunvox_engine* s );
+uint sunvox_stop_async( sunvox_engine* s );
 int sunvox_stop_and_cancel_record( sunvox_engine* s );
+//Grow the module event arrays if some events were dropped (psynth_plan_events()); non-audio threads only:
+void sunvox_plan_events( sunvox_engine* s );
 
 //Recording:
 
@@ -1033,7 +1101,18 @@ void sunvox_record( sunvox_engine* s );
 
 //Audio callback:
 
-void sunvox_send_user_command( sunvox_user_cmd* cmd, sunvox_engine* s ); //Stop/Play/TPL/BPM/Ctl/...; some events may be recorded; for kbd use send_kbd_event!
+#define SUNVOX_USER_CMD_ID_MASK 0x7FFFFFFF //IDs are passed to the API as 31-bit numbers, where 0 = error
+uint sunvox_send_user_command( sunvox_user_cmd* cmd, sunvox_engine* s ); //Stop/Play/TPL/BPM/Ctl/...; some events may be recorded; for kbd use send_kbd_event!; retval = command ID or 0 if the command buffer is full
+//Wait until the engine handles the command (and all the commands sent before it);
+//timeout in ms: 0 - don't wait (just check); STHREAD_TIMEOUT_INFINITE; retval: true if handled; id 0 (not sent) is always handled;
+bool sunvox_wait_user_command( uint id, int timeout, sunvox_engine* s );
+//Lock-free; can be called from any number of threads;
+//events are handled in the order of their offsets (events with the same offset - in the order of sending);
+//retval = number of events queued (the first N); the rest don't fit in the queue and should be sent later;
+int sunvox_send_timed_events( sunvox_timed_event* evts, int num, sunvox_engine* s );
+//Move the unhandled user commands and timed events from src to the new (empty) engine dest, keeping the command IDs;
+//the audio thread must not use these engines; the event offsets are converted from src->freq to dest->freq:
+void sunvox_move_queued_commands_UNSAFE( sunvox_engine* dest, sunvox_engine* src );
 void sunvox_send_kbd_event( sunvox_kbd_event* evt, sunvox_engine* s ); //Call this in the main UI thread only!
 void sunvox_add_psynth_event_UNSAFE( int mod_num, psynth_event* evt, sunvox_engine* s );
 void sunvox_handle_all_commands_UNSAFE( sunvox_engine* s ); //For the single-threaded mode only!
@@ -28,11 +28,139 @@ IN THE SOFTWARE.
 
 #include "sundog.h"
 #include "sunvox_engine.h"
-void sunvox_send_user_command( sunvox_user_cmd* cmd, sunvox_engine* s ) 
+uint sunvox_send_user_command( sunvox_user_cmd* cmd, sunvox_engine* s ) 
 {
+    uint id = 0;
     sring_buf_write_lock( s->user_commands );
-    sring_buf_write( s->user_commands, cmd, sizeof( sunvox_user_cmd ) );
+    uint n = 1;
+    sunvox_user_cmd cmds[ 2 ];
+    if( ( ( atomic_load( &s->user_commands_sent ) + 1 ) & SUNVOX_USER_CMD_ID_MASK ) == 0 )
+    {
+	//This ID can't be given to the caller: spend it on a dummy command (ignored by the engine):
+	SMEM_CLEAR_STRUCT( cmds[ 0 ] );
+	cmds[ 0 ].ch = 255;
+	n = 2;
+    }
+    cmds[ n - 1 ] = *cmd;
+    if( sring_buf_write( s->user_commands, &cmds, sizeof( sunvox_user_cmd ) * n ) == sizeof( sunvox_user_cmd ) * n )
+	id = atomic_fetch_add( &s->user_commands_sent, n ) + n;
     sring_buf_write_unlock( s->user_commands );
+    return id;
+}
+static void sunvox_user_commands_unregister( sunvox_engine* s )
+{
+    //The engine resets the waiters counter and releases the semaphore once per waiter.
+    //If it has already counted this waiter, take the release that belongs to it (it may not be sent yet):
+    int n = atomic_load( &s->user_commands_waiters );
+    while( n > 0 )
+    {
+	if( atomic_compare_exchange_weak( &s->user_commands_waiters, &n, n - 1 ) ) return;
+    }
+    ssemaphore_wait( &s->user_commands_sem, STHREAD_TIMEOUT_INFINITE );
+}
+bool sunvox_wait_user_command( uint id, int timeout, sunvox_engine* s )
+{
+    if( id == 0 ) return true; //nothing to wait for (the command was not sent)
+    if( (int)( atomic_load( &s->user_commands_done ) - id ) >= 0 ) return true;
+    if( timeout == 0 ) return false;
+    stime_ticks_t t = stime_ticks();
+    while( 1 )
+    {
+	int t2 = timeout;
+	if( timeout != STHREAD_TIMEOUT_INFINITE )
+	{
+	    t2 = timeout - (int)( ( (uint64_t)( stime_ticks() - t ) * 1000 ) / stime_ticks_per_second() );
+	    if( t2 <= 0 ) return false;
+	}
+	atomic_fetch_add( &s->user_commands_waiters, 1 );
+	if( (int)( atomic_load( &s->user_commands_done ) - id ) >= 0 )
+	{
+	    sunvox_user_commands_unregister( s );
+	    return true;
+	}
+	if( ssemaphore_wait( &s->user_commands_sem, t2 ) != 0 )
+	    sunvox_user_commands_unregister( s );
+	if( (int)( atomic_load( &s->user_commands_done ) - id ) >= 0 ) return true;
+    }
+}
+int sunvox_send_timed_events( sunvox_timed_event* evts, int num, sunvox_engine* s )
+{
+    if( !s->timed_events ) return 0;
+    if( num <= 0 ) return 0;
+    //Reserve N cells with a single CAS:
+    uint wp = atomic_load_explicit( &s->timed_events_wp, std::memory_order_relaxed );
+    int n;
+    while( 1 )
+    {
+	uint rp = atomic_load_explicit( &s->timed_events_rp, std::memory_order_acquire );
+	n = MAX_TIMED_EVENTS - (int)( wp - rp );
+	if( n > num ) n = num;
+	if( n <= 0 ) return 0; //queue is full
+	if( atomic_compare_exchange_weak_explicit( &s->timed_events_wp, &wp, wp + n, std::memory_order_relaxed, std::memory_order_relaxed ) ) break;
+    }
+    //Fill and publish:
+    for( int i = 0; i < n; i++ )
+    {
+	sunvox_timed_cell* c = &s->timed_events[ ( wp + i ) & ( MAX_TIMED_EVENTS - 1 ) ];
+	c->evt = evts[ i ];
+	atomic_store_explicit( &c->seq, wp + i + 1, std::memory_order_release );
+    }
+    return n;
+}
+//Audio thread: move the published events from the queue to the timed_pending list (sorted by offset)
+static void sunvox_fetch_timed_events( sunvox_engine* s )
+{
+    uint rp = atomic_load_explicit( &s->timed_events_rp, std::memory_order_relaxed );
+    uint rp_start = rp;
+    sunvox_timed_event* pending = s->timed_pending;
+    uint num = s->timed_pending_num;
+    while( num < MAX_TIMED_EVENTS )
+    {
+	sunvox_timed_cell* c = &s->timed_events[ rp & ( MAX_TIMED_EVENTS - 1 ) ];
+	if( atomic_load_explicit( &c->seq, std::memory_order_acquire ) != rp + 1 ) break;
+	uint offset = c->evt.offset;
+	uint i = num;
+	while( i > 0 && pending[ i - 1 ].offset > offset ) i--;
+	if( i < num ) smem_copy( &pending[ i + 1 ], &pending[ i ], ( num - i ) * sizeof( sunvox_timed_event ) );
+	pending[ i ] = c->evt;
+	num++;
+	rp++;
+    }
+    s->timed_pending_num = num;
+    if( rp != rp_start ) atomic_store_explicit( &s->timed_events_rp, rp, std::memory_order_release );
+}
+void sunvox_move_queued_commands_UNSAFE( sunvox_engine* dest, sunvox_engine* src )
+{
+    uint moved = 0;
+    sunvox_user_cmd cmd;
+    sring_buf_read_lock( src->user_commands );
+    sring_buf_write_lock( dest->user_commands );
+    while( sring_buf_read( src->user_commands, &cmd, sizeof( cmd ) ) == sizeof( cmd ) )
+    {
+	if( sring_buf_write( dest->user_commands, &cmd, sizeof( cmd ) ) != sizeof( cmd ) ) break;
+	sring_buf_next( src->user_commands, sizeof( cmd ) );
+	moved++;
+    }
+    sring_buf_write_unlock( dest->user_commands );
+    sring_buf_read_unlock( src->user_commands );
+    uint sent = atomic_load( &src->user_commands_sent );
+    atomic_store( &dest->user_commands_sent, sent );
+    atomic_store( &dest->user_commands_done, sent - moved ); //the commands that didn't fit are dropped (handled)
+    if( src->timed_events && dest->timed_events )
+    {
+	sunvox_fetch_timed_events( src );
+	uint num = 0;
+	for( uint i = src->timed_pending_rp; i < src->timed_pending_num; i++ )
+	{
+	    sunvox_timed_event* evt = &dest->timed_pending[ num++ ];
+	    *evt = src->timed_pending[ i ];
+	    evt->offset = (uint)( (uint64_t)evt->offset * dest->freq / src->freq );
+	}
+	dest->timed_pending_num = num;
+	dest->timed_pending_rp = 0;
+	src->timed_pending_num = 0;
+	src->timed_pending_rp = 0;
+    }
 }
 static void sunvox_send_ui_event_kbd( sunvox_kbd_event* evt, bool ftrack_first, int ftrack, sunvox_engine* s )
 {
@@ -87,16 +215,15 @@ void sunvox_add_psynth_event_UNSAFE( int mod_num, psynth_event* evt, sunvox_engi
 {
     psynth_module* mod = psynth_get_module( mod_num, s->net );
     if( !mod ) return;
-    if( s->psynth_events == NULL )
-	s->psynth_events = SMEM_ALLOC2( sunvox_psynth_event, 16 );
+    if( s->psynth_events_count >= SMEM_GET_SIZE2( s->psynth_events ) )
+    {
+	//No allocations in the audio thread: drop the event
+	s->psynth_events_overflow++;
+	return;
+    }
     s->psynth_events[ s->psynth_events_count ].mod = mod_num;
     smem_copy( &s->psynth_events[ s->psynth_events_count ].evt, evt, sizeof( psynth_event ) );
     s->psynth_events_count++;
-    size_t prev_size = smem_get_size( s->psynth_events ) / sizeof( sunvox_psynth_event );
-    if( s->psynth_events_count >= prev_size )
-    {
-	s->psynth_events = SMEM_RESIZE2( s->psynth_events, sunvox_psynth_event, prev_size + 32 );
-    }
 }
 static uint sunvox_check_speed( int offset, sunvox_engine* s )
 {
@@ -1544,6 +1671,13 @@ void sunvox_handle_all_commands_UNSAFE( sunvox_engine* s )
     sunvox_render_piece_of_sound( &rdata, s );
     s->flags &= ~SUNVOX_FLAG_IGNORE_SLOT_SYNC;
 }
+static inline float sunvox_get_planar_sample( sunvox_render_data* rdata, int ch, int i )
+{
+    void* buf = rdata->planar[ ch ];
+    if( !buf ) return 0;
+    if( rdata->buffer_type == sound_buffer_float64 ) return (float)( (double*)buf )[ i ];
+    return ( (float*)buf )[ i ];
+}
 uint8_t g_metronome_click[ 16 ] = { 32, 0, 128, 32, 200, 180, 170, 100, 90, 200, 100, 32, 11, 25, 70, 4 };
 static bool sunvox_render_piece_of_sound_level2(
     sunvox_render_data* rdata, 
@@ -2136,8 +2270,34 @@ static bool sunvox_render_piece_of_sound_level2(
 	}
 #endif
 	bool jump_to_start_of_main_loop = 0;
+	if( s->timed_pending_rp < s->timed_pending_num )
+	{
+	    uint pos = s->level1_offset + ptr;
+	    while( s->timed_pending_rp < s->timed_pending_num )
+	    {
+		sunvox_timed_event* evt = &s->timed_pending[ s->timed_pending_rp ];
+		if( evt->offset > pos ) 
+		{
+		    //Split the piece at the next event:
+		    if( size > (int)( evt->offset - pos ) ) size = evt->offset - pos;
+		    break;
+		}
+		s->timed_pending_rp++;
+        	if( evt->cmd.ch < MAX_PATTERN_TRACKS )
+        	{
+        	    sunvox_reset_track_effect( &s->virtual_pat_state.effects[ evt->cmd.ch ] );
+		    sunvox_handle_command( ptr, &evt->cmd.n, s->net, SUNVOX_VIRTUAL_PATTERN, evt->cmd.ch, s );
+		}
+		if( evt->cmd.n.note == NOTECMD_PLAY ) 
+		{
+		    jump_to_start_of_main_loop = 1;
+		    break;
+		}
+	    }
+	}
 	bool buf_locked = 0;
-	while( sring_buf_avail( s->user_commands ) >= sizeof( sunvox_user_cmd ) )
+	uint cmds_handled = 0;
+	while( !jump_to_start_of_main_loop && sring_buf_avail( s->user_commands ) >= sizeof( sunvox_user_cmd ) )
 	{
 	    if( buf_locked == 0 )
 	    {
@@ -2155,6 +2315,7 @@ static bool sunvox_render_piece_of_sound_level2(
 			sunvox_handle_command( ptr, &cmd.n, s->net, SUNVOX_VIRTUAL_PATTERN, cmd.ch, s );
 		    }
 		    sring_buf_next( s->user_commands, sizeof( cmd ) );
+		    cmds_handled++;
 		    if( cmd.n.note == NOTECMD_PLAY ) 
 		    {
 			jump_to_start_of_main_loop = 1;
@@ -2176,6 +2337,12 @@ static bool sunvox_render_piece_of_sound_level2(
     	    buf_locked = 0;
 	    sring_buf_read_unlock( s->user_commands );
 	}
+	if( cmds_handled )
+	{
+	    atomic_fetch_add( &s->user_commands_done, cmds_handled );
+	    for( int i = atomic_exchange( &s->user_commands_waiters, 0 ); i > 0; i-- )
+		ssemaphore_release( &s->user_commands_sem );
+	}
 	if( jump_to_start_of_main_loop ) continue; 
 	if( s->psynth_events )
 	{
@@ -2378,7 +2545,7 @@ static bool sunvox_render_piece_of_sound_level2(
 				    if( next_time < s->line_counter )
 				    {
 					search_again = 1;
-					s->last_sort_pat++;
+					s->last_sort_pat = sunvox_get_first_sorted_pat( s->line_counter, s ) - 1;
 				    }
 				}
 			    }
@@ -2534,7 +2701,10 @@ static bool sunvox_render_piece_of_sound_level2(
 	}
     } 
     if( s->recording ) rv = 1;
-    psynth_render_setup( frames, rdata->out_time + ( (int64_t)s->level1_offset * stime_ticks_per_second() ) / freq, (char*)rdata->in_buffer, rdata->in_type, rdata->in_channels, s->net );
+    if( rdata->in_planar )
+	psynth_render_setup( frames, rdata->out_time + ( (int64_t)s->level1_offset * stime_ticks_per_second() ) / freq, rdata->in_planar, rdata->in_type, rdata->in_channels, true, s->net );
+    else
+	psynth_render_setup( frames, rdata->out_time + ( (int64_t)s->level1_offset * stime_ticks_per_second() ) / freq, (char*)rdata->in_buffer, rdata->in_type, rdata->in_channels, false, s->net );
     psynth_render_all( s->net );
     int mods_num;
     if( rdata->out_file_encoders == nullptr )
@@ -2546,6 +2716,7 @@ static bool sunvox_render_piece_of_sound_level2(
 	mods_num = s->net->mods_num;
     }
     if( !rdata->buffer ) mods_num = 0;
+    if( rdata->planar ) mods_num = 1; //Output module only
     for( int fnum = 0; fnum < mods_num; fnum++ )
     {
 	psynth_module* mod = &s->net->mods[ fnum ];
@@ -2590,7 +2761,33 @@ static bool sunvox_render_piece_of_sound_level2(
 	    }
 	    if( chan == NULL ) continue;
 	    if( chan_empty < frames ) rv = 1;
-	    switch( rdata->buffer_type )
+	    if( rdata->planar )
+	    {
+		void* output = rdata->planar[ ch ];
+		if( output && rdata->buffer_type == sound_buffer_float64 )
+		{
+		    double* out = (double*)output;
+		    for( int i = 0; i < frames; i++ )
+		    {
+			float result;
+			PS_STYPE_TO_FLOAT( result, chan[ i ] );
+			out[ i ] = result;
+		    }
+		}
+		else if( output )
+		{
+#ifdef PS_STYPE_FLOAT32
+		    smem_copy( output, chan, frames * sizeof( float ) );
+#else
+		    float* out = (float*)output;
+		    for( int i = 0; i < frames; i++ )
+		    {
+			PS_STYPE_TO_FLOAT( out[ i ], chan[ i ] );
+		    }
+#endif
+		}
+	    }
+	    else switch( rdata->buffer_type )
 	    {
 		case sound_buffer_int16:
 		    {
@@ -2639,12 +2836,36 @@ static bool sunvox_render_piece_of_sound_level2(
 		}
 	    }
 	}
-	if( enc )
+	if( enc && rdata->buffer )
 	{
 	    sfs_sound_encoder_write( enc, rdata->buffer, frames );
 	}
     }
-    if( rdata->buffer )
+    if( rdata->planar )
+    {
+	int ptr2 = 0;
+	for( int fp = f_prev_size; fp < f_new_size; fp ++ )
+	{
+	    int val_l = 0;
+	    int val_r = 0;
+	    if( rv )
+	    {
+		val_l = (int)( sunvox_get_planar_sample( rdata, 0, ptr2 >> 8 ) * 32767 );
+		if( channels > 1 )
+		    val_r = (int)( sunvox_get_planar_sample( rdata, 1, ptr2 >> 8 ) * 32767 );
+		else
+		    val_r = val_l;
+		if( val_l < 0 ) val_l = -val_l;
+		if( val_r < 0 ) val_r = -val_r;
+		if( val_l > 32767 ) val_l = 32767;
+		if( val_r > 32767 ) val_r = 32767;
+	    }
+	    s->f_volume_l[ f_off + fp ] = val_l >> 7;
+	    s->f_volume_r[ f_off + fp ] = val_r >> 7;
+	    ptr2 += ptr2_step;
+	}
+    }
+    else if( rdata->buffer )
     {
 	int ptr2 = 0;
 	switch( rdata->buffer_type )
@@ -2711,9 +2932,21 @@ bool sunvox_render_piece_of_sound( sunvox_render_data* rdata, sunvox_engine* s )
     if( !s ) return 0;
     if( !s->net ) return 0;
     if( s->initialized == 0 ) return 0;
+    if( rdata->planar && rdata->out_file_encoders )
+    {
+	//The encoders take the interleaved buffer only
+	slog( "sunvox_render_piece_of_sound(): out_file_encoders can't be used with planar output\n" );
+	return 0;
+    }
     int frames = rdata->frames;
     void* in_buffer = rdata->in_buffer;
     void* buffer = rdata->buffer;
+    void** in_planar = rdata->in_planar;
+    void** planar = rdata->planar;
+    void* in_planar_ptrs[ SUNDOG_SOUND_PLANAR_CHANNELS ];
+    void* planar_ptrs[ SUNDOG_SOUND_PLANAR_CHANNELS ];
+    if( in_planar && rdata->in_channels > SUNDOG_SOUND_PLANAR_CHANNELS ) rdata->in_channels = SUNDOG_SOUND_PLANAR_CHANNELS;
+    if( planar && rdata->channels > SUNDOG_SOUND_PLANAR_CHANNELS ) rdata->channels = SUNDOG_SOUND_PLANAR_CHANNELS;
     stime_ticks_t out_time = rdata->out_time;
     s->f_current_buffer = ( s->f_current_buffer + 1 ) & SUNVOX_VF_BUFS_MASK;
     int f_current_buffer = s->f_current_buffer;
@@ -2723,6 +2956,7 @@ bool sunvox_render_piece_of_sound( sunvox_render_data* rdata, sunvox_engine* s )
     if( s->clipping_counter < 0 ) 
 	s->clipping_counter = 0;
     psynth_render_begin( rdata->out_time, s->net );
+    if( s->timed_events ) sunvox_fetch_timed_events( s );
     int ptr = 0;
     while( 1 )
     {
@@ -2759,6 +2993,26 @@ bool sunvox_render_piece_of_sound( sunvox_render_data* rdata, sunvox_engine* s )
 			break;
 		}
 	    }
+	    if( planar )
+	    {
+		for( int ch = 0; ch < rdata->channels; ch++ )
+		{
+		    int8_t* p = (int8_t*)planar[ ch ];
+		    if( p ) p += ptr * g_sample_size[ rdata->buffer_type ];
+		    planar_ptrs[ ch ] = p;
+		}
+		rdata->planar = planar_ptrs;
+	    }
+	    if( in_planar )
+	    {
+		for( int ch = 0; ch < rdata->in_channels; ch++ )
+		{
+		    int8_t* p = (int8_t*)in_planar[ ch ];
+		    if( p ) p += ptr * g_sample_size[ rdata->in_type ];
+		    in_planar_ptrs[ ch ] = p;
+		}
+		rdata->in_planar = in_planar_ptrs;
+	    }
 	    s->level1_offset = ptr;
 	    if( sunvox_render_piece_of_sound_level2( rdata, f_current_buffer, s ) )
 		rdata->silence = 0;
@@ -2766,7 +3020,25 @@ bool sunvox_render_piece_of_sound( sunvox_render_data* rdata, sunvox_engine* s )
 	ptr += size;
 	if( ptr >= frames ) break;
     }
+    if( s->timed_pending_num )
+    {
+	//Remaining events: offsets are relative to the next callback now
+	sunvox_timed_event* pending = s->timed_pending;
+	uint num = s->timed_pending_num - s->timed_pending_rp;
+	if( s->timed_pending_rp ) smem_copy( pending, pending + s->timed_pending_rp, num * sizeof( sunvox_timed_event ) );
+	for( uint i = 0; i < num; i++ )
+	{
+	    if( pending[ i ].offset > (uint)frames ) 
+		pending[ i ].offset -= frames;
+	    else
+		pending[ i ].offset = 0;
+	}
+	s->timed_pending_num = num;
+	s->timed_pending_rp = 0;
+    }
     psynth_render_end( frames, s->net );
+    rdata->planar = planar;
+    rdata->in_planar = in_planar;
     return 1;
 }
 int sunvox_frames_get_value( int channel, stime_ticks_t t, sunvox_engine* s )
@@ -28,12 +28,52 @@ IN THE SOFTWARE.
 
 #include "sundog.h"
 #include "sunvox_engine.h"
-uint sunvox_get_time_map( sunvox_time_map_item* map, uint32_t* frame_map, int start_line, int len, sunvox_engine* s )
+static void time_map_sort_points( sunvox_time_map_point* p, int num ) //stable
 {
-    if( len <= 0 ) return 0;
-    smem_clear( map, sizeof( sunvox_time_map_item ) * len );
-    map[ 0 ].bpm = s->bpm;
-    map[ 0 ].tpl = s->speed;
+    sunvox_time_map_point* tmp = SMEM_ALLOC2( sunvox_time_map_point, num );
+    if( !tmp )
+    {
+	for( int i = 1; i < num; i++ )
+	{
+	    sunvox_time_map_point v = p[ i ];
+	    int j = i;
+	    for( ; j > 0 && p[ j - 1 ].line > v.line; j-- ) p[ j ] = p[ j - 1 ];
+	    p[ j ] = v;
+	}
+	return;
+    }
+    sunvox_time_map_point* src = p;
+    sunvox_time_map_point* dst = tmp;
+    for( int w = 1; w < num; w *= 2 )
+    {
+	for( int lo = 0; lo < num; lo += w * 2 )
+	{
+	    int mid = lo + w; if( mid > num ) mid = num;
+	    int hi = lo + w * 2; if( hi > num ) hi = num;
+	    int i1 = lo;
+	    int i2 = mid;
+	    int d = lo;
+	    while( i1 < mid && i2 < hi )
+	    {
+		if( src[ i2 ].line < src[ i1 ].line )
+		    dst[ d++ ] = src[ i2++ ];
+		else
+		    dst[ d++ ] = src[ i1++ ];
+	    }
+	    while( i1 < mid ) dst[ d++ ] = src[ i1++ ];
+	    while( i2 < hi ) dst[ d++ ] = src[ i2++ ];
+	}
+	sunvox_time_map_point* t = src; src = dst; dst = t;
+    }
+    if( src != p ) smem_copy( p, src, num * sizeof( sunvox_time_map_point ) );
+    smem_free( tmp );
+}
+static void time_map_update_points( sunvox_engine* s ) //time_map_mutex must be locked
+{
+    if( !s->time_map_changed ) return;
+    s->time_map_changed = false;
+    s->time_map_segs_num = 0;
+    int num = 0;
     for( int p = 0; p < s->pats_num; p++ )
     {
 	sunvox_pattern* pat = s->pats[ p ];
@@ -45,53 +85,173 @@ uint sunvox_get_time_map( sunvox_time_map_item* map, uint32_t* frame_map, int st
         {
             if( !( pat_info->flags & SUNVOX_PATTERN_INFO_FLAG_SOLO ) ) continue;
         }
-	int pat_x = pat_info->x;
-	int pat_lines = pat->lines;
-	CROP_REGION( pat_x, pat_lines, start_line, len );
-	if( pat_lines <= 0 ) continue;
-	int pat_xoffset = pat_x - pat_info->x;
-	int pat_xx = pat_x - start_line;
-	for( int ln = pat_xx, lp = pat_xoffset * pat->data_xsize; ln < pat_xx + pat_lines; ln++, lp += pat->data_xsize )
+	for( int ln = 0, lp = 0; ln < pat->lines; ln++, lp += pat->data_xsize )
 	{
 	    for( int cn = 0, ptr = lp; cn < pat->channels; cn++, ptr++ )
 	    {
 	        sunvox_note* n = &pat->data[ ptr ];
 	        if( ( n->ctl & 0xFF ) == 0x0F || ( n->ctl & 0xFF ) == 0x1F )
 	        {
+		    if( num >= (int)( smem_get_size( s->time_map_points ) / sizeof( sunvox_time_map_point ) ) )
+		    {
+			sunvox_time_map_point* new_points = SMEM_RESIZE2( s->time_map_points, sunvox_time_map_point, num + 64 );
+			if( !new_points ) goto points_done;
+			s->time_map_points = new_points;
+		    }
+		    sunvox_time_map_point* pt = &s->time_map_points[ num++ ];
+		    pt->line = pat_info->x + ln;
+		    pt->bpm = 0;
+		    pt->tpl = 0;
 	            if( ( n->ctl & 0xFF ) == 0x0F && n->ctl_val < 32 )
 	    	    {
 	    		int tpl = n->ctl_val;
 			if( tpl <= 1 ) tpl = 1;
-			map[ ln ].tpl = tpl;
+			pt->tpl = tpl;
 		    }
 		    else
 		    {
 		        int bpm = n->ctl_val;
 		        if( bpm < 1 ) bpm = 1;
 		        if( bpm > 16000 ) bpm = 16000;
-			map[ ln ].bpm = bpm;
+			pt->bpm = bpm;
 		    }
 		}
 	    }
 	}
-    } 
+    }
+points_done:
+    //Merge the changes on the same line (the last one wins, like during the playback):
+    time_map_sort_points( s->time_map_points, num );
+    int num2 = 0;
+    for( int i = 0; i < num; i++ )
+    {
+	sunvox_time_map_point* pt = &s->time_map_points[ i ];
+	if( num2 > 0 )
+	{
+	    sunvox_time_map_point* prev = &s->time_map_points[ num2 - 1 ];
+	    if( prev->line == pt->line )
+	    {
+		if( pt->bpm ) prev->bpm = pt->bpm;
+		if( pt->tpl ) prev->tpl = pt->tpl;
+		continue;
+	    }
+	}
+	s->time_map_points[ num2++ ] = *pt;
+    }
+    s->time_map_points_num = num2;
+}
+static int time_map_find_point( int line, sunvox_engine* s ) //first point with line >= the specified line
+{
+    int lo = 0;
+    int hi = s->time_map_points_num;
+    while( lo < hi )
+    {
+	int mid = ( lo + hi ) / 2;
+	if( s->time_map_points[ mid ].line < line )
+	    lo = mid + 1;
+	else
+	    hi = mid;
+    }
+    return lo;
+}
+static bool time_map_update( sunvox_engine* s ) //time_map_mutex must be locked
+{
+    time_map_update_points( s );
+    int freq = s->net->sampling_freq;
+    if( s->time_map_segs_num &&
+	s->time_map_segs_bpm == s->bpm &&
+	s->time_map_segs_tpl == s->speed &&
+	s->time_map_segs_freq == freq ) return true;
+    int p = time_map_find_point( 0, s );
+    int num = s->time_map_points_num - p + 1;
+    if( num > (int)( smem_get_size( s->time_map_segs ) / sizeof( sunvox_time_map_seg ) ) )
+    {
+	sunvox_time_map_seg* new_segs = SMEM_RESIZE2( s->time_map_segs, sunvox_time_map_seg, num );
+	if( !new_segs ) return false;
+	s->time_map_segs = new_segs;
+    }
+    sunvox_time_map_item v;
+    v.bpm = s->bpm;
+    v.tpl = s->speed;
+    uint64_t frame_cnt = 0;
+    int line = 0;
+    num = 0;
+    while( 1 )
+    {
+	if( p < s->time_map_points_num && s->time_map_points[ p ].line == line )
+	{
+	    sunvox_time_map_point* pt = &s->time_map_points[ p ];
+	    if( pt->bpm ) v.bpm = pt->bpm;
+	    if( pt->tpl ) v.tpl = pt->tpl;
+	    p++;
+	}
+	sunvox_time_map_seg* seg = &s->time_map_segs[ num++ ];
+	seg->line = line;
+	seg->frame = frame_cnt;
+	seg->frame_add = PSYNTH_TICK_SIZE( freq, v.bpm ) * v.tpl;
+	if( p >= s->time_map_points_num ) break;
+	int next_line = s->time_map_points[ p ].line;
+	frame_cnt += (uint64_t)( next_line - line ) * seg->frame_add;
+	line = next_line;
+    }
+    s->time_map_segs_num = num;
+    s->time_map_segs_bpm = s->bpm;
+    s->time_map_segs_tpl = s->speed;
+    s->time_map_segs_freq = freq;
+    return true;
+}
+static int time_map_find_seg( int line, sunvox_engine* s ) //last segment with first line <= the specified line
+{
+    int lo = 0;
+    int hi = s->time_map_segs_num;
+    while( hi - lo > 1 )
+    {
+	int mid = ( lo + hi ) / 2;
+	if( s->time_map_segs[ mid ].line <= line )
+	    lo = mid;
+	else
+	    hi = mid;
+    }
+    return lo;
+}
+static uint64_t time_map_get_frame( int line, sunvox_engine* s ) //56.8 fixed point; time_map_update() must be called before this
+{
+    if( line <= 0 ) return 0;
+    sunvox_time_map_seg* seg = &s->time_map_segs[ time_map_find_seg( line, s ) ];
+    return seg->frame + (uint64_t)( line - seg->line ) * seg->frame_add;
+}
+uint sunvox_get_time_map( sunvox_time_map_item* map, uint32_t* frame_map, int start_line, int len, sunvox_engine* s )
+{
+    if( len <= 0 ) return 0;
+    smutex_lock( &s->time_map_mutex );
+    time_map_update_points( s );
+    int p = time_map_find_point( start_line, s );
     uint64_t frame_cnt = 0;
     uint frame_add = 0;
-    sunvox_time_map_item v = map[ 0 ];
+    sunvox_time_map_item v;
+    v.bpm = s->bpm;
+    v.tpl = s->speed;
     for( int i = 0; i < len; i++ )
     {
-        sunvox_time_map_item v2 = map[ i ];
-        if( v2.bpm || v2.tpl )
+	bool changed = ( i == 0 );
+	if( p < s->time_map_points_num && s->time_map_points[ p ].line == start_line + i )
+	{
+	    sunvox_time_map_point* pt = &s->time_map_points[ p ];
+	    if( pt->bpm ) v.bpm = pt->bpm;
+	    if( pt->tpl ) v.tpl = pt->tpl;
+	    p++;
+	    changed = true;
+	}
+        if( changed )
         {
-    	    if( v2.bpm ) v.bpm = v2.bpm;
-	    if( v2.tpl ) v.tpl = v2.tpl;
 	    uint one_tick = PSYNTH_TICK_SIZE( s->net->sampling_freq, v.bpm );
 	    frame_add = one_tick * v.tpl;
 	}
-	map[ i ] = v;
+	if( map ) map[ i ] = v;
 	if( frame_map ) frame_map[ i ] = frame_cnt >> 8;
 	frame_cnt += frame_add;
     }
+    smutex_unlock( &s->time_map_mutex );
     return frame_cnt >> 8;
 }
 int sunvox_get_proj_lines( sunvox_engine* s )
@@ -117,11 +277,49 @@ uint32_t sunvox_get_proj_frames( int start_line, int line_cnt, sunvox_engine* s
     }
     if( line_cnt <= 0 ) return 0;
     uint32_t frame_cnt = 0;
-    sunvox_time_map_item* map = SMEM_ALLOC2( sunvox_time_map_item, line_cnt );
-    if( map )
+    if( start_line == 0 )
     {
-	frame_cnt = sunvox_get_time_map( map, NULL, start_line, line_cnt, s );
-	smem_free( map );
+	smutex_lock( &s->time_map_mutex );
+	if( time_map_update( s ) )
+	{
+	    frame_cnt = time_map_get_frame( line_cnt, s ) >> 8;
+	    smutex_unlock( &s->time_map_mutex );
+	    return frame_cnt;
+	}
+	smutex_unlock( &s->time_map_mutex );
     }
+    frame_cnt = sunvox_get_time_map( NULL, NULL, start_line, line_cnt, s );
     return frame_cnt;
 }
+uint32_t sunvox_get_frame_by_line( int line, sunvox_engine* s )
+{
+    uint32_t rv = 0;
+    smutex_lock( &s->time_map_mutex );
+    if( time_map_update( s ) ) rv = time_map_get_frame( line, s ) >> 8;
+    smutex_unlock( &s->time_map_mutex );
+    return rv;
+}
+int sunvox_get_line_by_frame( uint32_t frame, sunvox_engine* s )
+{
+    int rv = 0;
+    smutex_lock( &s->time_map_mutex );
+    if( time_map_update( s ) )
+    {
+	uint64_t f = ( (uint64_t)frame << 8 ) | 0xFF; //last fraction of this frame: so that sunvox_get_line_by_frame( sunvox_get_frame_by_line( L ) ) == L
+	int lo = 0;
+	int hi = s->time_map_segs_num;
+	while( hi - lo > 1 )
+	{
+	    int mid = ( lo + hi ) / 2;
+	    if( s->time_map_segs[ mid ].frame <= f )
+		lo = mid;
+	    else
+		hi = mid;
+	}
+	sunvox_time_map_seg* seg = &s->time_map_segs[ lo ];
+	rv = seg->line * 32;
+	if( seg->frame_add ) rv += (int)( ( ( f - seg->frame ) * 32 ) / seg->frame_add );
+    }
+    smutex_unlock( &s->time_map_mutex );
+    return rv;
+}
@@ -131,6 +131,69 @@ static sunvox_note* get_pattern_note( int pat_num, int line, int track, sunvox_e
         if( offset >= 32 ) offset = 31; \
         if( offset != 0 ) n.ctl = ( n.ctl & 0xFF00 ) | ( 0x0040 + offset ); \
     }
+struct sunvox_load_setup_mod
+{
+    int			mod_num;
+    uint32_t		rand_seed; //local pseudo_random() seed: the result doesn't depend on the number of threads and the order of execution
+};
+struct sunvox_load_setup
+{
+    psynth_net*		net;
+    sunvox_load_setup_mod* mods; //modules with PSYNTH_FLAG2_PARALLEL_SETUP
+    int			mods_num;
+    std::atomic_int	next;
+};
+static thread_local bool g_sunvox_load_worker = false; //nested loads (MetaModule) in the worker: no more threads
+static void sunvox_load_setup_work( sunvox_load_setup* ls )
+{
+    while( 1 )
+    {
+	int i = atomic_fetch_add( &ls->next, 1 );
+	if( i >= ls->mods_num ) break;
+	sunvox_load_setup_mod* m = &ls->mods[ i ];
+	uint32_t* prev_seed = set_pseudo_random_local_seed( &m->rand_seed );
+	psynth_do_command( m->mod_num, PS_CMD_SETUP_FINISHED, ls->net );
+	set_pseudo_random_local_seed( prev_seed );
+    }
+}
+static void* sunvox_load_setup_thread( void* user_data )
+{
+    g_sunvox_load_worker = true;
+    sunvox_load_setup_work( (sunvox_load_setup*)user_data );
+    return NULL;
+}
+static void sunvox_load_setup_modules( sunvox_load_setup_mod** mods, int mods_num, psynth_net* net )
+{
+    sunvox_load_setup_mod* m = *mods;
+    if( !m ) return;
+    *mods = NULL;
+    sunvox_load_setup ls;
+    ls.net = net;
+    ls.mods = m;
+    ls.mods_num = mods_num;
+    atomic_init( &ls.next, 0 );
+    int th_num = sconfig_get_int_value( "load_threads", 0, 0 );
+    if( th_num <= 0 ) th_num = sthread_get_cpu_count();
+    if( th_num > mods_num ) th_num = mods_num;
+    if( g_sunvox_load_worker ) th_num = 1;
+    sthread* th = NULL;
+    if( th_num > 1 )
+    {
+	sundog_engine* sd = nullptr; GET_SD_FROM_PSYNTH_NET( net, sd );
+	th = SMEM_ZALLOC2( sthread, th_num - 1 );
+	if( !th ) th_num = 1;
+	for( int i = 0; i < th_num - 1; i++ )
+	    sthread_create( &th[ i ], sd, sunvox_load_setup_thread, &ls, 0 );
+    }
+    bool prev_worker = g_sunvox_load_worker;
+    g_sunvox_load_worker = true;
+    sunvox_load_setup_work( &ls );
+    g_sunvox_load_worker = prev_worker;
+    for( int i = 0; i < th_num - 1; i++ )
+	sthread_destroy( &th[ i ], STHREAD_TIMEOUT_INFINITE );
+    smem_free( th );
+    smem_free( m );
+}
 int sunvox_load_proj_from_fd( sfs_file f, uint load_flags, sunvox_engine* s )
 {
     int rv = 0;
@@ -233,6 +296,8 @@ int sunvox_load_proj_from_fd( sfs_file f, uint load_flags, sunvox_engine* s )
     int* s_links2 = NULL; 
     int** s_links2_list = NULL; 
     int* s_links0 = NULL; 
+    sunvox_load_setup_mod* s_setup = NULL; //deferred PS_CMD_SETUP_FINISHED (parallel)
+    int s_setup_num = 0;
     PS_CTYPE* s_ctls = NULL;
     uint* s_midi_pars = NULL;
     char* s_midi_out_name = NULL;
@@ -1560,7 +1625,23 @@ int sunvox_load_proj_from_fd( sfs_file f, uint load_flags, sunvox_engine* s )
 			    psynth_handle_midi_in_flags( s_num, s->net );
 			    psynth_set_midi_prog( s_num, s_midi_out_bank, s_midi_out_prog, s->net );
 			    psynth_open_midi_out( s_num, s_midi_out_name, s_midi_out_ch, s->net );
-			    psynth_do_command( s_num, PS_CMD_SETUP_FINISHED, s->net );
+			    if( m->flags2 & PSYNTH_FLAG2_PARALLEL_SETUP )
+			    {
+				sunvox_load_setup_mod* new_setup = s_setup;
+				if( (size_t)s_setup_num >= smem_get_size( s_setup ) / sizeof( sunvox_load_setup_mod ) )
+				    new_setup = SMEM_RESIZE2( s_setup, sunvox_load_setup_mod, s_setup_num + 16 );
+				if( new_setup )
+				{
+				    s_setup = new_setup;
+				    s_setup[ s_setup_num ].mod_num = s_num;
+				    s_setup[ s_setup_num ].rand_seed = pseudo_random() | ( pseudo_random() << 15 );
+				    s_setup_num++;
+				}
+				else
+				    psynth_do_command( s_num, PS_CMD_SETUP_FINISHED, s->net );
+			    }
+			    else
+				psynth_do_command( s_num, PS_CMD_SETUP_FINISHED, s->net );
 			}
 		    }
 		    s_links = NULL;
@@ -1586,6 +1667,7 @@ int sunvox_load_proj_from_fd( sfs_file f, uint load_flags, sunvox_engine* s )
 	    } 
 	} 
     }
+    sunvox_load_setup_modules( &s_setup, s_setup_num, s->net );
     if( load_patterns )
     {
 	for( int i = 0; i < s->pats_num; i++ )
@@ -1713,6 +1795,7 @@ int sunvox_load_proj_from_fd( sfs_file f, uint load_flags, sunvox_engine* s )
 	}
     }
 sunvox_proj_load_end:
+    sunvox_load_setup_modules( &s_setup, s_setup_num, s->net );
     sunvox_remove_load_state( st );
 #ifdef DEBUG_MESSAGES
     sunvox_print_patterns( s );
@@ -1730,6 +1813,7 @@ sunvox_proj_load_end:
     }
     smem_free( s_links0 );
     smem_free( s_ctls );
+    s->time_map_changed = true;
     if( load_flags & SUNVOX_PROJ_LOAD_MAKE_TIMELINE_STATIC )
     {
         s->flags &= ~SUNVOX_FLAG_STATIC_TIMELINE;
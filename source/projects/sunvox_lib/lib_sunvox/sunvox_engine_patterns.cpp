@@ -28,6 +28,163 @@ IN THE SOFTWARE.
 
 #include "sundog.h"
 #include "sunvox_engine.h"
+struct sort_pat_key
+{
+    int		x;
+    int		lines;
+    int		n; //pattern number
+};
+static inline bool pat_after( sort_pat_key* k1, sort_pat_key* k2 ) //k1 must be placed after k2
+{
+    if( k1->x != k2->x ) return k1->x > k2->x;
+    if( k1->lines != k2->lines ) return k1->lines > k2->lines;
+    return k1->n > k2->n;
+}
+static void sort_pats( int* pats, int num, sunvox_engine* s ) //by X, then by length, then by number (the result doesn't depend on the previous order)
+{
+    if( num < 2 ) return;
+    sort_pat_key* keys = SMEM_ALLOC2( sort_pat_key, num * 2 );
+    if( !keys )
+    {
+	//Not enough memory for the merge sort:
+	for( int i = 1; i < num; i++ )
+	{
+	    int n = pats[ i ];
+	    sort_pat_key k = { s->pats_info[ n ].x, s->pats[ n ]->lines, n };
+	    int j = i;
+	    for( ; j > 0; j-- )
+	    {
+		int n2 = pats[ j - 1 ];
+		sort_pat_key k2 = { s->pats_info[ n2 ].x, s->pats[ n2 ]->lines, n2 };
+		if( !pat_after( &k2, &k ) ) break;
+		pats[ j ] = n2;
+	    }
+	    pats[ j ] = n;
+	}
+	return;
+    }
+    for( int i = 0; i < num; i++ )
+    {
+	int n = pats[ i ];
+	keys[ i ].x = s->pats_info[ n ].x;
+	keys[ i ].lines = s->pats[ n ]->lines;
+	keys[ i ].n = n;
+    }
+    int i = 1;
+    for( ; i < num; i++ )
+	if( pat_after( &keys[ i - 1 ], &keys[ i ] ) ) break;
+    if( i < num )
+    {
+	sort_pat_key* src = keys;
+	sort_pat_key* dst = keys + num;
+	for( int w = 1; w < num; w *= 2 )
+	{
+	    for( int lo = 0; lo < num; lo += w * 2 )
+	    {
+		int mid = lo + w; if( mid > num ) mid = num;
+		int hi = lo + w * 2; if( hi > num ) hi = num;
+		int a = lo;
+		int b = mid;
+		int d = lo;
+		while( a < mid && b < hi )
+		{
+		    if( pat_after( &src[ a ], &src[ b ] ) )
+			dst[ d++ ] = src[ b++ ];
+		    else
+			dst[ d++ ] = src[ a++ ];
+		}
+		while( a < mid ) dst[ d++ ] = src[ a++ ];
+		while( b < hi ) dst[ d++ ] = src[ b++ ];
+	    }
+	    sort_pat_key* t = src; src = dst; dst = t;
+	}
+	for( i = 0; i < num; i++ ) pats[ i ] = src[ i ].n;
+    }
+    smem_free( keys );
+}
+#define PATS_INDEX_NONE ( -0x7FFFFFFF )
+static void build_pats_index( sunvox_engine* s )
+{
+    s->sorted_pats_end_changed = false;
+    int leaves = 1;
+    while( leaves < s->sorted_pats_num ) leaves *= 2;
+    if( (size_t)leaves * 2 > smem_get_size( s->sorted_pats_end ) / sizeof( int ) )
+    {
+	int* new_index = SMEM_RESIZE2( s->sorted_pats_end, int, leaves * 2 );
+	if( !new_index )
+	{
+	    s->sorted_pats_end_leaves = 0;
+	    return;
+	}
+	s->sorted_pats_end = new_index;
+    }
+    int* t = s->sorted_pats_end;
+    for( int i = 0; i < leaves; i++ )
+    {
+	int end = PATS_INDEX_NONE;
+	if( i < s->sorted_pats_num )
+	{
+	    int n = s->sorted_pats[ i ];
+	    sunvox_pattern* pat = s->pats[ n ];
+	    if( pat ) end = s->pats_info[ n ].x + pat->lines;
+	}
+	t[ leaves + i ] = end;
+    }
+    for( int i = leaves - 1; i >= 1; i-- )
+	t[ i ] = t[ i * 2 ] > t[ i * 2 + 1 ] ? t[ i * 2 ] : t[ i * 2 + 1 ];
+    s->sorted_pats_end_leaves = leaves;
+}
+static int get_pats_from_index( int node, int node_begin, int node_size, int begin, int end, int line, int* rv, int rv_num, int rv_size, sunvox_engine* s )
+{
+    if( rv_num >= rv_size ) return rv_num;
+    if( node_begin >= end || node_begin + node_size <= begin ) return rv_num;
+    if( s->sorted_pats_end[ node ] <= line ) return rv_num;
+    if( node_size == 1 )
+    {
+	rv[ rv_num++ ] = node_begin;
+	return rv_num;
+    }
+    node_size /= 2;
+    rv_num = get_pats_from_index( node * 2, node_begin, node_size, begin, end, line, rv, rv_num, rv_size, s );
+    rv_num = get_pats_from_index( node * 2 + 1, node_begin + node_size, node_size, begin, end, line, rv, rv_num, rv_size, s );
+    return rv_num;
+}
+int sunvox_get_first_sorted_pat( int line, sunvox_engine* s )
+{
+    int lo = 0;
+    int hi = s->sorted_pats_num;
+    while( lo < hi )
+    {
+	int mid = ( lo + hi ) / 2;
+	if( s->pats_info[ s->sorted_pats[ mid ] ].x < line )
+	    lo = mid + 1;
+	else
+	    hi = mid;
+    }
+    return lo;
+}
+int sunvox_get_sorted_pats_at( int line, int first_sorted_pat, int* rv, int rv_size, sunvox_engine* s )
+{
+    if( first_sorted_pat < 0 ) first_sorted_pat = 0;
+    int end = sunvox_get_first_sorted_pat( line + 1, s );
+    if( first_sorted_pat >= end || rv_size <= 0 ) return 0;
+    if( s->sorted_pats_end_changed || s->sorted_pats_end_leaves < s->sorted_pats_num ) build_pats_index( s );
+    int rv_num = 0;
+    if( s->sorted_pats_end_leaves )
+    {
+	rv_num = get_pats_from_index( 1, 0, s->sorted_pats_end_leaves, first_sorted_pat, end, line, rv, 0, rv_size, s );
+    }
+    else
+    {
+	for( int i = first_sorted_pat; i < end && rv_num < rv_size; i++ )
+	{
+	    int n = s->sorted_pats[ i ];
+	    sunvox_pattern* pat = s->pats[ n ];
+	    if( pat && line < s->pats_info[ n ].x + pat->lines ) rv[ rv_num++ ] = i;
+	}
+    }
+    return rv_num;
+}
 void sunvox_sort_patterns( sunvox_engine* s )
 {
     if( s->flags & SUNVOX_FLAG_STATIC_TIMELINE )
@@ -48,37 +205,36 @@ void sunvox_sort_patterns( sunvox_engine* s )
 		s->sorted_pats = SMEM_RESIZE2( s->sorted_pats, int, s->pats_num + 32 );
 	    }
 	}
+	int prev_num = s->sorted_pats_num;
 	s->sorted_pats_num = 0;
+	uint8_t* added = SMEM_ZALLOC2( uint8_t, s->pats_num );
+	if( added )
+	{
+	    //Start from the previous order (usually it's still sorted):
+	    for( int i = 0; i < prev_num; i++ )
+	    {
+		int n = s->sorted_pats[ i ];
+		if( (unsigned)n >= (unsigned)s->pats_num || !s->pats[ n ] || added[ n ] ) continue;
+		added[ n ] = 1;
+		s->sorted_pats[ s->sorted_pats_num++ ] = n;
+	    }
+	}
 	for( int i = 0; i < s->pats_num; i++ )
 	{
 	    if( !s->pats[ i ] ) continue;
-    	    s->sorted_pats[ s->sorted_pats_num ] = i;
 	    int max_x = s->pats_info[ i ].x + s->pats[ i ]->lines;
 	    if( max_x > s->proj_lines ) s->proj_lines = max_x;
-	    s->sorted_pats_num++;
+	    if( added && added[ i ] ) continue;
+    	    s->sorted_pats[ s->sorted_pats_num++ ] = i;
 	}
-        for( int i = 1; i < s->sorted_pats_num; i++ )
-        {
-    	    int j = i;
-    	    int n = s->sorted_pats[ i ];
-    	    sunvox_pattern* pat = s->pats[ n ];
-	    sunvox_pattern_info* pat_info = &s->pats_info[ n ];
-    	    while( j > 0 )
-    	    {
-    		int n2 = s->sorted_pats[ j - 1 ];
-    		sunvox_pattern* pat2 = s->pats[ n2 ];
-		sunvox_pattern_info* pat_info2 = &s->pats_info[ n2 ];
-		if( !( ( pat_info2->x > pat_info->x ) || ( pat_info2->x == pat_info->x && pat_info2->x + pat2->lines > pat_info->x + pat->lines ) ) ) break;
-		s->sorted_pats[ j ] = n2;
-		j--;
-	    }
-	    if( j != i ) s->sorted_pats[ j ] = n;
-        }
+	smem_free( added );
+	sort_pats( s->sorted_pats, s->sorted_pats_num, s );
     }
     else
     {
 	s->sorted_pats_num = 0;
     }
+    build_pats_index( s );
     if( s->flags & SUNVOX_FLAG_DYNAMIC_PATTERN_STATE )
     {
 	int pp = 0;
@@ -124,40 +280,28 @@ void sunvox_sort_patterns( sunvox_engine* s )
         }
         else
         {
-	    int pats[ MAX_PLAYING_PATS ]; 
+	    int pats_end[ MAX_PLAYING_PATS ]; //end line of the last pattern in each state
 	    int pats_num = 0;
-	    pats[ 0 ] = -1;
     	    for( int p = 0; p < s->sorted_pats_num; p++ )
 	    {
     		int n = s->sorted_pats[ p ];
 		sunvox_pattern_info* pat_info = &s->pats_info[ n ];
+		int x = pat_info->x;
 		int state_ptr = s->pat_state_size - 1;
 		int pats_num2 = pats_num + 1;
 	        if( pats_num2 > s->pat_state_size ) pats_num2 = s->pat_state_size;
 		for( int i = 0; i < pats_num2; i++ )
     		{
-    		    int n2 = pats[ i ];
-    		    if( n2 == -1 )
-    		    {
-    		        state_ptr = i;
-    		        break;
-    		    }
-		    sunvox_pattern* pat2 = s->pats[ n2 ];
-    		    sunvox_pattern_info* pat2_info = &s->pats_info[ n2 ];
-        	    if( pat2_info->x + pat2->lines <= pat_info->x )
+        	    if( i == pats_num || pats_end[ i ] <= x )
     		    {
     			state_ptr = i;
     			break;
         	    }
     		}
-    	        pats[ state_ptr ] = n;
+    	        pats_end[ state_ptr ] = x + s->pats[ n ]->lines;
     	        pat_info->state_ptr = state_ptr;
     	        pat_info->track_status = 0;
-    	        if( state_ptr >= pats_num )
-    	        {
-    	    	    pats_num = state_ptr + 1;
-    		    if( pats_num < s->pat_state_size ) pats[ pats_num ] = -1;
-    		}
+    	        if( state_ptr >= pats_num ) pats_num = state_ptr + 1;
     	    }
     	}
     }
@@ -216,29 +360,22 @@ void sunvox_select_current_playing_patterns( int first_sorted_pat, sunvox_engine
     s->last_sort_pat = -1;
     if( s->sorted_pats_num )
     {
-	int p = 0;
-	for( int i = first_sorted_pat; i < s->sorted_pats_num; i++ )
+	int p = sunvox_get_sorted_pats_at( s->line_counter, first_sorted_pat, s->cur_playing_pats, s->pat_state_size, s );
+	for( int i = 0; i < p; i++ )
 	{
-	    int pat_num = s->sorted_pats[ i ];
-	    sunvox_pattern* pat = s->pats[ pat_num ];
-	    sunvox_pattern_info* pat_info = &s->pats_info[ pat_num ];
-	    if( s->line_counter >= pat_info->x &&
-		s->line_counter < pat_info->x + pat->lines )
-	    {
-		int state_ptr = pat_info->state_ptr;
-		if( !s->pat_state[ state_ptr ].busy )
-		{
-		    clean_pattern_state( &s->pat_state[ state_ptr ], s );
-	    	    s->pat_state[ state_ptr ].busy = true;
-		}
-		s->cur_playing_pats[ p ] = i; 
-		p++; if( p >= s->pat_state_size ) break;
-	    }
-	    if( pat_info->x > s->line_counter )
+	    int state_ptr = s->pats_info[ s->sorted_pats[ s->cur_playing_pats[ i ] ] ].state_ptr;
+	    if( !s->pat_state[ state_ptr ].busy )
 	    {
-		break;
+		clean_pattern_state( &s->pat_state[ state_ptr ], s );
+	    	s->pat_state[ state_ptr ].busy = true;
 	    }
-	    s->last_sort_pat = i;
+	}
+	if( p > 0 && p >= s->pat_state_size )
+	    s->last_sort_pat = s->cur_playing_pats[ p - 1 ] - 1;
+	else
+	{
+	    int end = sunvox_get_first_sorted_pat( s->line_counter + 1, s );
+	    if( end > first_sorted_pat ) s->last_sort_pat = end - 1;
 	}
 	if( p < s->pat_state_size ) s->cur_playing_pats[ p ] = -1;
     }
@@ -348,6 +485,7 @@ void sunvox_new_pattern_with_num( int pat_num, int lines, int channels, int x, i
     pat->icon_num = -1; 
     pat->name = NULL;
     pat_info->state_ptr = 0;
+    s->time_map_changed = true;
 }
 int sunvox_new_pattern( int lines, int channels, int x, int y, uint icon_seed, sunvox_engine* s )
 {
@@ -364,6 +502,7 @@ int sunvox_new_pattern_empty_clone( int parent, int x, int y, sunvox_engine* s )
     pat_info->x = x;
     pat_info->y = y;
     pat_info->parent_num = parent;
+    s->time_map_changed = true;
     return pat_num;
 }
 int sunvox_new_pattern_clone( int pat_num, int x, int y, sunvox_engine *s )
@@ -399,6 +538,7 @@ int sunvox_new_pattern_clone( int pat_num, int x, int y, sunvox_engine *s )
 	s->pats_info[ p ].flags = SUNVOX_PATTERN_INFO_FLAG_CLONE | ( prev_flags & ( SUNVOX_PATTERN_INFO_FLAG_MUTE | SUNVOX_PATTERN_INFO_FLAG_SOLO ) );
 	s->pats_info[ p ].parent_num = pat_num;
 	s->pats_info[ p ].state_ptr = 0;
+	s->time_map_changed = true;
 	return p;
     }
     return -1;
@@ -429,6 +569,7 @@ void sunvox_convert_to_clone( int pat_num, int parent, sunvox_engine* s )
     pat_info->flags |= SUNVOX_PATTERN_INFO_FLAG_CLONE;
     pat_info->parent_num = parent;
     s->pats[ pat_num ] = parent_pat;
+    s->time_map_changed = true;
 }
 void sunvox_remove_pattern( int pat_num, sunvox_engine* s )
 {
@@ -437,6 +578,7 @@ void sunvox_remove_pattern( int pat_num, sunvox_engine* s )
 	sunvox_pattern* pat = s->pats[ pat_num ];
 	if( pat )
 	{
+	    s->time_map_changed = true;
 	    if( s->pats_info[ pat_num ].flags & SUNVOX_PATTERN_INFO_FLAG_CLONE )
 	    {
 		s->pats[ pat_num ] = NULL;
@@ -476,6 +618,7 @@ void sunvox_change_pattern_flags( int pat_num, uint pat_flags, uint pat_info_fla
 	    pat_info->flags |= pat_info_flags;
 	else
 	    pat_info->flags &= ~pat_info_flags;
+	s->time_map_changed = true;
     }
 }
 void sunvox_rename_pattern( int pat_num, const char* name, sunvox_engine* s )
@@ -644,6 +787,7 @@ void sunvox_pattern_set_number_of_channels( int pat_num, int cnum, sunvox_engine
 	    }
 	}
 	pat->channels = cnum;
+	s->time_map_changed = true;
     }
 }
 int sunvox_pattern_set_number_of_lines( int pat_num, int lnum, bool rescale_content, sunvox_engine* s )
@@ -707,7 +851,9 @@ int sunvox_pattern_set_number_of_lines( int pat_num, int lnum, bool rescale_cont
 	}
 	break;
     }
+    if( pat->lines != lnum ) s->sorted_pats_end_changed = true;
     pat->lines = lnum;
+    s->time_map_changed = true;
     return 0;
 }
 void sunvox_check_solo_mode( sunvox_engine* s )
@@ -721,6 +867,7 @@ void sunvox_check_solo_mode( sunvox_engine* s )
             break;
         }
     }
+    s->time_map_changed = true;
 }
 int sunvox_pattern_shift( int pat_num, int track, int line, int lines, int cnt, int polyrhythm_len, sunvox_engine* s )
 {
@@ -731,6 +878,7 @@ int sunvox_pattern_shift( int pat_num, int track, int line, int lines, int cnt,
     if( lines == 0 ) lines = pat->lines;
     CROP_REGION( line, lines, 0, pat->lines );
     if( lines <= 0 ) return -1;
+    s->time_map_changed = true;
     const int tmp_size = 16;
     sunvox_note tmp[ tmp_size ];
     while( cnt < 0 ) cnt += lines;
@@ -0,0 +1,163 @@
+//
+// * Using SunVox as a filter with the separate (non-interleaved) buffer for each channel
+//   (double precision; typical for the plugin hosts like Max/MSP)
+//   (with export to WAV)
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <dlfcn.h>
+#include <signal.h>
+#include <math.h>
+
+#define SUNVOX_MAIN
+#include "../../headers/sunvox.h"
+
+int g_sv_sample_rate = 44100; //Hz
+const int g_sv_channels_num = 2; //1 - mono; 2 - stereo; only stereo supported in the current version
+int g_sv_buffer_size = 64; //Audio buffer size (number of frames)
+
+int keep_running = 1;
+void int_handler( int param )
+{
+    keep_running = 0;
+}
+
+int main()
+{
+    signal( SIGINT, int_handler );
+
+    if( sv_load_dll() )
+	return 1;
+
+    int flags = SV_INIT_FLAG_USER_AUDIO_CALLBACK | SV_INIT_FLAG_ONE_THREAD | SV_INIT_FLAG_AUDIO_FLOAT32;
+    int ver = sv_init( 0, g_sv_sample_rate, g_sv_channels_num, flags );
+    if( ver >= 0 )
+    {
+	int major = ( ver >> 16 ) & 255;
+	int minor1 = ( ver >> 8 ) & 255;
+	int minor2 = ( ver ) & 255;
+	printf( "SunVox lib version: %d.%d.%d\n", major, minor1, minor2 );
+
+	sv_open_slot( 0 );
+
+	sv_volume( 0, 256 );
+	sv_lock_slot( 0 );
+	int mod1 = sv_new_module( 0, "Input", "Input", 96, 0, 0 );
+	int mod2 = sv_new_module( 0, "Reverb", "Reverb", 64, 0, 0 );
+	printf( "Input: %d\n", mod1 );
+	printf( "Reverb: %d\n", mod2 );
+	sv_connect_module( 0, mod1, mod2 ); //Input -> Reverb
+	sv_connect_module( 0, mod2, 0 ); //Reverb -> Output
+	sv_unlock_slot( 0 );
+	sv_update_input();
+
+	//Saving the audio stream to the WAV file:
+	//(audio format: 32-bit float stereo interleaved (LRLRLRLR...))
+	FILE* f = fopen( "audio_stream3.wav", "wb" );
+	if( f )
+	{
+	    double* out[ 2 ]; //Output audio buffers (one per channel)
+	    double* in[ 2 ]; //Input audio buffers (one per channel)
+	    for( int ch = 0; ch < g_sv_channels_num; ch++ )
+	    {
+		out[ ch ] = (double*)malloc( g_sv_buffer_size * sizeof( double ) );
+		in[ ch ] = (double*)malloc( g_sv_buffer_size * sizeof( double ) );
+	    }
+	    float* buf = (float*)malloc( g_sv_buffer_size * g_sv_channels_num * sizeof( float ) );
+	    int out_frames = g_sv_sample_rate * 8; //8 seconds
+            int out_bytes = out_frames * g_sv_channels_num * 4;
+	    int cur_frame = 0;
+	    int val;
+
+	    //WAV header:
+            fwrite( (void*)"RIFF", 1, 4, f );
+            val = 4 + 24 + 8 + out_bytes; fwrite( &val, 4, 1, f );
+            fwrite( (void*)"WAVE", 1, 4, f );
+
+            //WAV FORMAT:
+            fwrite( (void*)"fmt ", 1, 4, f );
+            val = 16; fwrite( &val, 4, 1, f );
+            val = 3; fwrite( &val, 2, 1, f ); //format
+            val = g_sv_channels_num; fwrite( &val, 2, 1, f ); //channels
+            val = g_sv_sample_rate; fwrite( &val, 4, 1, f ); //frames per second
+            val = g_sv_sample_rate * g_sv_channels_num * 4; fwrite( &val, 4, 1, f ); //bytes per second
+            val = g_sv_channels_num * 4; fwrite( &val, 2, 1, f ); //block align
+    	    val = 32; fwrite( &val, 2, 1, f ); //bits
+
+            //WAV DATA:
+            fwrite( (void*)"data", 1, 4, f );
+            fwrite( &out_bytes, 4, 1, f );
+            int pos = 0;
+	    while( keep_running && cur_frame < out_frames )
+	    {
+		int size = g_sv_buffer_size;
+		if( cur_frame + size > out_frames )
+		    size = out_frames - cur_frame;
+
+		//Generate the input (left: saw; right: the same saw, but one octave higher):
+		for( int i = 0; i < size; i++ )
+		{
+		    int phase = cur_frame + i;
+		    double a = sin( (double)phase / 4096.0 );
+		    phase += a * 1024 * 8;
+		    in[ 0 ][ i ] = (double)( ( phase & 511 ) - 256 ) / 256 * a / 4;
+		    in[ 1 ][ i ] = (double)( ( ( phase * 2 ) & 511 ) - 256 ) / 256 * a / 4;
+		}
+
+		//Send it to SunVox and read the filtered output:
+		sv_audio_callback_planar(
+		    (void**)out, //output buffers
+		    size, //output buffer length (frames)
+		    0, //latency (frames)
+		    sv_get_ticks(), //output time in system ticks
+		    2, //buffer type: 1 - float; 2 - double
+		    g_sv_channels_num, //input channels
+		    (void**)in //input buffers
+		);
+
+		cur_frame += size;
+
+		//Save this data to the file:
+		for( int i = 0; i < size; i++ )
+		{
+		    for( int ch = 0; ch < g_sv_channels_num; ch++ )
+			buf[ i * g_sv_channels_num + ch ] = (float)out[ ch ][ i ];
+		}
+		fwrite( buf, 1, size * g_sv_channels_num * sizeof( float ), f );
+
+		//Print some info:
+		int new_pos = (int)( ( (float)cur_frame / (float)out_frames ) * 100 );
+		if( pos != new_pos )
+		{
+		    printf( "%d %%\n", pos );
+		    pos = new_pos;
+		}
+	    }
+	    fclose( f );
+	    for( int ch = 0; ch < g_sv_channels_num; ch++ )
+	    {
+		free( out[ ch ] );
+		free( in[ ch ] );
+	    }
+	    free( buf );
+	}
+	else
+	{
+	    printf( "Can't open the file\n" );
+	}
+
+	sv_close_slot( 0 );
+
+	sv_deinit();
+    }
+    else
+    {
+	printf( "sv_init() error %d\n", ver );
+    }
+
+    sv_unload_dll();
+
+    return 0;
+}
@@ -36,6 +36,26 @@ typedef struct
     uint16_t	ctl_val;        /* 0xXXYY: controller value or effect parameter */
 } sunvox_note;
 
+typedef struct
+{
+    int		module;
+    int		thread;         /* render thread */
+    uint32_t	block;          /* audio block counter */
+    uint32_t	duration;       /* render time (ns) */
+    uint64_t	time;           /* start time (ns) */
+} sv_profiler_record;           /* see sv_profiler_read() */
+
+typedef struct
+{
+    uint32_t	frame;          /* offset (in frames) from the beginning of the next audio callback */
+    int		track_num;
+    int		note;
+    int		vel;
+    int		module;
+    int		ctl;
+    int		ctl_val;
+} sv_event;                     /* see sv_send_events() */
+
 /* Flags for sv_init(): */
 #define SV_INIT_FLAG_NO_DEBUG_OUTPUT 		( 1 << 0 )
 #define SV_INIT_FLAG_USER_AUDIO_CALLBACK 	( 1 << 1 ) /* Offline mode: */
@@ -64,6 +84,10 @@ typedef struct
 #define SV_MODULE_OUTPUTS_OFF 	( 16 + 8 )
 #define SV_MODULE_OUTPUTS_MASK 	( 255 << SV_MODULE_OUTPUTS_OFF )
 
+/* Flags for sv_set_module_scope(): */
+#define SV_SCOPE_RAW		( 1 << 0 ) /* Raw output samples for sv_get_module_scope2() */
+#define SV_SCOPE_PEAKS		( 1 << 1 ) /* Decimated min/max/RMS stream for sv_get_module_peaks() */
+
 /*
    Macros
 */
@@ -125,6 +149,12 @@ extern "C" {
      config - string with additional configuration in the following format: "option_name=value|option_name=value";
               example: "buffer=1024|audiodriver=alsa|audiodevice=hw:0,0";
               use NULL for automatic configuration;
+              render_threads=N - number of threads for the module graph rendering: 1 - single-threaded (default); 0 - all CPU cores;
+              slot_threads=N - number of threads for the parallel rendering of the slots: 1 - single-threaded (default); 0 - all CPU cores;
+              vplayer_prefetch=1 - decode the Vorbis Player streams in the background thread (for the realtime playback; ignored during export);
+              load_threads=N - number of threads for the module initialization (samples, SpectraVoice, MetaModule) during the project loading: 1 - single-threaded; 0 - all CPU cores (default);
+              metamodule_pipeline=1 - render the MetaModule projects in the background threads (shared pool), in parallel with the main project;
+                                      each MetaModule adds one block of latency to its signal path; see sv_get_pipeline_latency(); ignored during export;
      freq - desired sample rate (Hz); min - 44100;
             the actual rate may be different, if SV_INIT_FLAG_USER_AUDIO_CALLBACK is not set;
      channels - only 2 supported now;
@@ -138,6 +168,22 @@ int sv_deinit( void ) SUNVOX_FN_ATTR;
 */
 int sv_get_sample_rate( void ) SUNVOX_FN_ATTR;
 
+/*
+   sv_set_sample_rate() - change the sampling rate without closing the slots
+   (only with SV_INIT_FLAG_USER_AUDIO_CALLBACK; e.g. when the host changes its rate);
+   the projects stay loaded: each slot is rebuilt at the new rate from an in-memory copy of its project,
+   then the new engines replace the old ones under the audio lock (sv_audio_callback() waits for it);
+   kept: the playback position, the sv_pause() state, sv_volume(), sv_set_autostop(), the module scope subscriptions,
+   the unhandled commands (their IDs for sv_wait_command() stay valid) and the sv_send_events() queue
+   (the frame offsets are converted to the new rate);
+   lost: the sounding notes are cut; the module state that is not saved in the project (delay lines, envelopes, etc.) is reset;
+   other functions for these slots (including sv_wait_command() and sv_send_event*()) must not be called at the same time;
+   each project is temporarily loaded twice (peak memory);
+   if some project can't be saved or restored, nothing is changed;
+   return value: 0 (success) or negative error code.
+*/
+int sv_set_sample_rate( int freq ) SUNVOX_FN_ATTR;
+
 /*
    sv_update_input() - 
    handle input ON/OFF requests to enable/disable input ports of the sound card
@@ -182,6 +228,22 @@ int sv_audio_callback( void* buf, int frames, int latency, uint32_t out_time ) S
 */
 int sv_audio_callback2( void* buf, int frames, int latency, uint32_t out_time, int in_type, int in_channels, void* in_buf ) SUNVOX_FN_ATTR;
 
+/*
+   sv_audio_callback_planar() - same as sv_audio_callback2(), but with the separate (non-interleaved) buffer for each channel.
+   The Output module is rendered directly into the buffers (without intermediate interleaving and conversion).
+   Parameters:
+     buf - array of destination buffers (one per channel; number of channels = sv_init() channels);
+     ...
+     type - type of the buffers (output and input): 1 - float (32bit floating point); 2 - double (64bit floating point);
+     in_channels - number of input channels (0 - no input);
+     in_buf - array of input buffers (one per channel) or NULL;
+   Example:
+     double* out[ 2 ] = { out_left, out_right };
+     double* in[ 2 ] = { in_left, in_right };
+     sv_audio_callback_planar( (void**)out, frames, 0, sv_get_ticks(), 2, 2, (void**)in );
+*/
+int sv_audio_callback_planar( void** buf, int frames, int latency, uint32_t out_time, int type, int in_channels, void** in_buf ) SUNVOX_FN_ATTR;
+
 /*
    sv_open_slot(), sv_close_slot(), sv_lock_slot(), sv_unlock_slot() - 
    open/close/lock/unlock sound slot for SunVox.
@@ -199,7 +261,8 @@ int sv_unlock_slot( int slot ) SUNVOX_FN_ATTR;
 
 /*
    sv_load(), sv_load_from_memory() - 
-   load SunVox project from the file or from the memory block.
+   load SunVox project from the file or from the memory block;
+   sv_load_from_memory() copies the data (the block can be freed after the call), so the peak memory usage is data_size + project size.
 */
 int sv_load( int slot, const char* name ) SUNVOX_FN_ATTR;
 int sv_load_from_memory( int slot, void* data, uint32_t data_size ) SUNVOX_FN_ATTR;
@@ -243,6 +306,17 @@ int sv_pause( int slot ) SUNVOX_FN_ATTR;
 int sv_resume( int slot ) SUNVOX_FN_ATTR;
 int sv_sync_resume( int slot ) SUNVOX_FN_ATTR;
 
+/*
+   sv_play_async(), sv_stop_async() - same as sv_play() and sv_stop(), but these functions don't wait for the audio thread;
+   return value: command ID > 0 (for sv_wait_command()) or negative error code (e.g. the command queue is full);
+   sv_wait_command() - wait until the audio thread handles the command (and all the commands sent before it);
+   timeout (ms): 0 - don't wait (just check); -1 - infinite;
+   return value: 1 - handled; 0 - not yet (timeout); negative error code.
+*/
+int sv_play_async( int slot ) SUNVOX_FN_ATTR;
+int sv_stop_async( int slot ) SUNVOX_FN_ATTR;
+int sv_wait_command( int slot, int cmd_id, int timeout ) SUNVOX_FN_ATTR;
+
 /*
    sv_set_autostop(), sv_get_autostop() -
    autostop values: 0 - disable autostop; 1 - enable autostop.
@@ -292,6 +366,18 @@ int sv_set_event_t( int slot, int set, int t ) SUNVOX_FN_ATTR;
 */
 int sv_send_event( int slot, int track_num, int note, int vel, int module, int ctl, int ctl_val ) SUNVOX_FN_ATTR;
 
+/*
+   sv_send_events() - send a pack of events with sample-accurate timing;
+   can be called from several threads at once (lock-free);
+   events are handled by the audio callback in order of their frame offsets (events with the same offset - in the order of sending);
+   event fields are the same as in sv_send_event(); frame - offset from the beginning of the next audio callback
+   (events beyond the end of this callback will be handled in the following callbacks);
+   the queue is independent of sv_send_event() and sv_set_event_t();
+   return value: number of events queued (the first N events of the array), or negative error code;
+   if it is less than count, the queue is full - send the remaining events later.
+*/
+int sv_send_events( int slot, const sv_event* events, int count ) SUNVOX_FN_ATTR;
+
 /*
 */
 int sv_get_current_line( int slot ) SUNVOX_FN_ATTR; /* Get current line number */
@@ -328,6 +414,19 @@ uint32_t sv_get_song_length_lines( int slot ) SUNVOX_FN_ATTR;
 */
 int sv_get_time_map( int slot, int start_line, int len, uint32_t* dest, int flags ) SUNVOX_FN_ATTR;
 
+/*
+   sv_get_frame_by_line() - get the frame counter at the beginning of the line (same as SV_TIME_MAP_FRAMECNT with start_line=0);
+   sv_get_line_by_frame() - get the line number at the specified frame;
+   sv_get_line2_by_frame() - get the line number at the specified frame in fixed point format 27.5;
+   The time map (BPM/TPL changes) is cached, so these functions are fast enough to be called many times per second.
+   The cache is reset by the pattern functions (sv_set_pattern_event(), sv_set_pattern_xy(), sv_pattern_mute(), etc.).
+   If you change the speed effects (0F, 1F) through the sv_get_pattern_data() buffer,
+   call sv_get_pattern_data() again after the change.
+*/
+uint32_t sv_get_frame_by_line( int slot, int line ) SUNVOX_FN_ATTR;
+int sv_get_line_by_frame( int slot, uint32_t frame ) SUNVOX_FN_ATTR;
+int sv_get_line2_by_frame( int slot, uint32_t frame ) SUNVOX_FN_ATTR;
+
 /*
    sv_new_module() - create a new module;
    sv_remove_module() - remove selected module;
@@ -373,6 +472,20 @@ int sv_metamodule_load( int slot, int mod_num, const char* file_name ) SUNVOX_FN
 int sv_metamodule_load_from_memory( int slot, int mod_num, void* data, uint32_t data_size ) SUNVOX_FN_ATTR;
 int sv_vplayer_load( int slot, int mod_num, const char* file_name ) SUNVOX_FN_ATTR;
 int sv_vplayer_load_from_memory( int slot, int mod_num, void* data, uint32_t data_size ) SUNVOX_FN_ATTR;
+/*
+   sv_vplayer_get_underruns() - get the number of the Vorbis Player buffer underruns
+   (when the background decoder is late, the player outputs silence instead of waiting; see vplayer_prefetch in sv_init());
+*/
+uint32_t sv_vplayer_get_underruns( int slot, int mod_num ) SUNVOX_FN_ATTR;
+/*
+   sv_get_pipeline_latency() - get the additional latency (in frames) of the MetaModules rendered in the background threads
+   (metamodule_pipeline=1 in sv_init()); 0 if the pipeline is disabled;
+   this is the worst path to the Output: the MetaModules connected in series add up their latencies;
+   the host can shift the other sound sources by this number of frames;
+   the paths inside the project are not compensated: the signals that bypass the pipelined MetaModules
+   (or pass through fewer of them) reach the Output earlier than the worst path.
+*/
+int sv_get_pipeline_latency( int slot ) SUNVOX_FN_ATTR;
 
 /*
    sv_get_number_of_modules() - get the number of module slots (not the actual number of modules).
@@ -454,6 +567,28 @@ int sv_set_module_relnote( int slot, int mod_num, int relative_note ) SUNVOX_FN_
 */
 uint32_t sv_get_module_scope2( int slot, int mod_num, int channel, int16_t* dest_buf, uint32_t samples_to_read ) SUNVOX_FN_ATTR;
 
+/*
+   sv_set_module_scope() - select what the engine captures from the module output (SV_SCOPE_* flags); USE LOCK/UNLOCK!
+   By default nothing is captured, so the modules without subscribers cost nothing.
+   sv_get_module_scope2() subscribes to SV_SCOPE_RAW automatically (the first call briefly locks the slot and returns silence).
+   Parameters:
+     peak_frames - number of frames per one entry of the peak stream (0 = default: 256).
+   sv_get_module_peaks() - read the peak stream (SV_SCOPE_PEAKS must be set):
+     three floats per entry: min, max, RMS (-1...1);
+     pos - read position (in/out): set it to 0 before the first call;
+     return value = received number of entries (may be less or equal to count).
+   Example:
+     float buf[ 64 * 3 ];
+     uint32_t pos = 0;
+     sv_lock_slot( slot );
+     sv_set_module_scope( slot, mod_num, SV_SCOPE_PEAKS, 512 );
+     sv_unlock_slot( slot );
+     ...
+     int received = sv_get_module_peaks( slot, mod_num, 0, buf, 64, &pos );
+*/
+int sv_set_module_scope( int slot, int mod_num, uint32_t flags, int peak_frames ) SUNVOX_FN_ATTR;
+uint32_t sv_get_module_peaks( int slot, int mod_num, int channel, float* dest, uint32_t count, uint32_t* pos ) SUNVOX_FN_ATTR;
+
 /*
    sv_module_curve() - access to the curve values of the specified module
    Parameters:
@@ -633,6 +768,35 @@ uint32_t sv_get_ticks_per_second( void ) SUNVOX_FN_ATTR;
 */
 const char* sv_get_log( int size ) SUNVOX_FN_ATTR;
 
+/*
+   Module render profiler.
+   When enabled, the render time of each module in each audio block is written to the lock-free buffers (one per render thread).
+   Read these buffers regularly (from the non-audio thread) using sv_profiler_read() or sv_profiler_save_trace();
+   records that don't fit into the buffers are lost (see sv_profiler_get_lost()).
+   sv_profiler_enable() - enable (1) / disable (0) the profiler; return value: 0 (success) or negative error code;
+   sv_profiler_read() - get the new records and update the stats:
+     records - array of max_records items, or NULL (if you only need the stats);
+     return value: number of records, or negative error code;
+   sv_profiler_get_module_stats() - render time statistics for the module (in nanoseconds; since the first sv_profiler_enable() or sv_profiler_reset()):
+     stats[ 0 ] - min; stats[ 1 ] - average; stats[ 2 ] - max; stats[ 3 ] - 99th percentile (approximate);
+     return value: number of measurements (0 - no data);
+   sv_profiler_save_trace() - read all new records and save them to the file in Chrome Trace Event format (JSON; chrome://tracing or ui.perfetto.dev);
+   sv_profiler_reset() - drop the new records and clear the stats;
+   sv_profiler_get_lost() - number of lost records.
+   Example:
+     sv_profiler_enable( slot, 1 );
+     ... play ...
+     sv_profiler_save_trace( slot, "trace.json" );
+     uint32_t stats[ 4 ];
+     if( sv_profiler_get_module_stats( slot, mod_num, stats ) > 0 ) printf( "max render time: %u ns\n", stats[ 2 ] );
+*/
+int sv_profiler_enable( int slot, int enable ) SUNVOX_FN_ATTR;
+int sv_profiler_read( int slot, sv_profiler_record* records, int max_records ) SUNVOX_FN_ATTR;
+int sv_profiler_get_module_stats( int slot, int mod_num, uint32_t* stats ) SUNVOX_FN_ATTR;
+int sv_profiler_save_trace( int slot, const char* file_name ) SUNVOX_FN_ATTR;
+int sv_profiler_reset( int slot ) SUNVOX_FN_ATTR;
+uint32_t sv_profiler_get_lost( int slot ) SUNVOX_FN_ATTR;
+
 #ifdef __cplusplus
 } /* ...extern "C" */
 #endif
@@ -643,6 +807,7 @@ const char* sv_get_log( int size ) SUNVOX_FN_ATTR;
 
 typedef int (SUNVOX_FN_ATTR *tsv_audio_callback)( void* buf, int frames, int latency, uint32_t out_time );
 typedef int (SUNVOX_FN_ATTR *tsv_audio_callback2)( void* buf, int frames, int latency, uint32_t out_time, int in_type, int in_channels, void* in_buf );
+typedef int (SUNVOX_FN_ATTR *tsv_audio_callback_planar)( void** buf, int frames, int latency, uint32_t out_time, int type, int in_channels, void** in_buf );
 typedef int (SUNVOX_FN_ATTR *tsv_open_slot)( int slot );
 typedef int (SUNVOX_FN_ATTR *tsv_close_slot)( int slot );
 typedef int (SUNVOX_FN_ATTR *tsv_lock_slot)( int slot );
@@ -650,6 +815,7 @@ typedef int (SUNVOX_FN_ATTR *tsv_unlock_slot)( int slot );
 typedef int (SUNVOX_FN_ATTR *tsv_init)( const char* config, int freq, int channels, uint32_t flags );
 typedef int (SUNVOX_FN_ATTR *tsv_deinit)( void );
 typedef int (SUNVOX_FN_ATTR *tsv_get_sample_rate)( void );
+typedef int (SUNVOX_FN_ATTR *tsv_set_sample_rate)( int freq );
 typedef int (SUNVOX_FN_ATTR *tsv_update_input)( void );
 typedef int (SUNVOX_FN_ATTR *tsv_load)( int slot, const char* name );
 typedef int (SUNVOX_FN_ATTR *tsv_load_from_memory)( int slot, void* data, uint32_t data_size );
@@ -661,6 +827,9 @@ typedef int (SUNVOX_FN_ATTR *tsv_stop)( int slot );
 typedef int (SUNVOX_FN_ATTR *tsv_pause)( int slot );
 typedef int (SUNVOX_FN_ATTR *tsv_resume)( int slot );
 typedef int (SUNVOX_FN_ATTR *tsv_sync_resume)( int slot );
+typedef int (SUNVOX_FN_ATTR *tsv_play_async)( int slot );
+typedef int (SUNVOX_FN_ATTR *tsv_stop_async)( int slot );
+typedef int (SUNVOX_FN_ATTR *tsv_wait_command)( int slot, int cmd_id, int timeout );
 typedef int (SUNVOX_FN_ATTR *tsv_set_autostop)( int slot, int autostop );
 typedef int (SUNVOX_FN_ATTR *tsv_get_autostop)( int slot );
 typedef int (SUNVOX_FN_ATTR *tsv_end_of_song)( int slot );
@@ -668,6 +837,7 @@ typedef int (SUNVOX_FN_ATTR *tsv_rewind)( int slot, int t );
 typedef int (SUNVOX_FN_ATTR *tsv_volume)( int slot, int vol );
 typedef int (SUNVOX_FN_ATTR *tsv_set_event_t)( int slot, int set, int t );
 typedef int (SUNVOX_FN_ATTR *tsv_send_event)( int slot, int track_num, int note, int vel, int module, int ctl, int ctl_val );
+typedef int (SUNVOX_FN_ATTR *tsv_send_events)( int slot, const sv_event* events, int count );
 typedef int (SUNVOX_FN_ATTR *tsv_get_current_line)( int slot );
 typedef int (SUNVOX_FN_ATTR *tsv_get_current_line2)( int slot );
 typedef int (SUNVOX_FN_ATTR *tsv_get_current_signal_level)( int slot, int channel );
@@ -679,6 +849,9 @@ typedef int (SUNVOX_FN_ATTR *tsv_get_song_tpl)( int slot );
 typedef uint32_t (SUNVOX_FN_ATTR *tsv_get_song_length_frames)( int slot );
 typedef uint32_t (SUNVOX_FN_ATTR *tsv_get_song_length_lines)( int slot );
 typedef int (SUNVOX_FN_ATTR *tsv_get_time_map)( int slot, int start_line, int len, uint32_t* dest, int flags );
+typedef uint32_t (SUNVOX_FN_ATTR *tsv_get_frame_by_line)( int slot, int line );
+typedef int (SUNVOX_FN_ATTR *tsv_get_line_by_frame)( int slot, uint32_t frame );
+typedef int (SUNVOX_FN_ATTR *tsv_get_line2_by_frame)( int slot, uint32_t frame );
 typedef int (SUNVOX_FN_ATTR *tsv_new_module)( int slot, const char* type, const char* name, int x, int y, int z );
 typedef int (SUNVOX_FN_ATTR *tsv_remove_module)( int slot, int mod_num );
 typedef int (SUNVOX_FN_ATTR *tsv_connect_module)( int slot, int source, int destination );
@@ -692,6 +865,8 @@ typedef int (SUNVOX_FN_ATTR *tsv_metamodule_load)( int slot, int mod_num, const
 typedef int (SUNVOX_FN_ATTR *tsv_metamodule_load_from_memory)( int slot, int mod_num, void* data, uint32_t data_size );
 typedef int (SUNVOX_FN_ATTR *tsv_vplayer_load)( int slot, int mod_num, const char* file_name );
 typedef int (SUNVOX_FN_ATTR *tsv_vplayer_load_from_memory)( int slot, int mod_num, void* data, uint32_t data_size );
+typedef uint32_t (SUNVOX_FN_ATTR *tsv_vplayer_get_underruns)( int slot, int mod_num );
+typedef int (SUNVOX_FN_ATTR *tsv_get_pipeline_latency)( int slot );
 typedef int (SUNVOX_FN_ATTR *tsv_get_number_of_modules)( int slot );
 typedef int (SUNVOX_FN_ATTR *tsv_find_module)( int slot, const char* name );
 typedef uint32_t (SUNVOX_FN_ATTR *tsv_get_module_flags)( int slot, int mod_num );
@@ -708,6 +883,8 @@ typedef uint32_t (SUNVOX_FN_ATTR *tsv_get_module_finetune)( int slot, int mod_nu
 typedef int (SUNVOX_FN_ATTR *tsv_set_module_finetune)( int slot, int mod_num, int finetune );
 typedef int (SUNVOX_FN_ATTR *tsv_set_module_relnote)( int slot, int mod_num, int relative_note );
 typedef uint32_t (SUNVOX_FN_ATTR *tsv_get_module_scope2)( int slot, int mod_num, int channel, int16_t* dest_buf, uint32_t samples_to_read );
+typedef int (SUNVOX_FN_ATTR *tsv_set_module_scope)( int slot, int mod_num, uint32_t flags, int peak_frames );
+typedef uint32_t (SUNVOX_FN_ATTR *tsv_get_module_peaks)( int slot, int mod_num, int channel, float* dest, uint32_t count, uint32_t* pos );
 typedef int (SUNVOX_FN_ATTR *tsv_module_curve)( int slot, int mod_num, int curve_num, float* data, int len, int w );
 typedef int (SUNVOX_FN_ATTR *tsv_get_number_of_module_ctls)( int slot, int mod_num );
 typedef const char* (SUNVOX_FN_ATTR *tsv_get_module_ctl_name)( int slot, int mod_num, int ctl_num );
@@ -737,6 +914,12 @@ typedef int (SUNVOX_FN_ATTR *tsv_pattern_mute)( int slot, int pat_num, int mute
 typedef uint32_t (SUNVOX_FN_ATTR *tsv_get_ticks)( void );
 typedef uint32_t (SUNVOX_FN_ATTR *tsv_get_ticks_per_second)( void );
 typedef const char* (SUNVOX_FN_ATTR *tsv_get_log)( int size );
+typedef int (SUNVOX_FN_ATTR *tsv_profiler_enable)( int slot, int enable );
+typedef int (SUNVOX_FN_ATTR *tsv_profiler_read)( int slot, sv_profiler_record* records, int max_records );
+typedef int (SUNVOX_FN_ATTR *tsv_profiler_get_module_stats)( int slot, int mod_num, uint32_t* stats );
+typedef int (SUNVOX_FN_ATTR *tsv_profiler_save_trace)( int slot, const char* file_name );
+typedef int (SUNVOX_FN_ATTR *tsv_profiler_reset)( int slot );
+typedef uint32_t (SUNVOX_FN_ATTR *tsv_profiler_get_lost)( int slot );
 
 #ifdef SUNVOX_MAIN
     #define SV_FN_DECL
@@ -748,6 +931,7 @@ typedef const char* (SUNVOX_FN_ATTR *tsv_get_log)( int size );
 
 SV_FN_DECL tsv_audio_callback sv_audio_callback SV_FN_DECL2;
 SV_FN_DECL tsv_audio_callback2 sv_audio_callback2 SV_FN_DECL2;
+SV_FN_DECL tsv_audio_callback_planar sv_audio_callback_planar SV_FN_DECL2;
 SV_FN_DECL tsv_open_slot sv_open_slot SV_FN_DECL2;
 SV_FN_DECL tsv_close_slot sv_close_slot SV_FN_DECL2;
 SV_FN_DECL tsv_lock_slot sv_lock_slot SV_FN_DECL2;
@@ -755,6 +939,7 @@ SV_FN_DECL tsv_unlock_slot sv_unlock_slot SV_FN_DECL2;
 SV_FN_DECL tsv_init sv_init SV_FN_DECL2;
 SV_FN_DECL tsv_deinit sv_deinit SV_FN_DECL2;
 SV_FN_DECL tsv_get_sample_rate sv_get_sample_rate SV_FN_DECL2;
+SV_FN_DECL tsv_set_sample_rate sv_set_sample_rate SV_FN_DECL2;
 SV_FN_DECL tsv_update_input sv_update_input SV_FN_DECL2;
 SV_FN_DECL tsv_load sv_load SV_FN_DECL2;
 SV_FN_DECL tsv_load_from_memory sv_load_from_memory SV_FN_DECL2;
@@ -766,6 +951,9 @@ SV_FN_DECL tsv_stop sv_stop SV_FN_DECL2;
 SV_FN_DECL tsv_pause sv_pause SV_FN_DECL2;
 SV_FN_DECL tsv_resume sv_resume SV_FN_DECL2;
 SV_FN_DECL tsv_sync_resume sv_sync_resume SV_FN_DECL2;
+SV_FN_DECL tsv_play_async sv_play_async SV_FN_DECL2;
+SV_FN_DECL tsv_stop_async sv_stop_async SV_FN_DECL2;
+SV_FN_DECL tsv_wait_command sv_wait_command SV_FN_DECL2;
 SV_FN_DECL tsv_set_autostop sv_set_autostop SV_FN_DECL2;
 SV_FN_DECL tsv_get_autostop sv_get_autostop SV_FN_DECL2;
 SV_FN_DECL tsv_end_of_song sv_end_of_song SV_FN_DECL2;
@@ -773,6 +961,7 @@ SV_FN_DECL tsv_rewind sv_rewind SV_FN_DECL2;
 SV_FN_DECL tsv_volume sv_volume SV_FN_DECL2;
 SV_FN_DECL tsv_set_event_t sv_set_event_t SV_FN_DECL2;
 SV_FN_DECL tsv_send_event sv_send_event SV_FN_DECL2;
+SV_FN_DECL tsv_send_events sv_send_events SV_FN_DECL2;
 SV_FN_DECL tsv_get_current_line sv_get_current_line SV_FN_DECL2;
 SV_FN_DECL tsv_get_current_line2 sv_get_current_line2 SV_FN_DECL2;
 SV_FN_DECL tsv_get_current_signal_level sv_get_current_signal_level SV_FN_DECL2;
@@ -784,6 +973,9 @@ SV_FN_DECL tsv_get_song_tpl sv_get_song_tpl SV_FN_DECL2;
 SV_FN_DECL tsv_get_song_length_frames sv_get_song_length_frames SV_FN_DECL2;
 SV_FN_DECL tsv_get_song_length_lines sv_get_song_length_lines SV_FN_DECL2;
 SV_FN_DECL tsv_get_time_map sv_get_time_map SV_FN_DECL2;
+SV_FN_DECL tsv_get_frame_by_line sv_get_frame_by_line SV_FN_DECL2;
+SV_FN_DECL tsv_get_line_by_frame sv_get_line_by_frame SV_FN_DECL2;
+SV_FN_DECL tsv_get_line2_by_frame sv_get_line2_by_frame SV_FN_DECL2;
 SV_FN_DECL tsv_new_module sv_new_module SV_FN_DECL2;
 SV_FN_DECL tsv_remove_module sv_remove_module SV_FN_DECL2;
 SV_FN_DECL tsv_connect_module sv_connect_module SV_FN_DECL2;
@@ -797,6 +989,8 @@ SV_FN_DECL tsv_metamodule_load sv_metamodule_load SV_FN_DECL2;
 SV_FN_DECL tsv_metamodule_load_from_memory sv_metamodule_load_from_memory SV_FN_DECL2;
 SV_FN_DECL tsv_vplayer_load sv_vplayer_load SV_FN_DECL2;
 SV_FN_DECL tsv_vplayer_load_from_memory sv_vplayer_load_from_memory SV_FN_DECL2;
+SV_FN_DECL tsv_vplayer_get_underruns sv_vplayer_get_underruns SV_FN_DECL2;
+SV_FN_DECL tsv_get_pipeline_latency sv_get_pipeline_latency SV_FN_DECL2;
 SV_FN_DECL tsv_get_number_of_modules sv_get_number_of_modules SV_FN_DECL2;
 SV_FN_DECL tsv_find_module sv_find_module SV_FN_DECL2;
 SV_FN_DECL tsv_get_module_flags sv_get_module_flags SV_FN_DECL2;
@@ -813,6 +1007,8 @@ SV_FN_DECL tsv_get_module_finetune sv_get_module_finetune SV_FN_DECL2;
 SV_FN_DECL tsv_set_module_finetune sv_set_module_finetune SV_FN_DECL2;
 SV_FN_DECL tsv_set_module_relnote sv_set_module_relnote SV_FN_DECL2;
 SV_FN_DECL tsv_get_module_scope2 sv_get_module_scope2 SV_FN_DECL2;
+SV_FN_DECL tsv_set_module_scope sv_set_module_scope SV_FN_DECL2;
+SV_FN_DECL tsv_get_module_peaks sv_get_module_peaks SV_FN_DECL2;
 SV_FN_DECL tsv_module_curve sv_module_curve SV_FN_DECL2;
 SV_FN_DECL tsv_get_number_of_module_ctls sv_get_number_of_module_ctls SV_FN_DECL2;
 SV_FN_DECL tsv_get_module_ctl_name sv_get_module_ctl_name SV_FN_DECL2;
@@ -842,6 +1038,12 @@ SV_FN_DECL tsv_pattern_mute sv_pattern_mute SV_FN_DECL2;
 SV_FN_DECL tsv_get_ticks sv_get_ticks SV_FN_DECL2;
 SV_FN_DECL tsv_get_ticks_per_second sv_get_ticks_per_second SV_FN_DECL2;
 SV_FN_DECL tsv_get_log sv_get_log SV_FN_DECL2;
+SV_FN_DECL tsv_profiler_enable sv_profiler_enable SV_FN_DECL2;
+SV_FN_DECL tsv_profiler_read sv_profiler_read SV_FN_DECL2;
+SV_FN_DECL tsv_profiler_get_module_stats sv_profiler_get_module_stats SV_FN_DECL2;
+SV_FN_DECL tsv_profiler_save_trace sv_profiler_save_trace SV_FN_DECL2;
+SV_FN_DECL tsv_profiler_reset sv_profiler_reset SV_FN_DECL2;
+SV_FN_DECL tsv_profiler_get_lost sv_profiler_get_lost SV_FN_DECL2;
 
 #ifdef SUNVOX_MAIN
 
@@ -895,6 +1097,7 @@ int sv_load_dll2( LIBNAME_STR_TYPE filename )
     {
 	IMPORT( g_sv_dll, tsv_audio_callback, "sv_audio_callback", sv_audio_callback );
 	IMPORT( g_sv_dll, tsv_audio_callback2, "sv_audio_callback2", sv_audio_callback2 );
+	IMPORT( g_sv_dll, tsv_audio_callback_planar, "sv_audio_callback_planar", sv_audio_callback_planar );
 	IMPORT( g_sv_dll, tsv_open_slot, "sv_open_slot", sv_open_slot );
 	IMPORT( g_sv_dll, tsv_close_slot, "sv_close_slot", sv_close_slot );
 	IMPORT( g_sv_dll, tsv_lock_slot, "sv_lock_slot", sv_lock_slot );
@@ -902,6 +1105,7 @@ int sv_load_dll2( LIBNAME_STR_TYPE filename )
 	IMPORT( g_sv_dll, tsv_init, "sv_init", sv_init );
 	IMPORT( g_sv_dll, tsv_deinit, "sv_deinit", sv_deinit );
 	IMPORT( g_sv_dll, tsv_get_sample_rate, "sv_get_sample_rate", sv_get_sample_rate );
+	IMPORT( g_sv_dll, tsv_set_sample_rate, "sv_set_sample_rate", sv_set_sample_rate );
 	IMPORT( g_sv_dll, tsv_update_input, "sv_update_input", sv_update_input );
 	IMPORT( g_sv_dll, tsv_load, "sv_load", sv_load );
 	IMPORT( g_sv_dll, tsv_load_from_memory, "sv_load_from_memory", sv_load_from_memory );
@@ -913,6 +1117,9 @@ int sv_load_dll2( LIBNAME_STR_TYPE filename )
 	IMPORT( g_sv_dll, tsv_pause, "sv_pause", sv_pause );
 	IMPORT( g_sv_dll, tsv_resume, "sv_resume", sv_resume );
 	IMPORT( g_sv_dll, tsv_sync_resume, "sv_sync_resume", sv_sync_resume );
+	IMPORT( g_sv_dll, tsv_play_async, "sv_play_async", sv_play_async );
+	IMPORT( g_sv_dll, tsv_stop_async, "sv_stop_async", sv_stop_async );
+	IMPORT( g_sv_dll, tsv_wait_command, "sv_wait_command", sv_wait_command );
 	IMPORT( g_sv_dll, tsv_set_autostop, "sv_set_autostop", sv_set_autostop );
 	IMPORT( g_sv_dll, tsv_get_autostop, "sv_get_autostop", sv_get_autostop );
 	IMPORT( g_sv_dll, tsv_end_of_song, "sv_end_of_song", sv_end_of_song );
@@ -920,6 +1127,7 @@ int sv_load_dll2( LIBNAME_STR_TYPE filename )
 	IMPORT( g_sv_dll, tsv_volume, "sv_volume", sv_volume );
 	IMPORT( g_sv_dll, tsv_set_event_t, "sv_set_event_t", sv_set_event_t );
 	IMPORT( g_sv_dll, tsv_send_event, "sv_send_event", sv_send_event );
+	IMPORT( g_sv_dll, tsv_send_events, "sv_send_events", sv_send_events );
 	IMPORT( g_sv_dll, tsv_get_current_line, "sv_get_current_line", sv_get_current_line );
 	IMPORT( g_sv_dll, tsv_get_current_line2, "sv_get_current_line2", sv_get_current_line2 );
 	IMPORT( g_sv_dll, tsv_get_current_signal_level, "sv_get_current_signal_level", sv_get_current_signal_level );
@@ -931,6 +1139,9 @@ int sv_load_dll2( LIBNAME_STR_TYPE filename )
 	IMPORT( g_sv_dll, tsv_get_song_length_frames, "sv_get_song_length_frames", sv_get_song_length_frames );
 	IMPORT( g_sv_dll, tsv_get_song_length_lines, "sv_get_song_length_lines", sv_get_song_length_lines );
 	IMPORT( g_sv_dll, tsv_get_time_map, "sv_get_time_map", sv_get_time_map );
+	IMPORT( g_sv_dll, tsv_get_frame_by_line, "sv_get_frame_by_line", sv_get_frame_by_line );
+	IMPORT( g_sv_dll, tsv_get_line_by_frame, "sv_get_line_by_frame", sv_get_line_by_frame );
+	IMPORT( g_sv_dll, tsv_get_line2_by_frame, "sv_get_line2_by_frame", sv_get_line2_by_frame );
 	IMPORT( g_sv_dll, tsv_new_module, "sv_new_module", sv_new_module );
 	IMPORT( g_sv_dll, tsv_remove_module, "sv_remove_module", sv_remove_module );
 	IMPORT( g_sv_dll, tsv_connect_module, "sv_connect_module", sv_connect_module );
@@ -944,6 +1155,8 @@ int sv_load_dll2( LIBNAME_STR_TYPE filename )
 	IMPORT( g_sv_dll, tsv_metamodule_load_from_memory, "sv_metamodule_load_from_memory", sv_metamodule_load_from_memory );
 	IMPORT( g_sv_dll, tsv_vplayer_load, "sv_vplayer_load", sv_vplayer_load );
 	IMPORT( g_sv_dll, tsv_vplayer_load_from_memory, "sv_vplayer_load_from_memory", sv_vplayer_load_from_memory );
+	IMPORT( g_sv_dll, tsv_vplayer_get_underruns, "sv_vplayer_get_underruns", sv_vplayer_get_underruns );
+	IMPORT( g_sv_dll, tsv_get_pipeline_latency, "sv_get_pipeline_latency", sv_get_pipeline_latency );
 	IMPORT( g_sv_dll, tsv_get_number_of_modules, "sv_get_number_of_modules", sv_get_number_of_modules );
 	IMPORT( g_sv_dll, tsv_find_module, "sv_find_module", sv_find_module );
 	IMPORT( g_sv_dll, tsv_get_module_flags, "sv_get_module_flags", sv_get_module_flags );
@@ -960,6 +1173,8 @@ int sv_load_dll2( LIBNAME_STR_TYPE filename )
 	IMPORT( g_sv_dll, tsv_set_module_finetune, "sv_set_module_finetune", sv_set_module_finetune );
 	IMPORT( g_sv_dll, tsv_set_module_relnote, "sv_set_module_relnote", sv_set_module_relnote );
 	IMPORT( g_sv_dll, tsv_get_module_scope2, "sv_get_module_scope2", sv_get_module_scope2 );
+	IMPORT( g_sv_dll, tsv_set_module_scope, "sv_set_module_scope", sv_set_module_scope );
+	IMPORT( g_sv_dll, tsv_get_module_peaks, "sv_get_module_peaks", sv_get_module_peaks );
 	IMPORT( g_sv_dll, tsv_module_curve, "sv_module_curve", sv_module_curve );
 	IMPORT( g_sv_dll, tsv_get_number_of_module_ctls, "sv_get_number_of_module_ctls", sv_get_number_of_module_ctls );
 	IMPORT( g_sv_dll, tsv_get_module_ctl_name, "sv_get_module_ctl_name", sv_get_module_ctl_name );
@@ -989,6 +1204,12 @@ int sv_load_dll2( LIBNAME_STR_TYPE filename )
 	IMPORT( g_sv_dll, tsv_get_ticks, "sv_get_ticks", sv_get_ticks );
 	IMPORT( g_sv_dll, tsv_get_ticks_per_second, "sv_get_ticks_per_second", sv_get_ticks_per_second );
 	IMPORT( g_sv_dll, tsv_get_log, "sv_get_log", sv_get_log );
+	IMPORT( g_sv_dll, tsv_profiler_enable, "sv_profiler_enable", sv_profiler_enable );
+	IMPORT( g_sv_dll, tsv_profiler_read, "sv_profiler_read", sv_profiler_read );
+	IMPORT( g_sv_dll, tsv_profiler_get_module_stats, "sv_profiler_get_module_stats", sv_profiler_get_module_stats );
+	IMPORT( g_sv_dll, tsv_profiler_save_trace, "sv_profiler_save_trace", sv_profiler_save_trace );
+	IMPORT( g_sv_dll, tsv_profiler_reset, "sv_profiler_reset", sv_profiler_reset );
+	IMPORT( g_sv_dll, tsv_profiler_get_lost, "sv_profiler_get_lost", sv_profiler_get_lost );
 	break;
     }
     if( fn_not_found )
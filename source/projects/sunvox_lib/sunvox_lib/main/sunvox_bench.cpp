@@ -0,0 +1,514 @@
+/*
+    sunvox_bench.cpp - headless render benchmark: projects and instruments -> xRT, block time percentiles, per-module cost (JSON)
+    This file is part of the SunVox Library.
+    Copyright (C) 2012 - 2025 Alexander Zolotov <nightradio@gmail.com>
+    warmplace.ru
+*/
+
+//Usage: sunvox_bench [options] [file1 file2 ...]
+//  -o FILE  JSON output file (default: stdout);
+//  -i DIR   directory with the default files (default: current directory);
+//  -b LIST  buffer sizes in frames (default: 32,64,128,256,512,1024,2048,4096);
+//  -r LIST  sample rates (default: 44100,48000,96000,192000);
+//  -d SEC   audio duration of each run (default: 10);
+//  -e TYPE[:CTL=VAL,gCTL=VAL,...]  effect micro-benchmark (can be repeated): Generator -> effect module TYPE -> Output;
+//           CTL=VAL - controller values (CTL = controller number from 0); gCTL=VAL - Generator controller values;
+//           example: -e Reverb:6=2,7=0 -e "Filter Pro:g6=0,1=1,12=512" (stereo Generator)
+//  -c DIR   compare the output of each run with the reference file in DIR (float32 stereo; the file is created if it doesn't exist);
+//           use it to check that an optimization doesn't change the sound: run once with the old build, then with the new one;
+//  -t DB    max allowed difference from the reference in dBFS (default: -120); a larger difference is reported as an error;
+//Files: *.sunvox - the project is played from the beginning; other formats (sunsynth, xi, wav, ...) - the module is connected
+//to the Output and played by a chord which is retriggered every 250 ms.
+//Default files: song01.sunvox song02.sunvox song03.sunvox song04.sunvox organ.sunsynth flute.xi (SunVox Library resources).
+//The engine works in the same mode as sunvox_render (one thread, no sound device); the loading time is not measured.
+
+#define SVH_INLINES
+#include "sundog.h"
+#include "sunvox_engine.h"
+#include "sunvox_engine_helper.h"
+#include "psynth/psynths_sampler.h"
+
+#define BENCH_CHANNELS 2
+#define BENCH_MAX_LIST 16
+#define BENCH_MAX_MOD_TYPES 64
+#define BENCH_CHORD_NOTES 4
+
+struct bench_mod_type
+{
+    const char*		name;
+    int			count;
+    stime_ticks_t	ticks;
+};
+
+struct bench_result
+{
+    int			rv; //0 - ok
+    uint32_t		frames;
+    uint32_t		blocks;
+    stime_ns_t		time; //total rendering time
+    stime_ns_t		block_time[ 5 ]; //p50, p90, p99, p99.9, max
+    stime_ns_t		block_budget; //buffer duration
+    uint32_t		overruns; //blocks rendered slower than realtime
+    bench_mod_type	mod_types[ BENCH_MAX_MOD_TYPES ];
+    int			mod_types_num;
+    int			ref; //-c: 0 - off; 1 - reference created; 2 - compared; 3 - the reference length doesn't match
+    double		ref_diff; //max absolute difference from the reference
+};
+
+static const char* g_default_files[] = { "song01.sunvox", "song02.sunvox", "song03.sunvox", "song04.sunvox", "organ.sunsynth", "flute.xi", NULL };
+static int g_buf_sizes[ BENCH_MAX_LIST ] = { 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+static int g_buf_sizes_num = 8;
+static int g_freqs[ BENCH_MAX_LIST ] = { 44100, 48000, 96000, 192000 };
+static int g_freqs_num = 4;
+static int g_duration = 10; //seconds
+static const char* g_ref_dir = NULL;
+static double g_ref_tolerance = -120; //dBFS
+
+static int parse_list( const char* v, int* list )
+{
+    int num = 0;
+    while( *v && num < BENCH_MAX_LIST )
+    {
+	int n = atoi( v );
+	if( n <= 0 ) return 0;
+	list[ num++ ] = n;
+	while( *v && *v != ',' ) v++;
+	if( *v == ',' ) v++;
+    }
+    return num;
+}
+
+static int cmp_ns( const void* a, const void* b )
+{
+    stime_ns_t v1 = *(const stime_ns_t*)a;
+    stime_ns_t v2 = *(const stime_ns_t*)b;
+    if( v1 < v2 ) return -1;
+    if( v1 > v2 ) return 1;
+    return 0;
+}
+
+static const char* get_mod_type( int mod_num, psynth_net* net )
+{
+    if( mod_num == 0 ) return "Output";
+    psynth_module* m = &net->mods[ mod_num ];
+    psynth_event evt = {};
+    evt.command = PS_CMD_GET_NAME;
+    const char* rv = (const char*)m->handler( mod_num, &evt, net );
+    if( !rv ) rv = "";
+    return rv;
+}
+
+static void add_mod_ticks( bench_result* r, psynth_net* net, bool count )
+{
+    for( uint i = 0; i < net->mods_num; i++ )
+    {
+	psynth_module* m = &net->mods[ i ];
+	if( !( m->flags & PSYNTH_FLAG_EXISTS ) ) continue;
+	const char* name = get_mod_type( i, net );
+	int t = 0;
+	for( t = 0; t < r->mod_types_num; t++ )
+	    if( strcmp( r->mod_types[ t ].name, name ) == 0 ) break;
+	if( t == r->mod_types_num )
+	{
+	    if( t >= BENCH_MAX_MOD_TYPES ) continue;
+	    r->mod_types[ t ].name = name;
+	    r->mod_types_num++;
+	}
+	if( count ) r->mod_types[ t ].count++;
+	r->mod_types[ t ].ticks += m->cpu_usage_ticks;
+    }
+}
+
+static int add_effect( const char* spec, sunvox_engine* s ) //spec: TYPE[:CTL=VAL,gCTL=VAL,...]
+{
+    char type[ 64 ];
+    int i = 0;
+    for( ; spec[ i ] && spec[ i ] != ':' && i < (int)sizeof( type ) - 1; i++ ) type[ i ] = spec[ i ];
+    type[ i ] = 0;
+    PS_RETTYPE (*handler)( PSYNTH_MODULE_HANDLER_PARAMETERS ) = get_module_handler_by_name( type, s );
+    if( handler == psynth_empty ) return -1;
+    int gen = psynth_add_module( -1, get_module_handler_by_name( "Generator", s ), "Generator", 0, 256, 512, 0, s->bpm, s->speed, s->net );
+    int fx = psynth_add_module( -1, handler, type, 0, 512, 512, 0, s->bpm, s->speed, s->net );
+    if( gen <= 0 || fx <= 0 ) return -1;
+    psynth_do_command( gen, PS_CMD_SETUP_FINISHED, s->net );
+    psynth_do_command( fx, PS_CMD_SETUP_FINISHED, s->net );
+    psynth_make_link( fx, gen, s->net );
+    psynth_make_link( 0, fx, s->net );
+    const char* p = spec + i;
+    while( *p == ':' || *p == ',' )
+    {
+	p++;
+	int mod = fx;
+	if( *p == 'g' ) { mod = gen; p++; }
+	int ctl = atoi( p );
+	while( *p && *p != '=' && *p != ',' ) p++;
+	if( *p != '=' ) break;
+	p++;
+	int val = atoi( p );
+	while( *p && *p != ',' ) p++;
+	svh_set_module_ctl_value( s, stime_ticks(), mod, ctl, val, 0 );
+    }
+    return gen;
+}
+
+static char* make_ref_name( const char* name, bool effect, int freq, int buf_size )
+{
+    if( !effect ) name = sfs_get_filename_without_dir( name );
+    size_t dir_len = smem_strlen( g_ref_dir ) + 1;
+    size_t name_len = smem_strlen( name );
+    char* rv = SMEM_ALLOC2( char, dir_len + name_len + 32 );
+    if( !rv ) return NULL;
+    sprintf( rv, "%s/", g_ref_dir );
+    for( size_t i = 0; i < name_len; i++ )
+    {
+	char c = name[ i ];
+	if( !( ( c >= '0' && c <= '9' ) || ( c >= 'a' && c <= 'z' ) || ( c >= 'A' && c <= 'Z' ) || c == '.' || c == '-' ) ) c = '_';
+	rv[ dir_len + i ] = c;
+    }
+    sprintf( rv + dir_len + name_len, "_%d_%d.raw", freq, buf_size );
+    return rv;
+}
+
+static bool ref_ok( bench_result* r )
+{
+    if( r->ref == 3 ) return false;
+    if( r->ref != 2 || r->ref_diff == 0 ) return true;
+    return 20 * log10( r->ref_diff ) <= g_ref_tolerance;
+}
+
+static bool is_project( const char* name )
+{
+    const char* ext = sfs_get_filename_extension( name );
+    return ext && strcmp( ext, "sunvox" ) == 0;
+}
+
+static void bench_run( const char* name, bool effect, int freq, int buf_size, bench_result* r )
+{
+    smem_clear( r, sizeof( bench_result ) );
+    sunvox_engine* s = SMEM_ALLOC2( sunvox_engine, 1 );
+    void* buf = SMEM_ALLOC( buf_size * BENCH_CHANNELS * sizeof( float ) );
+    uint32_t frames = g_duration * freq;
+    uint32_t blocks = ( frames + buf_size - 1 ) / buf_size;
+    stime_ns_t* block_time = SMEM_ALLOC2( stime_ns_t, blocks );
+    uint engine_flags =
+	SUNVOX_FLAG_PLAYER_ONLY | SUNVOX_FLAG_NO_GUI | SUNVOX_FLAG_NO_SCOPE | SUNVOX_FLAG_NO_MIDI | SUNVOX_FLAG_NO_GLOBAL_SYS_EVENTS |
+	SUNVOX_FLAG_NO_KBD_EVENTS | SUNVOX_FLAG_ONE_THREAD | SUNVOX_FLAG_EXPORT;
+    int mod_num = -1;
+    sfs_file ref_f = 0;
+    float* ref_buf = NULL;
+    if( !s || !buf || !block_time ) { r->rv = -1; goto bench_end; }
+    if( g_ref_dir )
+    {
+	char* ref_name = make_ref_name( name, effect, freq, buf_size );
+	if( !ref_name ) { r->rv = -1; goto bench_end; }
+	ref_f = sfs_open( ref_name, "rb" );
+	if( ref_f )
+	{
+	    r->ref = 2;
+	    ref_buf = SMEM_ALLOC2( float, buf_size * BENCH_CHANNELS );
+	}
+	else
+	{
+	    r->ref = 1;
+	    ref_f = sfs_open( ref_name, "wb" );
+	}
+	smem_free( ref_name );
+	if( !ref_f || ( r->ref == 2 && !ref_buf ) ) { r->rv = -4; goto bench_end; }
+    }
+    sunvox_engine_init( engine_flags, freq, 0, 0, 0, 0, s );
+    if( effect )
+    {
+	mod_num = add_effect( name, s );
+	if( mod_num <= 0 ) { r->rv = -3; goto bench_close; }
+    }
+    else if( is_project( name ) )
+    {
+	if( sunvox_load_proj( name, 0, s ) ) { r->rv = -2; goto bench_close; }
+	sunvox_play( 0, true, -1, s );
+    }
+    else
+    {
+	mod_num = sunvox_load_module( -1, 512, 512, 0, name, 0, s );
+	if( mod_num <= 0 )
+	{
+	    //Sample (xi, wav, ...) -> Sampler (the same as in sv_load_module()):
+	    mod_num = psynth_add_module( -1, get_module_handler_by_name( "Sampler", s ), "Sampler", 0, 512, 512, 0, s->bpm, s->speed, s->net );
+	    if( mod_num <= 0 ) { r->rv = -3; goto bench_close; }
+	    psynth_do_command( mod_num, PS_CMD_SETUP_FINISHED, s->net );
+	    if( sampler_load( name, 0, mod_num, s->net, -1, 0 ) ) { r->rv = -3; goto bench_close; }
+	}
+	psynth_make_link( 0, mod_num, s->net );
+    }
+    s->net->cpu_usage_enable = 1;
+    {
+	sunvox_render_data rdata;
+	stime_ticks_t t = stime_ticks();
+	uint32_t ptr = 0;
+	uint32_t next_chord = 0;
+	bool chord = false;
+	for( uint32_t b = 0; b < blocks; b++ )
+	{
+	    int size = buf_size;
+	    if( ptr + size > frames ) size = frames - ptr;
+	    if( mod_num > 0 && ptr >= next_chord )
+	    {
+		for( int n = 0; n < BENCH_CHORD_NOTES; n++ )
+		{
+		    if( chord ) svh_send_event( s, t, n, NOTECMD_NOTE_OFF, 0, mod_num + 1, 0, 0 );
+		    svh_send_event( s, t, n, 4 * 12 + 1 + n * 4, 0, mod_num + 1, 0, 0 );
+		}
+		chord = true;
+		next_chord += freq / 4;
+	    }
+	    SMEM_CLEAR_STRUCT( rdata );
+	    rdata.buffer_type = sound_buffer_float32;
+	    rdata.buffer = buf;
+	    rdata.frames = size;
+	    rdata.channels = BENCH_CHANNELS;
+	    rdata.out_time = t;
+	    stime_ns_t t1 = stime_ns();
+	    sunvox_render_piece_of_sound( &rdata, s );
+	    stime_ns_t t2 = stime_ns() - t1;
+	    block_time[ b ] = t2;
+	    r->time += t2;
+	    add_mod_ticks( r, s->net, b == 0 );
+	    if( ref_f )
+	    {
+		float* out = (float*)buf;
+		size_t len = size * BENCH_CHANNELS;
+		if( r->ref == 1 )
+		    sfs_write( out, sizeof( float ), len, ref_f );
+		else if( r->ref == 2 )
+		{
+		    if( sfs_read( ref_buf, sizeof( float ), len, ref_f ) != len )
+			r->ref = 3;
+		    else
+		    {
+			for( size_t i = 0; i < len; i++ )
+			{
+			    double d = fabs( (double)out[ i ] - ref_buf[ i ] );
+			    if( d > r->ref_diff ) r->ref_diff = d;
+			}
+		    }
+		}
+	    }
+	    t += (stime_ticks_t)( ( (uint64_t)size * stime_ticks_per_second() ) / freq );
+	    ptr += size;
+	}
+	if( mod_num < 0 ) sunvox_stop( s );
+	if( r->ref == 2 && sfs_getc( ref_f ) >= 0 ) r->ref = 3;
+	r->frames = frames;
+	r->blocks = blocks;
+	r->block_budget = (stime_ns_t)( (uint64_t)buf_size * 1000000000 / freq );
+	for( uint32_t b = 0; b < blocks; b++ )
+	    if( block_time[ b ] > r->block_budget ) r->overruns++;
+	qsort( block_time, blocks, sizeof( stime_ns_t ), cmp_ns );
+	r->block_time[ 0 ] = block_time[ (uint64_t)( blocks - 1 ) * 500 / 1000 ];
+	r->block_time[ 1 ] = block_time[ (uint64_t)( blocks - 1 ) * 900 / 1000 ];
+	r->block_time[ 2 ] = block_time[ (uint64_t)( blocks - 1 ) * 990 / 1000 ];
+	r->block_time[ 3 ] = block_time[ (uint64_t)( blocks - 1 ) * 999 / 1000 ];
+	r->block_time[ 4 ] = block_time[ blocks - 1 ];
+    }
+bench_close:
+    sunvox_engine_close( s );
+bench_end:
+    if( ref_f ) sfs_close( ref_f );
+    smem_free( ref_buf );
+    smem_free( block_time );
+    smem_free( buf );
+    smem_free( s );
+}
+
+static void print_json_str( FILE* f, const char* str )
+{
+    fputc( '"', f );
+    for( ; *str; str++ )
+    {
+	int c = (uint8_t)*str;
+	if( c == '"' || c == '\\' ) fprintf( f, "\\%c", c );
+	else if( c < 32 ) fprintf( f, "\\u%04x", c );
+	else fputc( c, f );
+    }
+    fputc( '"', f );
+}
+
+static void print_json_result( FILE* f, const char* name, bool effect, int freq, int buf_size, bench_result* r )
+{
+    if( effect )
+    {
+	fprintf( f, "    { \"effect\": " );
+	print_json_str( f, name );
+    }
+    else
+    {
+	fprintf( f, "    { \"file\": " );
+	print_json_str( f, sfs_get_filename_without_dir( name ) );
+    }
+    fprintf( f, ", \"rate\": %d, \"buffer\": %d, ", freq, buf_size );
+    if( r->rv )
+    {
+	fprintf( f, "\"error\": %d }", r->rv );
+	return;
+    }
+    double secs = (double)r->time / 1000000000.0;
+    double audio_secs = (double)r->frames / freq;
+    fprintf( f, "\"frames\": %u, \"time_ms\": %.3f, \"xrt\": %.2f,\n", r->frames, secs * 1000, secs > 0 ? audio_secs / secs : 0 );
+    fprintf( f, "      \"block_us\": { \"budget\": %.2f, \"p50\": %.2f, \"p90\": %.2f, \"p99\": %.2f, \"p999\": %.2f, \"max\": %.2f, \"overruns\": %u },\n",
+	(double)r->block_budget / 1000, (double)r->block_time[ 0 ] / 1000, (double)r->block_time[ 1 ] / 1000, (double)r->block_time[ 2 ] / 1000,
+	(double)r->block_time[ 3 ] / 1000, (double)r->block_time[ 4 ] / 1000, r->overruns );
+    if( r->ref == 1 ) fprintf( f, "      \"ref\": \"created\",\n" );
+    if( r->ref == 2 )
+    {
+	fprintf( f, "      \"ref\": \"compared\", \"ref_diff\": %g, ", r->ref_diff );
+	if( r->ref_diff > 0 ) fprintf( f, "\"ref_diff_db\": %.1f, ", 20 * log10( r->ref_diff ) );
+	fprintf( f, "\"ref_ok\": %s,\n", ref_ok( r ) ? "true" : "false" );
+    }
+    if( r->ref == 3 ) fprintf( f, "      \"ref\": \"length mismatch\", \"ref_ok\": false,\n" );
+    fprintf( f, "      \"modules\": [" );
+    for( int t = 0; t < r->mod_types_num; t++ )
+    {
+	bench_mod_type* mt = &r->mod_types[ t ];
+	double mt_secs = (double)mt->ticks / stime_ticks_per_second();
+	fprintf( f, "%s\n        { \"type\": ", t ? "," : "" );
+	print_json_str( f, mt->name );
+	fprintf( f, ", \"count\": %d, \"time_ms\": %.3f, \"share\": %.4f }", mt->count, mt_secs * 1000, secs > 0 ? mt_secs / secs : 0 );
+    }
+    fprintf( f, " ] }" );
+}
+
+static void print_usage()
+{
+    printf(
+	"Usage: sunvox_bench [options] [file1 file2 ...]\n"
+	"  -o FILE  JSON output file (default: stdout)\n"
+	"  -i DIR   directory with the default files (default: current directory)\n"
+	"  -b LIST  buffer sizes in frames (default: 32,64,128,256,512,1024,2048,4096)\n"
+	"  -r LIST  sample rates (default: 44100,48000,96000,192000)\n"
+	"  -d SEC   audio duration of each run (default: 10)\n"
+	"  -e TYPE[:CTL=VAL,gCTL=VAL,...]  effect micro-benchmark: Generator -> TYPE -> Output (can be repeated)\n"
+	"  -c DIR   compare the output with the reference files in DIR (missing files are created)\n"
+	"  -t DB    max allowed difference from the reference in dBFS (default: -120)\n"
+	"Default files: song01.sunvox song02.sunvox song03.sunvox song04.sunvox organ.sunsynth flute.xi\n" );
+}
+
+int main( int argc, char* argv[] )
+{
+    const char* out_name = NULL;
+    const char* in_dir = NULL;
+    const char** files = (const char**)malloc( sizeof( const char* ) * ( argc + 8 ) );
+    int files_num = 0;
+    const char** effects = (const char**)malloc( sizeof( const char* ) * ( argc + 1 ) );
+    int effects_num = 0;
+    if( !files || !effects ) return 1;
+    for( int i = 1; i < argc; i++ )
+    {
+	const char* a = argv[ i ];
+	if( a[ 0 ] == '-' && a[ 1 ] && a[ 2 ] == 0 && i + 1 < argc )
+	{
+	    const char* v = argv[ ++i ];
+	    switch( a[ 1 ] )
+	    {
+		case 'o': out_name = v; break;
+		case 'i': in_dir = v; break;
+		case 'b': g_buf_sizes_num = parse_list( v, g_buf_sizes ); break;
+		case 'r': g_freqs_num = parse_list( v, g_freqs ); break;
+		case 'd': g_duration = atoi( v ); break;
+		case 'e': effects[ effects_num++ ] = v; break;
+		case 'c': g_ref_dir = v; break;
+		case 't': g_ref_tolerance = atof( v ); break;
+		default: print_usage(); free( files ); free( effects ); return 1;
+	    }
+	    continue;
+	}
+	files[ files_num++ ] = a;
+    }
+    bool bad_freq = false;
+    for( int i = 0; i < g_freqs_num; i++ ) if( g_freqs[ i ] < 44100 ) bad_freq = true;
+    if( g_buf_sizes_num == 0 || g_freqs_num == 0 || bad_freq || g_duration <= 0 )
+    {
+	print_usage();
+	free( files );
+	free( effects );
+	return 1;
+    }
+
+    sundog_global_init();
+    slog_disable( 1, 1 );
+
+    char** default_names = NULL;
+    if( files_num == 0 && effects_num == 0 )
+    {
+	int num = 0;
+	while( g_default_files[ num ] ) num++;
+	default_names = SMEM_ZALLOC2( char*, num );
+	for( int i = 0; i < num; i++ )
+	{
+	    if( in_dir )
+	    {
+		default_names[ i ] = SMEM_ALLOC2( char, smem_strlen( in_dir ) + 1 + smem_strlen( g_default_files[ i ] ) + 1 );
+		sprintf( default_names[ i ], "%s/%s", in_dir, g_default_files[ i ] );
+		files[ files_num++ ] = default_names[ i ];
+	    }
+	    else
+		files[ files_num++ ] = g_default_files[ i ];
+	}
+    }
+
+    FILE* f = stdout;
+    if( out_name )
+    {
+	f = fopen( out_name, "wb" );
+	if( !f ) { printf( "Can't open %s\n", out_name ); f = stdout; }
+    }
+
+    int errors = 0;
+    bench_result* r = (bench_result*)malloc( sizeof( bench_result ) );
+    fprintf( f, "{\n  \"engine\": \"%s\", \"duration\": %d,\n  \"runs\": [\n", SUNVOX_ENGINE_VERSION_STR, g_duration );
+    bool first = true;
+    for( int i = 0; i < files_num + effects_num; i++ )
+    {
+	bool effect = i >= files_num;
+	const char* name = effect ? effects[ i - files_num ] : files[ i ];
+	for( int fr = 0; fr < g_freqs_num; fr++ )
+	{
+	    for( int bs = 0; bs < g_buf_sizes_num; bs++ )
+	    {
+		bench_run( name, effect, g_freqs[ fr ], g_buf_sizes[ bs ], r );
+		if( r->rv ) errors++;
+		else if( !ref_ok( r ) ) errors++;
+		if( !first ) fprintf( f, ",\n" );
+		first = false;
+		print_json_result( f, name, effect, g_freqs[ fr ], g_buf_sizes[ bs ], r );
+		fflush( f );
+		if( f != stdout )
+		{
+		    if( r->rv )
+			printf( "%s %d Hz %d: ERROR %d\n", name, g_freqs[ fr ], g_buf_sizes[ bs ], r->rv );
+		    else
+		    {
+			printf( "%s %d Hz %d: %.1f xRT", name, g_freqs[ fr ], g_buf_sizes[ bs ], r->time ? (double)r->frames / g_freqs[ fr ] / ( (double)r->time / 1000000000.0 ) : 0 );
+			if( r->ref == 2 && r->ref_diff == 0 ) printf( "; ref diff 0" );
+			if( r->ref == 2 && r->ref_diff > 0 ) printf( "; ref diff %.1f dB%s", 20 * log10( r->ref_diff ), ref_ok( r ) ? "" : " ERROR" );
+			if( r->ref == 3 ) printf( "; ref length mismatch" );
+			printf( "\n" );
+		    }
+		    fflush( stdout );
+		}
+	    }
+	}
+    }
+    fprintf( f, "\n  ],\n  \"errors\": %d\n}\n", errors );
+    if( f != stdout ) fclose( f );
+    free( r );
+
+    if( default_names )
+    {
+	for( int i = 0; i < files_num; i++ ) smem_free( default_names[ i ] );
+	smem_free( default_names );
+    }
+    sundog_global_deinit();
+    free( files );
+    free( effects );
+
+    return errors ? 1 : 0;
+}
@@ -30,7 +30,7 @@
     #define SUNVOX_EXPORT
 #endif
 
-const char* g_app_config[] = { "1:/sunvox_dll_config.ini", "2:/sunvox_dll_config.ini", "0" };
+const char* g_app_config[] = { "1:/sunvox_dll_config.ini", "2:/sunvox_dll_config.ini", 0 };
 const char* g_app_log = "3:/sunvox_dll_log.txt";
 const char* g_app_name = "SunVox Library";
 const char* g_app_name_short = "SunVox Library";
@@ -221,6 +221,12 @@ SUNVOX_EXPORT int sv_audio_callback2( void* buf, int frames, int latency, stime_
     if( in_type == 1 ) type = sound_buffer_float32;
     return user_controlled_sound_callback( g_sound, buf, frames, latency, out_time, type, in_channels, in_buf );
 }
+SUNVOX_EXPORT int sv_audio_callback_planar( void** buf, int frames, int latency, stime_ticks_t out_time, int type, int in_channels, void** in_buf )
+{
+    sound_buffer_type t = sound_buffer_float32;
+    if( type == 2 ) t = sound_buffer_float64;
+    return user_controlled_sound_callback_planar( g_sound, buf, frames, latency, out_time, t, in_channels, in_buf );
+}
 #ifdef OS_ANDROID
 SUNVOX_EXPORT JNIEXPORT jint JNICALL Java_nightradio_sunvoxlib_SunVoxLib_audio_1callback( JNIEnv* je, jclass jc, jbyteArray buf, jint frames, jint latency, jint out_time )
 {
@@ -240,6 +246,38 @@ SUNVOX_EXPORT JNIEXPORT jint JNICALL Java_nightradio_sunvoxlib_SunVoxLib_audio_1
     je->ReleaseByteArrayElements( in_buf, c_buf2, 0 );
     return rv;
 }
+SUNVOX_EXPORT JNIEXPORT jint JNICALL Java_nightradio_sunvoxlib_SunVoxLib_audio_1callback_1planar( JNIEnv* je, jclass jc, jobjectArray buf, jint frames, jint latency, jint out_time, jint type, jint in_channels, jobjectArray in_buf )
+{
+    //buf, in_buf: float[][] (type 1) or double[][] (type 2); one array per channel:
+    jarray a[ SUNDOG_SOUND_PLANAR_CHANNELS * 2 ];
+    void* c_buf[ SUNDOG_SOUND_PLANAR_CHANNELS * 2 ];
+    int out_channels = g_sv_channels;
+    if( out_channels > SUNDOG_SOUND_PLANAR_CHANNELS || je->GetArrayLength( buf ) < out_channels ) return 0;
+    if( !in_buf ) in_channels = 0;
+    else if( in_channels > je->GetArrayLength( in_buf ) ) in_channels = je->GetArrayLength( in_buf );
+    if( in_channels > SUNDOG_SOUND_PLANAR_CHANNELS ) in_channels = SUNDOG_SOUND_PLANAR_CHANNELS;
+    int n = 0;
+    for( int i = 0; i < out_channels; i++ ) a[ n++ ] = (jarray)je->GetObjectArrayElement( buf, i );
+    for( int i = 0; i < in_channels; i++ ) a[ n++ ] = (jarray)je->GetObjectArrayElement( in_buf, i );
+    for( int i = 0; i < n; i++ )
+    {
+	if( type == 2 )
+	    c_buf[ i ] = je->GetDoubleArrayElements( (jdoubleArray)a[ i ], NULL );
+	else
+	    c_buf[ i ] = je->GetFloatArrayElements( (jfloatArray)a[ i ], NULL );
+    }
+    int rv = sv_audio_callback_planar( c_buf, frames, latency, out_time, type, in_channels, in_channels ? c_buf + out_channels : NULL );
+    for( int i = 0; i < n; i++ )
+    {
+	int mode = ( i >= out_channels ) ? JNI_ABORT : 0; //don't copy the input back
+	if( type == 2 )
+	    je->ReleaseDoubleArrayElements( (jdoubleArray)a[ i ], (jdouble*)c_buf[ i ], mode );
+	else
+	    je->ReleaseFloatArrayElements( (jfloatArray)a[ i ], (jfloat*)c_buf[ i ], mode );
+	je->DeleteLocalRef( a[ i ] );
+    }
+    return rv;
+}
 #endif
 
 int render_piece_of_sound( sundog_sound* ss, int slot_num )
@@ -258,14 +296,28 @@ int render_piece_of_sound( sundog_sound* ss, int slot_num )
     SMEM_CLEAR_STRUCT( rdata );
     rdata.buffer_type = ss->out_type;
     rdata.buffer = slot->buffer;
+    if( slot->planar )
+    {
+	rdata.buffer_type = ss->planar_type;
+	rdata.buffer = NULL;
+	rdata.planar = slot->planar;
+    }
     rdata.frames = slot->frames;
     rdata.channels = ss->out_channels;
     rdata.out_latency = ss->out_latency;
     rdata.out_latency2 = ss->out_latency2;
     rdata.out_time = slot->time;
-    rdata.in_buffer = slot->in_buffer;
     rdata.in_type = ss->in_type;
     rdata.in_channels = ss->in_channels;
+    if( ss->in_planar )
+    {
+	rdata.in_type = ss->planar_type;
+	rdata.in_planar = (void**)slot->in_buffer;
+    }
+    else
+    {
+	rdata.in_buffer = slot->in_buffer;
+    }
 
     handled = sunvox_render_piece_of_sound( &rdata, s );
 
@@ -350,6 +402,22 @@ static bool is_sv_locked( int slot, const char* fn_name )
     return true;
 }
 
+static uint sv_engine_flags()
+{
+    uint flags = SUNVOX_FLAG_CREATE_PATTERN | SUNVOX_FLAG_CREATE_MODULES | SUNVOX_FLAG_MAIN;
+    if( g_sv_flags & SV_INIT_FLAG_ONE_THREAD ) flags |= SUNVOX_FLAG_ONE_THREAD;
+    return flags;
+}
+static void sv_slot_engine_init( int slot )
+{
+    sunvox_engine_init( 
+	sv_engine_flags(), 
+	g_sound->freq,
+	0, 0, sv_sound_stream_control, (void*)((size_t)slot), g_sv[ slot ] );
+    sundog_sound_set_slot_callback( g_sound, slot, &render_piece_of_sound, g_sv[ slot ] );
+    sundog_sound_play( g_sound, slot );
+}
+
 SUNVOX_EXPORT int sv_open_slot( int slot )
 {
     if( (unsigned)slot >= (unsigned)SUNDOG_SOUND_SLOTS )
@@ -358,16 +426,9 @@ SUNVOX_EXPORT int sv_open_slot( int slot )
 	slog( "Wrong slot number %d! Correct values: 0...%d\n", slot, SUNDOG_SOUND_SLOTS - 1 );
 	return -1;
     }
-    uint flags = 0;
-    if( g_sv_flags & SV_INIT_FLAG_ONE_THREAD ) flags |= SUNVOX_FLAG_ONE_THREAD;
     g_sv[ slot ] = SMEM_ALLOC2( sunvox_engine, 1 );
     g_sv_locked[ slot ] = 0;
-    sunvox_engine_init( 
-	SUNVOX_FLAG_CREATE_PATTERN | SUNVOX_FLAG_CREATE_MODULES | SUNVOX_FLAG_MAIN | flags, 
-	g_sound->freq,
-	0, 0, sv_sound_stream_control, (void*)((size_t)slot), g_sv[ slot ] );
-    sundog_sound_set_slot_callback( g_sound, slot, &render_piece_of_sound, g_sv[ slot ] );
-    sundog_sound_play( g_sound, slot );
+    sv_slot_engine_init( slot );
     return 0;
 }
 #ifdef OS_ANDROID
@@ -394,6 +455,131 @@ SUNVOX_EXPORT JNIEXPORT jint JNICALL Java_nightradio_sunvoxlib_SunVoxLib_close_1
 }
 #endif
 
+//Change the sample rate without closing the slots:
+//each engine is rebuilt at the new rate (detached from the sound stream) from the in-memory copy of its project;
+//then the new engines replace the old ones under the sound lock, together with the queued commands and events
+struct sv_scope_state
+{
+    uint	mod_num;
+    uint	flags;
+    int		peak_frames;
+};
+SUNVOX_EXPORT int sv_set_sample_rate( int freq )
+{
+    if( !g_sv_initialized ) return -1;
+    if( !( g_sv_flags & SV_INIT_FLAG_USER_AUDIO_CALLBACK ) ) return -1; //system audio stream: the rate is set by the device
+#ifdef MIN_SAMPLE_RATE
+    if( freq < MIN_SAMPLE_RATE ) return -1;
+#endif
+    if( freq <= 0 ) return -1;
+    if( freq == g_sound->freq ) return 0;
+    //Build the new engines; if one of the projects can't be saved or restored, nothing is changed:
+    sunvox_engine* new_sv[ SUNDOG_SOUND_SLOTS ];
+    int rv = 0;
+    for( int slot = 0; slot < SUNDOG_SOUND_SLOTS; slot++ )
+    {
+	new_sv[ slot ] = NULL;
+	sunvox_engine* s = g_sv[ slot ];
+	if( !s || rv ) continue;
+	void* data = NULL;
+	size_t size = 0;
+	sfs_file f = sfs_open_in_memory( SMEM_ALLOC( 16 ), 0 );
+	if( f )
+	{
+	    if( sunvox_save_proj_to_fd( f, 0, s ) == 0 )
+		size = sfs_get_data_size( f );
+	    data = sfs_get_data( f );
+	    sfs_close( f );
+	}
+	if( size == 0 )
+	{
+	    slog( "sv_set_sample_rate(): can't save the project in slot %d\n", slot );
+	    smem_free( data );
+	    rv = -1;
+	    continue;
+	}
+	sunvox_engine* s2 = SMEM_ALLOC2( sunvox_engine, 1 );
+	int load_rv = -1;
+	if( s2 )
+	{
+	    sunvox_engine_init( sv_engine_flags() | SUNVOX_FLAG_ONE_THREAD, freq, 0, 0, NULL, NULL, s2 ); //detached: the commands are handled immediately
+	    f = sfs_open_in_memory( data, size );
+	    if( f )
+	    {
+		sfs_set_discard( f ); //the saved copy is not needed after loading
+		load_rv = sunvox_load_proj_from_fd( f, 0, s2 );
+		sfs_close( f );
+	    }
+	    new_sv[ slot ] = s2;
+	}
+	smem_free( data );
+	if( load_rv )
+	{
+	    slog( "sv_set_sample_rate(): can't restore the project in slot %d\n", slot );
+	    rv = -1;
+	    continue;
+	}
+	s2->net->global_volume = s->net->global_volume;
+	s2->stop_at_the_end_of_proj = s->stop_at_the_end_of_proj;
+	if( s->playing )
+	    sunvox_play( s->line_counter, true, -1, s2 );
+	else
+	    sunvox_rewind( s->line_counter, -1, s2 );
+	//Module scope subscriptions (sv_set_module_scope(), sv_get_module_scope2()):
+	for( uint i = 0; i < s->net->mods_num && i < s2->net->mods_num; i++ )
+	{
+	    psynth_module* m = &s->net->mods[ i ];
+	    if( !( m->flags & PSYNTH_FLAG_EXISTS ) || !m->scope_flags ) continue;
+	    psynth_set_scope( i, m->scope_flags, m->peaks ? m->peaks->resolution : 0, s2->net );
+	}
+    }
+    if( rv )
+    {
+	for( int slot = 0; slot < SUNDOG_SOUND_SLOTS; slot++ )
+	{
+	    if( !new_sv[ slot ] ) continue;
+	    sunvox_engine_close( new_sv[ slot ] );
+	    smem_free( new_sv[ slot ] );
+	}
+	return rv;
+    }
+    //Replace the engines (the audio callback is not running during the swap):
+    sundog_sound_lock( g_sound );
+    for( int slot = 0; slot < SUNDOG_SOUND_SLOTS; slot++ )
+    {
+	sunvox_engine* s = g_sv[ slot ];
+	sunvox_engine* s2 = new_sv[ slot ];
+	if( !s ) continue;
+	int paused = sundog_sound_is_slot_suspended( g_sound, slot );
+	sunvox_move_queued_commands_UNSAFE( s2, s );
+	s2->flags = ( s2->flags & ~SUNVOX_FLAG_ONE_THREAD ) | ( s->flags & SUNVOX_FLAG_ONE_THREAD );
+	s2->stream_control = sv_sound_stream_control;
+	s2->stream_control_data = (void*)((size_t)slot);
+	s->stream_control = NULL;
+	g_sv[ slot ] = s2;
+	new_sv[ slot ] = s; //old engine: will be closed below
+	sundog_sound_set_slot_callback( g_sound, slot, &render_piece_of_sound, s2 );
+	if( !paused ) sundog_sound_play( g_sound, slot );
+    }
+    g_sound->freq = freq;
+    g_sv_freq = freq;
+    sundog_sound_unlock( g_sound );
+    for( int slot = 0; slot < SUNDOG_SOUND_SLOTS; slot++ )
+    {
+	if( !new_sv[ slot ] ) continue;
+	sunvox_engine_close( new_sv[ slot ] );
+	smem_free( new_sv[ slot ] );
+    }
+    sundog_sound_handle_input_requests( g_sound );
+    return rv;
+}
+#ifdef OS_ANDROID
+SUNVOX_EXPORT JNIEXPORT jint JNICALL Java_nightradio_sunvoxlib_SunVoxLib_set_1sample_1rate( JNIEnv* je, jclass jc, jint freq )
+{
+    return sv_set_sample_rate( freq );
+}
+#endif
+
 SUNVOX_EXPORT int sv_lock_slot( int slot )
 {
     if( check_slot( slot ) ) return -1;
@@ -410,6 +596,7 @@ SUNVOX_EXPORT JNIEXPORT jint JNICALL Java_nightradio_sunvoxlib_SunVoxLib_lock_1s
 SUNVOX_EXPORT int sv_unlock_slot( int slot )
 {
     if( check_slot( slot ) ) return -1;
+    sunvox_plan_events( g_sv[ slot ] );
     SUNVOX_SOUND_STREAM_CONTROL( g_sv[ slot ], SUNVOX_STREAM_UNLOCK );
     return 0;
 }
@@ -427,19 +614,26 @@ SUNVOX_EXPORT int sv_load( int slot, const char* name )
     if( rv == 0 ) sundog_sound_handle_input_requests( g_sound );
     return rv;
 }
-SUNVOX_EXPORT int sv_load_from_memory( int slot, void* data, uint data_size )
+//discard = true: data is a temporary copy; its pages are released while the blocks are being read (see sfs_set_discard()),
+//so the peak memory usage is about the project size instead of two sizes:
+static int sv_load_proj_from_memory( int slot, void* data, uint data_size, bool discard )
 {
     if( check_slot( slot ) ) return -1;
     int rv = -1;
     sfs_file f = sfs_open_in_memory( data, data_size );
     if( f )
     {
+	if( discard ) sfs_set_discard( f );
 	rv = sunvox_load_proj_from_fd( f, 0, g_sv[ slot ] );
 	sfs_close( f );
     }
     if( rv == 0 ) sundog_sound_handle_input_requests( g_sound );
     return rv;
 }
+SUNVOX_EXPORT int sv_load_from_memory( int slot, void* data, uint data_size )
+{
+    return sv_load_proj_from_memory( slot, data, data_size, false );
+}
 #ifdef OS_ANDROID
 SUNVOX_EXPORT JNIEXPORT jint JNICALL Java_nightradio_sunvoxlib_SunVoxLib_load( JNIEnv* je, jclass jc, jint slot, jstring name )
 {
@@ -454,9 +648,10 @@ SUNVOX_EXPORT JNIEXPORT jint JNICALL Java_nightradio_sunvoxlib_SunVoxLib_load_1f
 {
     jint rv = 0;
     uint data_size = (uint)je->GetArrayLength( data );
-    jbyte* c_data = je->GetByteArrayElements( data, NULL );
-    rv = sv_load_from_memory( slot, c_data, data_size );
-    je->ReleaseByteArrayElements( data, c_data, 0 );
+    jboolean is_copy = JNI_FALSE;
+    jbyte* c_data = je->GetByteArrayElements( data, &is_copy );
+    rv = sv_load_proj_from_memory( slot, c_data, data_size, is_copy == JNI_TRUE ); //the copy is ours: don't keep it in memory with the loaded project
+    je->ReleaseByteArrayElements( data, c_data, JNI_ABORT ); //read only: don't copy back
     return rv;
 }
 #endif
@@ -605,6 +800,55 @@ SUNVOX_EXPORT JNIEXPORT jint JNICALL Java_nightradio_sunvoxlib_SunVoxLib_sync_1r
 }
 #endif
 
+//Command IDs are positive 31-bit numbers in the API (see SUNVOX_USER_CMD_ID_MASK):
+SUNVOX_EXPORT int sv_play_async( int slot )
+{
+    if( check_slot( slot ) ) return -1;
+#ifdef DEFERRED_SOUND_STREAM_INIT
+    sundog_sound_init_deferred( g_sound );
+#endif
+    uint id = sunvox_play_async( 0, false, -1, g_sv[ slot ] );
+    if( id == 0 ) return -1; //command buffer is full
+    return id & SUNVOX_USER_CMD_ID_MASK;
+}
+#ifdef OS_ANDROID
+SUNVOX_EXPORT JNIEXPORT jint JNICALL Java_nightradio_sunvoxlib_SunVoxLib_play_1async( JNIEnv* je, jclass jc, jint slot )
+{
+    return sv_play_async( slot );
+}
+#endif
+
+SUNVOX_EXPORT int sv_stop_async( int slot )
+{
+    if( check_slot( slot ) ) return -1;
+    uint id = sunvox_stop_async( g_sv[ slot ] );
+    if( id == 0 ) return -1; //command buffer is full
+    return id & SUNVOX_USER_CMD_ID_MASK;
+}
+#ifdef OS_ANDROID
+SUNVOX_EXPORT JNIEXPORT jint JNICALL Java_nightradio_sunvoxlib_SunVoxLib_stop_1async( JNIEnv* je, jclass jc, jint slot )
+{
+    return sv_stop_async( slot );
+}
+#endif
+
+SUNVOX_EXPORT int sv_wait_command( int slot, int cmd_id, int timeout )
+{
+    if( check_slot( slot ) ) return -1;
+    if( cmd_id <= 0 ) return -1;
+    sunvox_engine* s = g_sv[ slot ];
+    uint sent = atomic_load( &s->user_commands_sent );
+    int d = (int)( ( (uint)cmd_id - sent ) << 1 ) >> 1; //31-bit difference
+    if( timeout < 0 ) timeout = STHREAD_TIMEOUT_INFINITE;
+    return sunvox_wait_user_command( sent + d, timeout, s );
+}
+#ifdef OS_ANDROID
+SUNVOX_EXPORT JNIEXPORT jint JNICALL Java_nightradio_sunvoxlib_SunVoxLib_wait_1command( JNIEnv* je, jclass jc, jint slot, jint cmd_id, jint timeout )
+{
+    return sv_wait_command( slot, cmd_id, timeout );
+}
+#endif
+
 SUNVOX_EXPORT int sv_set_autostop( int slot, int autostop )
 {
     if( check_slot( slot ) ) return -1;
@@ -687,6 +931,49 @@ SUNVOX_EXPORT int sv_send_event( int slot, int track_num, int note, int vel, int
     sunvox_engine* s = g_sv[ slot ];
     return svh_send_event( s, t, track_num, note, vel, module, ctl, ctl_val );
 }
+struct sv_event //same layout as sv_event in sunvox.h
+{
+    uint32_t frame;
+    int track_num;
+    int note;
+    int vel;
+    int module;
+    int ctl;
+    int ctl_val;
+};
+SUNVOX_EXPORT int sv_send_events( int slot, const sv_event* events, int count )
+{
+    if( check_slot( slot ) ) return -1;
+    if( !events || count < 0 ) return -1;
+#ifdef DEFERRED_SOUND_STREAM_INIT
+    sundog_sound_init_deferred( g_sound );
+#endif
+    sunvox_engine* s = g_sv[ slot ];
+    sunvox_timed_event buf[ 64 ];
+    int sent = 0;
+    while( sent < count )
+    {
+	int n = count - sent;
+	if( n > 64 ) n = 64;
+	for( int i = 0; i < n; i++ )
+	{
+	    const sv_event* e = &events[ sent + i ];
+	    sunvox_timed_event* evt = &buf[ i ];
+	    SMEM_CLEAR_STRUCT( *evt );
+	    evt->offset = e->frame;
+	    evt->cmd.ch = e->track_num;
+	    evt->cmd.n.note = e->note;
+	    evt->cmd.n.vel = e->vel;
+	    evt->cmd.n.mod = e->module;
+	    evt->cmd.n.ctl = e->ctl;
+	    evt->cmd.n.ctl_val = e->ctl_val;
+	}
+	int n2 = sunvox_send_timed_events( buf, n, s );
+	sent += n2;
+	if( n2 < n ) break; //queue is full
+    }
+    return sent;
+}
 #ifdef OS_ANDROID
 SUNVOX_EXPORT JNIEXPORT jint JNICALL Java_nightradio_sunvoxlib_SunVoxLib_set_1event_1t( JNIEnv* je, jclass jc, jint slot, jint set, jint t )
 {
@@ -696,6 +983,17 @@ SUNVOX_EXPORT JNIEXPORT jint JNICALL Java_nightradio_sunvoxlib_SunVoxLib_send_1e
 {
     return sv_send_event( slot, track_num, note, vel, module, ctl, ctl_val );
 }
+SUNVOX_EXPORT JNIEXPORT jint JNICALL Java_nightradio_sunvoxlib_SunVoxLib_send_1events( JNIEnv* je, jclass jc, jint slot, jintArray events, jint count )
+{
+    //events: 7 ints per event (see sv_event)
+    int rv;
+    if( !events ) return -1;
+    if( je->GetArrayLength( events ) < count * 7 ) return -1;
+    jint* c_events = je->GetIntArrayElements( events, NULL );
+    rv = sv_send_events( slot, (const sv_event*)c_events, count );
+    je->ReleaseIntArrayElements( events, c_events, JNI_ABORT );
+    return rv;
+}
 #endif
 
 SUNVOX_EXPORT int sv_get_current_line( int slot )
@@ -863,6 +1161,42 @@ SUNVOX_EXPORT JNIEXPORT jint JNICALL Java_nightradio_sunvoxlib_SunVoxLib_get_1ti
 }
 #endif
 
+SUNVOX_EXPORT uint sv_get_frame_by_line( int slot, int line )
+{
+    if( check_slot( slot ) ) return 0;
+    return sunvox_get_frame_by_line( line, g_sv[ slot ] );
+}
+#ifdef OS_ANDROID
+SUNVOX_EXPORT JNIEXPORT jint JNICALL Java_nightradio_sunvoxlib_SunVoxLib_get_1frame_1by_1line( JNIEnv* je, jclass jc, jint slot, jint line )
+{
+    return sv_get_frame_by_line( slot, line );
+}
+#endif
+
+SUNVOX_EXPORT int sv_get_line_by_frame( int slot, uint frame )
+{
+    if( check_slot( slot ) ) return 0;
+    return sunvox_get_line_by_frame( frame, g_sv[ slot ] ) >> 5;
+}
+#ifdef OS_ANDROID
+SUNVOX_EXPORT JNIEXPORT jint JNICALL Java_nightradio_sunvoxlib_SunVoxLib_get_1line_1by_1frame( JNIEnv* je, jclass jc, jint slot, jint frame )
+{
+    return sv_get_line_by_frame( slot, frame );
+}
+#endif
+
+SUNVOX_EXPORT int sv_get_line2_by_frame( int slot, uint frame )
+{
+    if( check_slot( slot ) ) return 0;
+    return sunvox_get_line_by_frame( frame, g_sv[ slot ] );
+}
+#ifdef OS_ANDROID
+SUNVOX_EXPORT JNIEXPORT jint JNICALL Java_nightradio_sunvoxlib_SunVoxLib_get_1line2_1by_1frame( JNIEnv* je, jclass jc, jint slot, jint frame )
+{
+    return sv_get_line2_by_frame( slot, frame );
+}
+#endif
+
 SUNVOX_EXPORT int sv_new_module( int slot, const char* type, const char* name, int x, int y, int z )
 {
     if( check_slot( slot ) ) return -1;
@@ -1176,6 +1510,31 @@ SUNVOX_EXPORT JNIEXPORT jint JNICALL Java_nightradio_sunvoxlib_SunVoxLib_sampler
 }
 #endif
 
+SUNVOX_EXPORT uint sv_vplayer_get_underruns( int slot, int mod_num )
+{
+    if( check_slot( slot ) ) return 0;
+    if( strcmp( sv_get_module_type( slot, mod_num ), g_mod_load_types[ 2 ] ) ) return 0; //not a Vorbis player
+    return vplayer_get_underruns( mod_num, g_sv[ slot ]->net );
+}
+#ifdef OS_ANDROID
+SUNVOX_EXPORT JNIEXPORT jint JNICALL Java_nightradio_sunvoxlib_SunVoxLib_vplayer_1get_1underruns( JNIEnv* je, jclass jc, jint slot, jint mod_num )
+{
+    return sv_vplayer_get_underruns( slot, mod_num );
+}
+#endif
+
+SUNVOX_EXPORT int sv_get_pipeline_latency( int slot )
+{
+    if( check_slot( slot ) ) return 0;
+    return metamodule_get_latency( g_sv[ slot ]->net );
+}
+#ifdef OS_ANDROID
+SUNVOX_EXPORT JNIEXPORT jint JNICALL Java_nightradio_sunvoxlib_SunVoxLib_get_1pipeline_1latency( JNIEnv* je, jclass jc, jint slot )
+{
+    return sv_get_pipeline_latency( slot );
+}
+#endif
+
 SUNVOX_EXPORT uint sv_get_number_of_modules( int slot )
 {
     if( check_slot( slot ) ) return 0;
@@ -1467,6 +1826,15 @@ SUNVOX_EXPORT uint sv_get_module_scope2( int slot, int mod_num, int channel, int
 	psynth_module* m = &g_sv[ slot ]->net->mods[ mod_num ];
 	if( m->flags & PSYNTH_FLAG_EXISTS )
 	{
+	    if( !( m->scope_flags & PSYNTH_SCOPE_FLAG_RAW ) )
+	    {
+		//Scope capture is off by default; the first call subscribes the module
+		//(under the lock, like sv_set_module_scope(): m->peaks may be replaced by another thread):
+		SUNVOX_SOUND_STREAM_CONTROL( g_sv[ slot ], SUNVOX_STREAM_LOCK );
+		if( ( m->flags & PSYNTH_FLAG_EXISTS ) && !( m->scope_flags & PSYNTH_SCOPE_FLAG_RAW ) )
+		    psynth_set_scope( mod_num, m->scope_flags | PSYNTH_SCOPE_FLAG_RAW, m->peaks ? m->peaks->resolution : 0, g_sv[ slot ]->net );
+		SUNVOX_SOUND_STREAM_CONTROL( g_sv[ slot ], SUNVOX_STREAM_UNLOCK );
+	    }
 	    int size = 0;
 	    int offset = 0;
 	    stime_ticks_t t = stime_ticks();
@@ -1503,6 +1871,42 @@ SUNVOX_EXPORT JNIEXPORT jint JNICALL Java_nightradio_sunvoxlib_SunVoxLib_get_1mo
 }
 #endif
 
+SUNVOX_EXPORT int sv_set_module_scope( int slot, int mod_num, uint32_t flags, int peak_frames )
+{
+    if( check_slot( slot ) ) return -1;
+    if( !is_sv_locked( slot, __FUNCTION__ ) ) return -1;
+    return psynth_set_scope( mod_num, flags, peak_frames, g_sv[ slot ]->net );
+}
+#ifdef OS_ANDROID
+SUNVOX_EXPORT JNIEXPORT jint JNICALL Java_nightradio_sunvoxlib_SunVoxLib_set_1module_1scope( JNIEnv* je, jclass jc, jint slot, jint mod_num, jint flags, jint peak_frames )
+{
+    return sv_set_module_scope( slot, mod_num, flags, peak_frames );
+}
+#endif
+
+SUNVOX_EXPORT uint32_t sv_get_module_peaks( int slot, int mod_num, int channel, float* dest, uint32_t count, uint32_t* pos )
+{
+    if( check_slot( slot ) ) return 0;
+    if( !dest || !pos ) return 0;
+    return psynth_get_peaks( mod_num, channel, dest, count, pos, g_sv[ slot ]->net );
+}
+#ifdef OS_ANDROID
+SUNVOX_EXPORT JNIEXPORT jint JNICALL Java_nightradio_sunvoxlib_SunVoxLib_get_1module_1peaks( JNIEnv* je, jclass jc, jint slot, jint mod_num, jint channel, jfloatArray dest, jint count, jintArray pos )
+{
+    size_t len = je->GetArrayLength( dest ) / 3;
+    if( len == 0 ) return 0;
+    if( len < (size_t)count ) count = len;
+    float* c_dest = je->GetFloatArrayElements( dest, NULL );
+    jint* c_pos = je->GetIntArrayElements( pos, NULL );
+    uint32_t p = c_pos[ 0 ];
+    jint received = sv_get_module_peaks( slot, mod_num, channel, c_dest, count, &p );
+    c_pos[ 0 ] = p;
+    je->ReleaseIntArrayElements( pos, c_pos, 0 );
+    je->ReleaseFloatArrayElements( dest, c_dest, 0 );
+    return received;
+}
+#endif
+
 SUNVOX_EXPORT int sv_module_curve( int slot, int mod_num, int curve_num, float* data, int len, int w )
 {
     if( check_slot( slot ) ) return 0;
@@ -1752,6 +2156,7 @@ SUNVOX_EXPORT int sv_set_pattern_xy( int slot, int pat_num, int x, int y )
     if( !is_sv_locked( slot, __FUNCTION__ ) ) return -1;
     s->pats_info[ pat_num ].x = x;
     s->pats_info[ pat_num ].y = y;
+    s->time_map_changed = true;
     return 0;
 }
 #ifdef OS_ANDROID
@@ -1852,6 +2257,7 @@ SUNVOX_EXPORT sunvox_note* sv_get_pattern_data( int slot, int pat_num )
     sunvox_engine* s = g_sv[ slot ];
     if( (unsigned)pat_num >= (unsigned)s->pats_num ) return NULL;
     if( !s->pats[ pat_num ] ) return NULL;
+    s->time_map_changed = true; //the data may be changed by the caller
     return s->pats[ pat_num ]->data;
 }
 #ifdef OS_ANDROID
@@ -1882,6 +2288,7 @@ SUNVOX_EXPORT JNIEXPORT jint JNICALL Java_nightradio_sunvoxlib_SunVoxLib_set_1pa
         if( data_size > size ) data_size = size;
 	smem_copy( s->pats[ pat_num ]->data, c_data, data_size );
         je->ReleaseByteArrayElements( pat_data, c_data, 0 );
+	s->time_map_changed = true;
         return 0;
     }
     return -1;
@@ -1896,11 +2303,14 @@ SUNVOX_EXPORT int sv_set_pattern_event( int slot, int pat_num, int track, int li
     if( (unsigned)track >= (unsigned)pat->channels ) return -3;
     if( (unsigned)line >= (unsigned)pat->lines ) return -4;
     sunvox_note* p = &pat->data[ line * pat->data_xsize + track ];
+    int prev_eff = p->ctl & 0xFF;
     if( nn >= 0 ) p->note = nn;
     if( vv >= 0 ) p->vel = vv;
     if( mm >= 0 ) p->mod = mm;
     if( ccee >= 0 ) p->ctl = ccee;
     if( xxyy >= 0 ) p->ctl_val = xxyy;
+    int eff = p->ctl & 0xFF;
+    if( prev_eff == 0x0F || prev_eff == 0x1F || eff == 0x0F || eff == 0x1F ) g_sv[ slot ]->time_map_changed = true;
     return 0;
 }
 #ifdef OS_ANDROID
@@ -1947,6 +2357,7 @@ SUNVOX_EXPORT int sv_pattern_mute( int slot, int pat_num, int mute )
     if( s->pats_info[ pat_num ].flags & SUNVOX_PATTERN_INFO_FLAG_MUTE ) prev_val = 1;
     if( mute == 1 ) s->pats_info[ pat_num ].flags |= SUNVOX_PATTERN_INFO_FLAG_MUTE;
     if( mute == 0 ) s->pats_info[ pat_num ].flags &= ~SUNVOX_PATTERN_INFO_FLAG_MUTE;
+    s->time_map_changed = true;
     return prev_val;
 }
 #ifdef OS_ANDROID
@@ -1992,3 +2403,72 @@ SUNVOX_EXPORT JNIEXPORT jstring JNICALL Java_nightradio_sunvoxlib_SunVoxLib_get_
     return je->NewStringUTF( s );
 }
 #endif
+
+SUNVOX_EXPORT int sv_profiler_enable( int slot, int enable )
+{
+    if( check_slot( slot ) ) return -1;
+    return psynth_prof_enable( enable != 0, g_sv[ slot ]->net );
+}
+#ifdef OS_ANDROID
+SUNVOX_EXPORT JNIEXPORT jint JNICALL Java_nightradio_sunvoxlib_SunVoxLib_profiler_1enable( JNIEnv* je, jclass jc, jint slot, jint enable )
+{
+    return sv_profiler_enable( slot, enable );
+}
+#endif
+
+SUNVOX_EXPORT int sv_profiler_read( int slot, psynth_prof_record* records, int max_records ) //sv_profiler_record in sunvox.h has the same layout
+{
+    if( check_slot( slot ) ) return -1;
+    return psynth_prof_read( records, max_records, g_sv[ slot ]->net );
+}
+
+SUNVOX_EXPORT int sv_profiler_get_module_stats( int slot, int mod_num, uint32_t* stats )
+{
+    if( check_slot( slot ) ) return -1;
+    if( !stats ) return -1;
+    return psynth_prof_get_stat( mod_num, &stats[ 0 ], &stats[ 1 ], &stats[ 2 ], &stats[ 3 ], g_sv[ slot ]->net );
+}
+
+SUNVOX_EXPORT int sv_profiler_save_trace( int slot, const char* file_name )
+{
+    if( check_slot( slot ) ) return -1;
+    return psynth_prof_save_trace( file_name, g_sv[ slot ]->net );
+}
+#ifdef OS_ANDROID
+SUNVOX_EXPORT JNIEXPORT jint JNICALL Java_nightradio_sunvoxlib_SunVoxLib_profiler_1save_1trace( JNIEnv* je, jclass jc, jint slot, jstring name )
+{
+    jint rv = 0;
+    const char* c_name = NULL;
+    if( name ) c_name = je->GetStringUTFChars( name, 0 );
+    rv = sv_profiler_save_trace( slot, c_name );
+    if( name ) je->ReleaseStringUTFChars( name, c_name );
+    return rv;
+}
+#endif
+
+SUNVOX_EXPORT int sv_profiler_reset( int slot )
+{
+    if( check_slot( slot ) ) return -1;
+    psynth_prof_reset( g_sv[ slot ]->net );
+    return 0;
+}
+#ifdef OS_ANDROID
+SUNVOX_EXPORT JNIEXPORT jint JNICALL Java_nightradio_sunvoxlib_SunVoxLib_profiler_1reset( JNIEnv* je, jclass jc, jint slot )
+{
+    return sv_profiler_reset( slot );
+}
+#endif
+
+SUNVOX_EXPORT uint32_t sv_profiler_get_lost( int slot )
+{
+    if( check_slot( slot ) ) return 0;
+    psynth_prof* prof = g_sv[ slot ]->net->prof;
+    if( !prof ) return 0;
+    return atomic_load( &prof->lost );
+}
+#ifdef OS_ANDROID
+SUNVOX_EXPORT JNIEXPORT jint JNICALL Java_nightradio_sunvoxlib_SunVoxLib_profiler_1get_1lost( JNIEnv* je, jclass jc, jint slot )
+{
+    return sv_profiler_get_lost( slot );
+}
+#endif
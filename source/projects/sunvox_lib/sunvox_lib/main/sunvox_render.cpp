@@ -0,0 +1,262 @@
+/*
+    sunvox_render.cpp - headless batch renderer: .sunvox projects -> WAV/RAW files (faster than realtime, on multiple cores)
+    This file is part of the SunVox Library.
+    Copyright (C) 2012 - 2025 Alexander Zolotov <nightradio@gmail.com>
+    warmplace.ru
+*/
+
+//Usage: sunvox_render [options] project1.sunvox [project2.sunvox ...]
+//  -o DIR   output directory (default: the directory of each project);
+//  -f FMT   output format: wav (default), wav16 (16bit WAV), raw (32bit float interleaved, no header);
+//  -r RATE  sample rate (default: 44100);
+//  -j N     number of workers (default: 0 = number of CPU cores);
+//  -t SEC   tail (in seconds) to render after the end of the project (default: 0);
+//  -b N     buffer size in frames (default: 1024).
+//Each worker creates its own SunVox engine for every project; the projects are distributed between the workers dynamically.
+
+#include "sundog.h"
+#include "sunvox_engine.h"
+
+#define RENDER_CHANNELS 2
+
+struct render_job
+{
+    const char*		name;
+    int			rv; //0 - ok
+    uint32_t		frames;
+    stime_ns_t		time; //rendering time (load + render + encode)
+    size_t		mem_peak; //peak memory used by this job: engine + project + encoder (allocations of the worker thread only)
+};
+
+struct render_worker
+{
+    sthread		th;
+    sunvox_engine*	s;
+    void*		buf;
+    smem_thread_usage	mem;
+};
+
+static render_job* g_jobs = NULL;
+static int g_jobs_num = 0;
+static std::atomic_int g_jobs_next;
+static smutex g_print_mutex;
+static smutex g_engine_mutex; //sunvox_engine_init() and sunvox_engine_close() use some shared global tables
+
+static const char* g_out_dir = NULL;
+static sfs_file_fmt g_out_fmt = SFS_FILE_FMT_WAVE;
+static sfs_sample_format g_out_smp_fmt = SFMT_FLOAT32;
+static int g_freq = 44100;
+static int g_tail = 0; //seconds
+static int g_buf_size = 1024;
+
+static char* make_out_name( const char* name )
+{
+    const char* ext = "raw";
+    if( g_out_fmt == SFS_FILE_FMT_WAVE ) ext = "wav";
+    const char* fname = sfs_get_filename_without_dir( name );
+    size_t fname_len = smem_strlen( fname );
+    const char* fext = sfs_get_filename_extension( fname );
+    if( fext && fext[ 0 ] ) fname_len -= smem_strlen( fext ) + 1;
+    size_t dir_len = 0;
+    if( g_out_dir )
+	dir_len = smem_strlen( g_out_dir ) + 1;
+    else
+	dir_len = fname - name;
+    char* rv = SMEM_ALLOC2( char, dir_len + fname_len + 1 + smem_strlen( ext ) + 1 );
+    if( !rv ) return NULL;
+    if( g_out_dir )
+	sprintf( rv, "%s/", g_out_dir );
+    else
+	smem_copy( rv, name, dir_len );
+    smem_copy( rv + dir_len, fname, fname_len );
+    sprintf( rv + dir_len + fname_len, ".%s", ext );
+    return rv;
+}
+
+static int render_project( render_job* job, render_worker* w )
+{
+    int rv = 0;
+    int64_t mem_base = w->mem.size;
+    w->mem.max_size = mem_base;
+    sunvox_engine* s = w->s;
+    uint engine_flags =
+	SUNVOX_FLAG_PLAYER_ONLY | SUNVOX_FLAG_NO_GUI | SUNVOX_FLAG_NO_SCOPE | SUNVOX_FLAG_NO_MIDI | SUNVOX_FLAG_NO_GLOBAL_SYS_EVENTS |
+	SUNVOX_FLAG_NO_KBD_EVENTS | SUNVOX_FLAG_ONE_THREAD | SUNVOX_FLAG_EXPORT;
+    smutex_lock( &g_engine_mutex );
+    sunvox_engine_init( engine_flags, g_freq, 0, 0, 0, 0, s );
+    smutex_unlock( &g_engine_mutex );
+    sfs_sound_encoder_data enc = sfs_sound_encoder_data();
+    sfs_sound_encoder_data** encoders = NULL;
+    char* out_name = NULL;
+    bool enc_initialized = false;
+    while( 1 )
+    {
+	if( sunvox_load_proj( job->name, 0, s ) ) { rv = -1; break; }
+	uint32_t frames = sunvox_get_proj_frames( 0, 0, s );
+	frames += g_tail * g_freq;
+	job->frames = frames;
+	out_name = make_out_name( job->name );
+	if( !out_name ) { rv = -2; break; }
+	if( sfs_sound_encoder_init( NULL, out_name, 0, g_out_fmt, g_out_smp_fmt, g_freq, RENDER_CHANNELS, frames, 0, &enc ) ) { rv = -3; break; }
+	enc_initialized = true;
+	encoders = SMEM_ZALLOC2( sfs_sound_encoder_data*, s->net->mods_num );
+	if( !encoders ) { rv = -4; break; }
+	encoders[ 0 ] = &enc; //Output module only
+	sunvox_play( 0, true, -1, s );
+	sunvox_render_data rdata;
+	stime_ticks_t t = stime_ticks();
+	uint32_t ptr = 0;
+	while( ptr < frames )
+	{
+	    int size = g_buf_size;
+	    if( ptr + size > frames ) size = frames - ptr;
+	    SMEM_CLEAR_STRUCT( rdata );
+	    rdata.buffer_type = g_out_smp_fmt == SFMT_INT16 ? sound_buffer_int16 : sound_buffer_float32;
+	    rdata.buffer = w->buf;
+	    rdata.frames = size;
+	    rdata.channels = RENDER_CHANNELS;
+	    rdata.out_time = t;
+	    rdata.out_file_encoders = encoders;
+	    sunvox_render_piece_of_sound( &rdata, s );
+	    t += (stime_ticks_t)( ( (uint64_t)size * stime_ticks_per_second() ) / g_freq );
+	    ptr += size;
+	}
+	sunvox_stop( s );
+	break;
+    }
+    if( enc_initialized ) sfs_sound_encoder_deinit( &enc );
+    smem_free( encoders );
+    smem_free( out_name );
+    smutex_lock( &g_engine_mutex );
+    sunvox_engine_close( s );
+    smutex_unlock( &g_engine_mutex );
+    job->mem_peak = (size_t)( w->mem.max_size - mem_base );
+    return rv;
+}
+
+static void* render_worker_proc( void* user_data )
+{
+    render_worker* w = (render_worker*)user_data;
+    smem_set_thread_usage( &w->mem );
+    while( 1 )
+    {
+	int j = atomic_fetch_add( &g_jobs_next, 1 );
+	if( j >= g_jobs_num ) break;
+	render_job* job = &g_jobs[ j ];
+	stime_ns_t t = stime_ns();
+	job->rv = render_project( job, w );
+	job->time = stime_ns() - t;
+	double secs = (double)job->time / 1000000000.0;
+	double audio_secs = (double)job->frames / g_freq;
+	smutex_lock( &g_print_mutex );
+	if( job->rv )
+	    printf( "%s: ERROR %d\n", job->name, job->rv );
+	else
+	    printf( "%s: %.2f s of audio in %.3f s; %.1f xRT; memory +%.1f MB\n", job->name, audio_secs, secs, secs > 0 ? audio_secs / secs : 0, (double)job->mem_peak / ( 1024 * 1024 ) );
+	fflush( stdout );
+	smutex_unlock( &g_print_mutex );
+    }
+    smem_set_thread_usage( NULL );
+    return NULL;
+}
+
+static void print_usage()
+{
+    printf(
+	"Usage: sunvox_render [options] project1.sunvox [project2.sunvox ...]\n"
+	"  -o DIR   output directory (default: the directory of each project)\n"
+	"  -f FMT   output format: wav (default; 32bit float), wav16, raw (32bit float interleaved)\n"
+	"  -r RATE  sample rate (default: 44100)\n"
+	"  -j N     number of workers (default: 0 = number of CPU cores)\n"
+	"  -t SEC   tail to render after the end of the project (default: 0)\n"
+	"  -b N     buffer size in frames (default: 1024)\n" );
+}
+
+int main( int argc, char* argv[] )
+{
+    int workers_num = 0;
+    g_jobs = (render_job*)malloc( sizeof( render_job ) * argc );
+    if( !g_jobs ) return 1;
+    for( int i = 1; i < argc; i++ )
+    {
+	const char* a = argv[ i ];
+	if( a[ 0 ] == '-' && a[ 1 ] && a[ 2 ] == 0 && i + 1 < argc )
+	{
+	    const char* v = argv[ ++i ];
+	    switch( a[ 1 ] )
+	    {
+		case 'o': g_out_dir = v; break;
+		case 'f':
+		    if( strcmp( v, "raw" ) == 0 ) g_out_fmt = SFS_FILE_FMT_UNKNOWN;
+		    else if( strcmp( v, "wav16" ) == 0 ) g_out_smp_fmt = SFMT_INT16;
+		    else if( strcmp( v, "wav" ) ) { print_usage(); return 1; }
+		    break;
+		case 'r': g_freq = atoi( v ); break;
+		case 'j': workers_num = atoi( v ); break;
+		case 't': g_tail = atoi( v ); break;
+		case 'b': g_buf_size = atoi( v ); break;
+		default: print_usage(); return 1;
+	    }
+	    continue;
+	}
+	g_jobs[ g_jobs_num ].name = a;
+	g_jobs[ g_jobs_num ].rv = 0;
+	g_jobs_num++;
+    }
+    if( g_jobs_num == 0 || g_freq < 44100 || g_buf_size <= 0 || g_tail < 0 )
+    {
+	print_usage();
+	free( g_jobs );
+	return 1;
+    }
+
+    sundog_global_init();
+    slog_disable( 1, 1 );
+    smutex_init( &g_print_mutex, 0 );
+    smutex_init( &g_engine_mutex, 0 );
+    atomic_init( &g_jobs_next, 0 );
+
+    if( workers_num <= 0 ) workers_num = sthread_get_cpu_count();
+    if( workers_num > g_jobs_num ) workers_num = g_jobs_num;
+    if( workers_num < 1 ) workers_num = 1;
+    render_worker* workers = SMEM_ZALLOC2( render_worker, workers_num );
+    for( int i = 0; i < workers_num; i++ )
+    {
+	render_worker* w = &workers[ i ];
+	w->s = SMEM_ALLOC2( sunvox_engine, 1 );
+	w->buf = SMEM_ALLOC( g_buf_size * RENDER_CHANNELS * sizeof( float ) );
+    }
+
+    printf( "Rendering %d project(s); %d worker(s)\n", g_jobs_num, workers_num );
+    stime_ns_t t = stime_ns();
+    for( int i = 1; i < workers_num; i++ )
+	sthread_create( &workers[ i ].th, 0, render_worker_proc, &workers[ i ], 0 );
+    render_worker_proc( &workers[ 0 ] );
+    for( int i = 1; i < workers_num; i++ )
+	sthread_destroy( &workers[ i ].th, STHREAD_TIMEOUT_INFINITE );
+    t = stime_ns() - t;
+
+    int errors = 0;
+    double audio_secs = 0;
+    for( int i = 0; i < g_jobs_num; i++ )
+    {
+	if( g_jobs[ i ].rv ) { errors++; continue; }
+	audio_secs += (double)g_jobs[ i ].frames / g_freq;
+    }
+    double secs = (double)t / 1000000000.0;
+    printf( "Total: %.2f s of audio in %.3f s; %.1f xRT; process peak memory %.1f MB; errors: %d\n", audio_secs, secs, secs > 0 ? audio_secs / secs : 0, (double)smem_get_max_usage() / ( 1024 * 1024 ), errors );
+
+    for( int i = 0; i < workers_num; i++ )
+    {
+	render_worker* w = &workers[ i ];
+	smem_free( w->s );
+	smem_free( w->buf );
+    }
+    smem_free( workers );
+    smutex_destroy( &g_engine_mutex );
+    smutex_destroy( &g_print_mutex );
+    sundog_global_deinit();
+    free( g_jobs );
+
+    return errors ? 1 : 0;
+}
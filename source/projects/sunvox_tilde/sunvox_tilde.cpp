@@ -21,7 +21,7 @@
 
 #define N_IN_CHANNELS 2
 #define N_OUT_CHANNELS 2
-#define FLOAT32_TYPE 1
+#define FLOAT64_TYPE 2
 #define LATENCY 0
 
 // struct to represent the object's state
@@ -30,9 +30,8 @@ typedef struct _sv {
 	int is_initialized;        // flag to indicate if sv_init has been successfully called
     int keep_running;          // flag to indicate whether to keep running or not
     const char* resources_dir; // resource directory inside external bundle;
+    long prefetch;             // decode Vorbis Player streams in the background (realtime drivers only)
 	double offset; 	           // the value of a property of our object
-	float *in_sv_buffer;       // intermediate sunvox input buffer
-    float *out_sv_buffer;      // intermediate sunvox output buffer
 } t_sv;
 
 
@@ -68,6 +67,12 @@ void ext_main(void *r)
 	class_addmethod(c, (method)sv_dsp64,	"dsp64",	A_CANT,  0);
 	class_addmethod(c, (method)sv_assist,	"assist",	A_CANT,  0);
 
+	// off by default: with the NRT driver the engine runs faster than realtime,
+	// so the background decoder falls behind and the players output silence;
+	// read when the engine starts (first DSP start), so set it as an argument: [sunvox~ @prefetch 1]
+	CLASS_ATTR_LONG(c, "prefetch", 0, t_sv, prefetch);
+	CLASS_ATTR_STYLE_LABEL(c, "prefetch", 0, "onoff", "Background Vorbis decoding");
+
 	class_dspinit(c);
 	class_register(CLASS_BOX, c);
 	sv_class = c;
@@ -107,14 +112,14 @@ void *sv_new(t_symbol *s, long argc, t_atom *argv)
 		x->offset = 0.0;
 		x->is_initialized = 0;
         x->keep_running = 1;        
-        x->in_sv_buffer = NULL;
-        x->out_sv_buffer = NULL;
+        x->prefetch = 0;
 #if defined(__APPLE__)
         x->resources_dir = string_getptr(
             sv_get_path_to_external(sv_class, "/Contents/Resources"));
 #else
         x->resources_dir = NULL;
 #endif
+        attr_args_process(x, argc, argv);
 	}
 	return (x);
 }
@@ -122,8 +127,6 @@ void *sv_new(t_symbol *s, long argc, t_atom *argv)
 
 void sv_free(t_sv *x)
 {
-    delete[] x->in_sv_buffer;
-    delete[] x->out_sv_buffer;
     if (x->is_initialized) {
         sv_close_slot(0);
         sv_deinit();
@@ -156,36 +159,34 @@ void sv_dsp64(t_sv *x, t_object *dsp64, short *count, double samplerate, long ma
     // post("sample rate: %f", samplerate);
     // post("maxvectorsize: %d", maxvectorsize);
 
+    // DSP restarts keep the engine and the loaded project:
+    // sunvox renders straight into the msp signal vectors, so a new vector size needs nothing here,
+    // and a new sample rate is handled by sv_set_sample_rate(): it rebuilds the engine from a copy of the project,
+    // so the playback position and the queued events are kept, but the sounding notes are cut.
 	if (x->is_initialized) {
-		post("calling sv_deinit()");
-        sv_close_slot( 0 );
-        sv_deinit();
-    }
-
-    delete[] x->in_sv_buffer;
-    delete[] x->out_sv_buffer;
-
-    x->in_sv_buffer = new float[maxvectorsize * N_IN_CHANNELS];
-    x->out_sv_buffer = new float[maxvectorsize * N_OUT_CHANNELS];
-
-    memset(x->in_sv_buffer, 0.f, sizeof(float) * maxvectorsize * N_IN_CHANNELS);
-    memset(x->out_sv_buffer, 0.f, sizeof(float) * maxvectorsize * N_OUT_CHANNELS);
-
-    int ver = sv_init( 0, samplerate, N_OUT_CHANNELS, SV_INIT_FLAG_USER_AUDIO_CALLBACK
-                                                    | SV_INIT_FLAG_AUDIO_FLOAT32
-                                                    | SV_INIT_FLAG_ONE_THREAD);
-    if( ver >= 0 )
-    {
-    	x->is_initialized = 1;
-        sv_open_slot( 0 );
-        /*
-        SunVox is initialized.
-        Slot 0 is open and ready for use.
-        Then you can load and play some files in this slot.
-        */
-        post("sv_init successuflly called");
+        if ((int)samplerate != sv_get_sample_rate()) {
+            post("sample rate changed: %d -> %d", sv_get_sample_rate(), (int)samplerate);
+            if (sv_set_sample_rate((int)samplerate) < 0) {
+                error("sunvox: can't change the sample rate!");
+            }
+        }
     } else {
-    	error("sunvox init failed!");
+        int ver = sv_init( x->prefetch ? "vplayer_prefetch=1" : NULL, samplerate, N_OUT_CHANNELS, SV_INIT_FLAG_USER_AUDIO_CALLBACK
+                                                        | SV_INIT_FLAG_AUDIO_FLOAT32
+                                                        | SV_INIT_FLAG_ONE_THREAD);
+        if( ver >= 0 )
+        {
+            x->is_initialized = 1;
+            sv_open_slot( 0 );
+            /*
+            SunVox is initialized.
+            Slot 0 is open and ready for use.
+            Then you can load and play some files in this slot.
+            */
+            post("sv_init successuflly called");
+        } else {
+            error("sunvox init failed!");
+        }
     }
     object_method(dsp64, gensym("dsp_add64"), x, sv_perform64, 0, NULL);
 }
@@ -194,26 +195,20 @@ void sv_dsp64(t_sv *x, t_object *dsp64, short *count, double samplerate, long ma
 void sv_perform64(t_sv *x, t_object *dsp64, double **ins, long numins, double **outs, long numouts, 
                            long sampleframes, long flags, void *userparam)
 {
-    float * in_ptr = x->in_sv_buffer;
-    float * out_ptr = x->out_sv_buffer;
     int n = sampleframes; // n = 64
 
-    if (ins) {
-        for (int i = 0; i < n; i++) {
-            for (int chan = 0; chan < numins; chan++) {
-                *(in_ptr++) = ins[chan][i];
-            }
-        }
+    // sunvox renders straight into the msp signal vectors (missing channels are skipped)
+    double *out_bufs[N_OUT_CHANNELS];
+    for (int chan = 0; chan < N_OUT_CHANNELS; chan++) {
+        out_bufs[chan] = chan < numouts ? outs[chan] : NULL;
     }
-
-    // int sv_audio_callback2( void* buf, int frames, int latency, uint32_t out_time, int in_type, int in_channels, void* in_buf ) SUNVOX_FN_ATTR;
-    sv_audio_callback2(x->out_sv_buffer, n, LATENCY, sv_get_ticks(), FLOAT32_TYPE, N_IN_CHANNELS, x->in_sv_buffer );
-
-    for (int i = 0; i < n; i++) {
-        for (int chan = 0; chan < numouts; chan++) {
-            outs[chan][i] = *out_ptr++;
-        }
+    int in_channels = ins ? (int)numins : 0;
+    if (in_channels > N_IN_CHANNELS) {
+        in_channels = N_IN_CHANNELS;
     }
+
+    // int sv_audio_callback_planar( void** buf, int frames, int latency, uint32_t out_time, int type, int in_channels, void** in_buf ) SUNVOX_FN_ATTR;
+    sv_audio_callback_planar((void **)out_bufs, n, LATENCY, sv_get_ticks(), FLOAT64_TYPE, in_channels, (void **)ins);
 }
 
 